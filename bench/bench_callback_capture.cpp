@@ -0,0 +1,104 @@
+#include "jsArrayParallel.h"
+
+#include <chrono>
+#include <cstdio>
+
+// callbacks go by reference from the public method down to the call, so a functor carrying 4KB of state
+// must cost what a stateless lambda doing the same work costs. Exits with 1 when it's clearly slower.
+
+namespace
+{
+    constexpr std::size_t tableBytes = 4096;
+    constexpr std::size_t elementCount = std::size_t(1) << 22;
+    constexpr int repeats = 7;
+
+    unsigned char table[tableBytes];
+
+    // the same lookup as the stateless lambdas, from its own 4KB copy of the table
+    struct HeavyTable
+    {
+        unsigned char cache[tableBytes];
+
+        HeavyTable() noexcept
+        {
+            for (std::size_t i = 0; i < tableBytes; i += 1)
+                cache[i] = table[i];
+        }
+
+        inline int lookup(int value) const noexcept { return cache[value & (tableBytes - 1)]; }
+    };
+
+    struct HeavyMap : HeavyTable
+    {
+        inline int operator()(int value) const noexcept { return value + this->lookup(value); }
+    };
+
+    struct HeavyPredicate : HeavyTable
+    {
+        inline bool operator()(int value) const noexcept { return ((value + this->lookup(value)) & 1) == 0; }
+    };
+
+    struct HeavyReduce : HeavyTable
+    {
+        inline long operator()(long sum, int value) const noexcept { return sum + this->lookup(value); }
+    };
+
+    // best of repeats, in nanoseconds per element
+    template<typename G>
+    double bestNanosPerElement(G&& run)
+    {
+        double best = 0;
+        for (int r = 0; r < repeats; r += 1)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            const double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            best = r == 0 || nanos < best ? nanos : best;
+        }
+
+        return best / static_cast<double>(elementCount);
+    }
+
+    volatile long sink = 0;
+
+    bool compare(const char* name, double heavy, double stateless)
+    {
+        const double ratio = heavy / stateless;
+        std::printf("%-12s 4KB functor %6.3f ns/elem   stateless lambda %6.3f ns/elem   ratio %.2f\n", name, heavy, stateless, ratio);
+        return ratio < 1.25;
+    }
+}
+
+int main()
+{
+    for (std::size_t i = 0; i < tableBytes; i += 1)
+        table[i] = static_cast<unsigned char>(i * 7);
+
+    JSArray<int> values;
+    values.reserve(elementCount);
+    for (std::size_t i = 0; i < elementCount; i += 1)
+        values.push_back(static_cast<int>(i * 13));
+
+    const HeavyMap heavyMap;
+    const HeavyPredicate heavyPredicate;
+    const HeavyReduce heavyReduce;
+    const auto statelessMap = [](int value){ return value + table[value & (tableBytes - 1)]; };
+    const auto statelessPredicate = [](int value){ return ((value + table[value & (tableBytes - 1)]) & 1) == 0; };
+    const auto statelessReduce = [](long sum, int value){ return sum + table[value & (tableBytes - 1)]; };
+
+    bool same = true;
+    same = compare("map",
+        bestNanosPerElement([&]{ sink = values.map(heavyMap)[7]; }),
+        bestNanosPerElement([&]{ sink = values.map(statelessMap)[7]; })) && same;
+    same = compare("filter",
+        bestNanosPerElement([&]{ sink = static_cast<long>(values.filter(heavyPredicate).size()); }),
+        bestNanosPerElement([&]{ sink = static_cast<long>(values.filter(statelessPredicate).size()); })) && same;
+    same = compare("reduce",
+        bestNanosPerElement([&]{ sink = values.reduce(heavyReduce, 0L); }),
+        bestNanosPerElement([&]{ sink = values.reduce(statelessReduce, 0L); })) && same;
+    same = compare("mapParallel",
+        bestNanosPerElement([&]{ sink = values.mapParallel(heavyMap)[7]; }),
+        bestNanosPerElement([&]{ sink = values.mapParallel(statelessMap)[7]; })) && same;
+
+    return same ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+#!/usr/bin/env python3
+"""Compiles the generated JSArray call sites and the same call sites written as plain std::vector loops
+(gen_callsites.py --plain), and fails when the JSArray ones take more than --max-ratio times as long.
+Comparing with a baseline compiled on the same machine in the same run keeps the check meaningful on fast
+and slow machines alike, where a fixed number of seconds is either never hit or always hit."""
+
+import argparse
+import subprocess
+import sys
+import time
+
+
+def compile_seconds(command):
+    start = time.perf_counter()
+    subprocess.run(command, check=True)
+    return time.perf_counter() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--baseline", required=True, help="the plain std::vector translation unit")
+    parser.add_argument("--callsites", required=True, help="the JSArray translation unit")
+    parser.add_argument("--max-ratio", type=float, required=True, help="most the JSArray one may take, in baselines")
+    parser.add_argument("command", nargs=argparse.REMAINDER, help="compiler and flags, the source file is appended")
+    args = parser.parse_args()
+
+    command = args.command[1:] if args.command[:1] == ["--"] else args.command
+    baseline = compile_seconds(command + [args.baseline])
+    callsites = compile_seconds(command + [args.callsites])
+    ratio = callsites / max(baseline, 1e-3)
+    print(f"baseline {baseline:.2f}s, call sites {callsites:.2f}s: {ratio:.1f}x (at most {args.max_ratio:.1f}x)")
+    return 0 if ratio <= args.max_ratio else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+"""Writes a translation unit with N JSArray call sites (map, filter, reduce, forEach in turn), every one with
+its own lambda, so each instantiates the callback traits once. Compiling it measures what the traits cost.
+With --plain the same lambdas are called from hand written loops over a std::vector instead: the baseline
+the JSArray version is compared against (see check_compile_time.py)."""
+
+import argparse
+
+KINDS = [
+    "    auto r = values.map([](int v, std::size_t i) {{ return v * {n} + static_cast<int>(i); }});\n    return static_cast<long>(r.size());",
+    "    auto r = values.filter([](const int& v) {{ return v % {m} == 0; }});\n    return static_cast<long>(r.size());",
+    "    return values.reduce([](long sum, int v, std::size_t i) {{ return sum + v * {n} + static_cast<long>(i); }}, 0L);",
+    "    long sum = 0;\n    values.forEach([&sum](const int& v, std::size_t i, const JSArray<int>&) {{ sum += v + {n} + static_cast<long>(i); }});\n    return sum;",
+]
+
+PLAIN_KINDS = [
+    "    auto f = [](int v, std::size_t i) {{ return v * {n} + static_cast<int>(i); }};\n    std::vector<int> r;\n    r.reserve(values.size());\n"
+    "    for (std::size_t i = 0; i < values.size(); i += 1)\n        r.push_back(f(values[i], i));\n    return static_cast<long>(r.size());",
+    "    auto f = [](const int& v) {{ return v % {m} == 0; }};\n    std::vector<int> r;\n"
+    "    for (std::size_t i = 0; i < values.size(); i += 1)\n        if (f(values[i]))\n            r.push_back(values[i]);\n    return static_cast<long>(r.size());",
+    "    auto f = [](long sum, int v, std::size_t i) {{ return sum + v * {n} + static_cast<long>(i); }};\n    long sum = 0L;\n"
+    "    for (std::size_t i = 0; i < values.size(); i += 1)\n        sum = f(sum, values[i], i);\n    return sum;",
+    "    long sum = 0;\n    auto f = [&sum](const int& v, std::size_t i, const std::vector<int>&) {{ sum += v + {n} + static_cast<long>(i); }};\n"
+    "    for (std::size_t i = 0; i < values.size(); i += 1)\n        f(values[i], i, values);\n    return sum;",
+]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("output", help="the .cpp file to write")
+    parser.add_argument("--count", type=int, default=5000, help="number of call sites")
+    parser.add_argument("--plain", action="store_true", help="write the std::vector baseline instead")
+    args = parser.parse_args()
+
+    kinds = PLAIN_KINDS if args.plain else KINDS
+    header = "#include <vector>\n#include <cstddef>\n" if args.plain else "#include \"jsArray.h\"\n"
+    array = "std::vector<int>" if args.plain else "JSArray<int>"
+    with open(args.output, "w") as out:
+        out.write("// generated by bench/gen_callsites.py, do not edit\n" + header + "\n")
+        for n in range(args.count):
+            body = kinds[n % len(kinds)].format(n=n, m=n % 7 + 2)
+            out.write(f"long callSite{n}({array}& values)\n{{\n{body}\n}}\n\n")
+
+
+if __name__ == "__main__":
+    main()
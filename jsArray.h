@@ -3,6 +3,30 @@
 #include <vector>
 #include <type_traits>
 #include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <functional>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <limits>
+
+#include "jsCallbackTraits.h"
+#include "jsInstrumentation.h"
+#include "jsBitMask.h"
+#include "jsHashTable.h"
+#include "jsParallel.h"
+#include "jsGroupBy.h"
+#include "jsSetOps.h"
+#include "jsSort.h"
+
+namespace jsDetail
+{
+    struct SerialReader;
+}
 
 /**
  * @brief A dynamic array class to emulate key javascript array
@@ -12,6 +36,13 @@
  * @tparam AllocTemplate    allocator template class accepting only one template paramater "T" element type (ex. std::allocator)
  * 
  * @note AllocTemplate is the way it is so you are allowed to return different types from .map();
+ * @note The ...Parallel, serialization and ...Async methods are declared here and defined in jsArrayParallel.h,
+ * jsArraySerialize.h and jsArrayAsync.h, so that what only uses the plain methods doesn't compile the thread pool,
+ * the binary format and the coroutines. Include the header of the methods you call: without it the call doesn't
+ * compile ("use of ... before deduction of 'auto'").
+ * @note The methods that take a callback are noexcept, like the rest of the class: a callback that throws
+ * (or an allocation that fails) ends in std::terminate, not in the caller. Callbacks must report errors some
+ * other way. MappedJSArray's methods and its external sort are the ones that let exceptions through.
  */
 template<typename T, template<typename> class AllocTemplate = std::allocator>
 class JSArray : public std::vector<T, AllocTemplate<T>>
@@ -23,211 +54,472 @@ private:
     using index_t = std::size_t;
     using self_t = JSArray<T, AllocTemplate>;
 
-    // the programer should not use this directly. use StandardCallbackTraits<F>::return_t
-    template<typename F, std::size_t arity>
-    struct GetStandardCallBackReturnType;
+    // the arity detection lives in jsCallbackTraits.h so the other containers (JSDeque, ...) can share it
+    using callback_traits_t = JSCallbackTraits<element_t, self_t>;
 
+    // callbacks are taken by forwarding reference and never copied, F can be a reference type here
     template<typename F>
-    struct GetStandardCallBackReturnType<F, 1> {using type = std::invoke_result_t<F, element_t&>;};
+    using StandardCallbackTraits = typename callback_traits_t::template StandardCallbackTraits<std::remove_reference_t<F>>;
 
-    template<typename F>
-    struct GetStandardCallBackReturnType<F, 2> {using type = std::invoke_result_t<F, element_t&, index_t>;};
+    template<typename F, typename Accumulator_t>
+    using ReduceCallbackTraits = typename callback_traits_t::template ReduceCallbackTraits<std::remove_reference_t<F>, Accumulator_t>;
+// END OF FUNCTION TRAITS META PROGRAMMING CODE
 
-    template<typename F>
-    struct GetStandardCallBackReturnType<F, 3> {using type = std::invoke_result_t<F, element_t&, index_t, self_t&>;};
+    using base_t = std::vector<element_t, AllocTemplate<element_t>>;
 
+    // masks live in the array's allocator too (JSBitMask for std::allocator)
+    using mask_t = JSBasicBitMask<AllocTemplate<std::uint64_t>>;
 
+    // nested arrays deserialize through each other's deserializeFrom
+    template<typename, template<typename> class>
+    friend class JSArray;
 
+    // ascending order promise, see isSorted()
+    bool sortedAscending = false;
 
-    // the programer should not use this directly. use ReduceCallbackTraits<F, Accumulator_t>::return_t
-    template<typename F, typename Accumulator_t, std::size_t arity>
-    struct GetReduceCallBackReturnType;
 
-    template<typename F, typename Accumulator_t>
-    struct GetReduceCallBackReturnType<F, Accumulator_t, 2> {using type = std::invoke_result_t<F, Accumulator_t&, element_t&>;};
 
-    template<typename F, typename Accumulator_t>
-    struct GetReduceCallBackReturnType<F, Accumulator_t, 3> {using type = std::invoke_result_t<F, Accumulator_t&, element_t&, index_t>;};
 
-    template<typename F, typename Accumulator_t>
-    struct GetReduceCallBackReturnType<F, Accumulator_t, 4> {using type = std::invoke_result_t<F, Accumulator_t&, element_t&, index_t, self_t&>;};
 
 
-    // do this to make it more obvious where char(&)[*number of parameters*] comes from in callback traits structs
-    template<typename... Args>
-    using Arity_Return_t = char(&)[sizeof...(Args)]; // can't return an array from a function, but can return a reference to an array;
 
 
-#if __cplusplus >= 202002L // I am most confident in the version that requires c++20.
-    template<typename F>
-    struct StandardCallbackTraits
-    {
-        /**
-         * this struct (along with ReduceCallbackTraits) was made to allow for auto lambdas,
-         * aka [](auto a, auto b){}; previously the function_traits struct forced defined types,
-         * and due to the method of meta programming, the callbacks were not allowed to contain auto
-         * parameters. This fixes that, and makes the interfaces just that much easier to use.
-         * 
-         * Note about the following type sequences:
-         * element_t&
-         * element_t& index_t
-         * element_t& index_t self_t&
-         * 
-         * In std::invoke_result_t && std::invocable, as far as I understand it,
-         * these types are the ones that are "passed" into the function, and therefore
-         * I choose the most unconstrained types that the callback function itself
-         * can later choose to constrain with const, volatile, or just straight make a
-         * copy without any reference. There might be the question of "well all the methods
-         * that are being added (map, reduce, etc) are const and therefore I should actually
-         * pass in const element_t& and const self_t&", but I would prefer for the error to be
-         * thrown closer to the calling method than here at the compile time meta programming stage.
-         *
-         * Oh also, index_t is not passed as a reference as I don't want the callback mucking
-         * up my index variable. So it must always be passed by value. Having the callback
-         * modify the index can result in very undefined behavior so we won't allow for that.
-         * And in addition there is no later mechanism from the const methods to say that
-         * a reference to index_t is not ok so I have to put my foot down here unfortunately.
-         * 
-         * A note though. r value references are not allowed as types here
-         * tbh I don't feel like I know them well enough to implement them so I'll
-         * stay away.
-         */
-
-
-        // please notice that the template parameters for both the return type and requires clause are the same other than the
-        // the function type "F" in std::invocable. Make sure this is always true.
-        static Arity_Return_t<element_t&>                   test() requires std::invocable<F, element_t&>;
-        static Arity_Return_t<element_t&, index_t>          test() requires std::invocable<F, element_t&, index_t>;
-        static Arity_Return_t<element_t&, index_t, self_t&> test() requires std::invocable<F, element_t&, index_t, self_t&>;
-
-        static constexpr std::size_t arity = sizeof(test());
-        using return_t = typename GetStandardCallBackReturnType<F, arity>::type;
-    };
 
-    template<typename F, typename Accumulator_t>
-    struct ReduceCallbackTraits
+    template<typename U>
+    using makeVectorEligibleType = std::remove_reference_t<U>;
+
+    template<typename U>
+    using makeMutableType = std::remove_const_t<U>;
+
+    template<typename U>
+    using makeKeyType = std::remove_cv_t<std::remove_reference_t<U>>;
+
+    // offsets[g] = counts[0] + ... + counts[g - 1], with one extra entry at the end holding the total
+    static inline void countsToOffsets(const std::vector<std::size_t>& counts, JSArray<std::size_t, AllocTemplate>& offsets) noexcept
+    {
+        offsets.resize(counts.size() + 1);
+        offsets[0] = 0;
+        for (std::size_t g = 0; g < counts.size(); g += 1)
+        {
+            offsets[g + 1] = offsets[g] + counts[g];
+        }
+    }
+
+    // elements at least this big get deduplicated on all hardware threads
+    static constexpr std::size_t parallelUniqueThreshold = std::size_t{1} << 22;
+
+    static constexpr bool isCheaplyComparable = std::is_arithmetic_v<element_t> || std::is_enum_v<element_t> || std::is_pointer_v<element_t>;
+    static constexpr bool isHashable = std::is_default_constructible_v<std::hash<element_t>>;
+
+    // the hash set used for deduplication holds element indices, hashing and comparing the elements they point to
+    struct ElementAtHash
     {
-        // virtually the same as StandardCallbackTraits except the range of acceptable
-        // arity is [2, 4] and there needs to be an Accumulator_t
-        static Arity_Return_t<Accumulator_t&, element_t&>                   test() requires std::invocable<F, Accumulator_t&, element_t&>;
-        static Arity_Return_t<Accumulator_t&, element_t&, index_t>          test() requires std::invocable<F, Accumulator_t&, element_t&, index_t>;
-        static Arity_Return_t<Accumulator_t&, element_t&, index_t, self_t&> test() requires std::invocable<F, Accumulator_t&, element_t&, index_t, self_t&>;
+        const self_t* self;
+        inline std::size_t operator()(std::size_t i) const noexcept { return jsDetail::SameValueZeroHash<element_t>{}((*self)[i]); }
+    };
 
-        static constexpr std::size_t arity = sizeof(test());
-        using return_t = typename GetReduceCallBackReturnType<F, Accumulator_t, arity>::type;
+    struct ElementAtEqual
+    {
+        const self_t* self;
+        inline bool operator()(std::size_t a, std::size_t b) const noexcept { return jsDetail::SameValueZeroEqual<element_t>{}((*self)[a], (*self)[b]); }
     };
 
-// +++++++++++++++++++++++++++++++++++ I am not as confident on the c++17 version, use std++20 if possible +++++++++++++++++++++++++++++++++++ //
-#elif __cplusplus >= 201703
+    using ElementIndexSet = jsDetail::KeyIndex<std::size_t, ElementAtHash, ElementAtEqual, AllocTemplate>;
+
+    // bit i is set if element i is the first element with its value (SameValueZero)
+    inline mask_t firstOccurrences() const noexcept
+    {
+        mask_t result(this->size());
+        if constexpr (isHashable)
+        {
+            const std::size_t taskCount = jsDetail::parallelTaskCount(this->size(), jsDetail::parallelGrain);
+            if (this->size() >= parallelUniqueThreshold && taskCount > 1)
+            {
+                this->firstOccurrencesParallel(result, taskCount);
+                return result;
+            }
+        }
+
+        if constexpr (isCheaplyComparable)
+        {
+            // sorting (value, index) keeps the smallest index first inside every run of equal values
+            std::vector<std::pair<element_t, std::size_t>, AllocTemplate<std::pair<element_t, std::size_t>>> sorted(this->size());
+            for (std::size_t i = 0; i < this->size(); i += 1)
+            {
+                sorted[i] = {(*this)[i], i};
+            }
+
+            const jsDetail::SameValueZeroLess<element_t> less;
+            std::sort(sorted.begin(), sorted.end(), [&](const auto& a, const auto& b)
+            {
+                return less(a.first, b.first) || (!less(b.first, a.first) && a.second < b.second);
+            });
+
+            for (std::size_t k = 0; k < sorted.size(); k += 1)
+            {
+                if (k == 0 || less(sorted[k - 1].first, sorted[k].first))
+                    result.set(sorted[k].second);
+            }
+        }
+        else if constexpr (isHashable)
+        {
+            ElementIndexSet seen(0, ElementAtHash{this}, ElementAtEqual{this});
+            for (std::size_t i = 0; i < this->size(); i += 1)
+            {
+                if (seen.insert(i).second)
+                    result.set(i);
+            }
+        }
+        else
+        {
+            std::vector<std::size_t, AllocTemplate<std::size_t>> sorted(this->size());
+            for (std::size_t i = 0; i < this->size(); i += 1)
+            {
+                sorted[i] = i;
+            }
+
+            std::stable_sort(sorted.begin(), sorted.end(), [this](std::size_t a, std::size_t b){return (*this)[a] < (*this)[b];});
+            for (std::size_t k = 0; k < sorted.size(); k += 1)
+            {
+                if (k == 0 || (*this)[sorted[k - 1]] < (*this)[sorted[k]])
+                    result.set(sorted[k]);
+            }
+        }
+
+        return result;
+    }
+
+    // hash set holding the index of the first occurrence of every distinct value of this array
+    inline ElementIndexSet distinctValueSet() const noexcept
+    {
+        ElementIndexSet result(this->size(), ElementAtHash{this}, ElementAtEqual{this});
+        for (std::size_t i = 0; i < this->size(); i += 1)
+        {
+            result.insert(i);
+        }
+
+        return result;
+    }
+
+    // is value in a set made by this->distinctValueSet()
+    inline bool setContains(const ElementIndexSet& values, const element_t& value) const noexcept
+    {
+        const std::uint64_t hash = jsDetail::mixHash(jsDetail::SameValueZeroHash<element_t>{}(value));
+        return values.findHashed(hash, [&](std::size_t i){return jsDetail::SameValueZeroEqual<element_t>{}((*this)[i], value);}) != ElementIndexSet::npos;
+    }
+
+    // the isSorted() promise is about operator<, the set operations merge with SameValueZeroLess: for floating
+    // point the two orders differ once there's a NaN, so only the scan can tell. The scan is cheap next to the set operation.
+    inline bool sortedForSetOperation(const jsDetail::SameValueZeroLess<element_t>& less) const noexcept
+    {
+        if constexpr (!std::is_floating_point_v<element_t>)
+        {
+            if (sortedAscending)
+                return true;
+        }
+
+        return std::is_sorted(this->begin(), this->end(), less);
+    }
+
+    /**
+     * runs one of the jsDetail::sorted... kernels when both arrays are sorted and returns true. Element types
+     * without a std::hash can only be merged, so they get sorted copies instead. Otherwise returns false
+     * and the caller falls back to hashing.
+     */
+    template<typename Kernel>
+    inline bool sortedSetOperation(const JSArray<element_t, AllocTemplate>& other, JSArray<element_t, AllocTemplate>& result, Kernel kernel) const noexcept
+    {
+        const jsDetail::SameValueZeroLess<element_t> less;
+        if (this->sortedForSetOperation(less) && other.sortedForSetOperation(less))
+        {
+            kernel(this->data(), this->size(), other.data(), other.size(), less, result);
+            return true;
+        }
+
+        if constexpr (!isHashable)
+        {
+            const JSArray<element_t, AllocTemplate> sortedThis = this->toSorted(less);
+            const JSArray<element_t, AllocTemplate> sortedOther = other.toSorted(less);
+            kernel(sortedThis.data(), sortedThis.size(), sortedOther.data(), sortedOther.size(), less, result);
+            return true;
+        }
+
+        return false;
+    }
 
-    template<typename F_copy, typename... Ts>
-    using GetNormalFuncType_t = std::invoke_result_t<F_copy, Ts...>(Ts...);
+    // up to this k, topK keeps a heap of candidates instead of copying the whole array
+    static constexpr std::size_t topKHeapLimit = 1024;
 
+    // top k of the elements in [begin, end), sorted according to compareFunc
     template<typename F>
-    struct StandardCallbackTraits
+    inline JSArray<element_t, AllocTemplate> topKOfRange(std::size_t begin, std::size_t end, std::size_t k, F& compareFunc) const noexcept
     {
-        /**
-         * as far as I understand, using std::function and overloading
-         * with different types ends up having the same effect in practice
-         * as requires std::invocable. Still I am more confident about the
-         * c++ 20 version that uses "requires std::invocable"
-         */
+        k = std::min(k, end - begin);
+        JSArray<element_t, AllocTemplate> result;
+        if (k == 0)
+            return result;
 
-        // templates on test functions are needed to avoid getting error. This lazy evaluates, with "F_copy",
-        // GetNormalFuncType_t and only when the right overload is chosen, instead of eager evaluating with "F"
-        // and having an error when arity doesn't match.
-        template<typename F_copy>
-        static Arity_Return_t<element_t&>                   test(std::function<GetNormalFuncType_t<F_copy, element_t&>>);
+        if (k <= topKHeapLimit && k < (end - begin) / 8)
+        {
+            // heap with the worst of the current k best on top, anything better replaces it
+            result.assign(this->data() + begin, this->data() + begin + k);
+            std::make_heap(result.begin(), result.end(), compareFunc);
+            for (std::size_t i = begin + k; i < end; i += 1)
+            {
+                if (compareFunc((*this)[i], result.front()))
+                {
+                    std::pop_heap(result.begin(), result.end(), compareFunc);
+                    result.back() = (*this)[i];
+                    std::push_heap(result.begin(), result.end(), compareFunc);
+                }
+            }
+
+            std::sort_heap(result.begin(), result.end(), compareFunc);
+            return result;
+        }
 
-        template<typename F_copy>
-        static Arity_Return_t<element_t&, index_t>          test(std::function<GetNormalFuncType_t<F_copy, element_t&, index_t>>);
+        result.assign(this->data() + begin, this->data() + end);
+        std::nth_element(result.begin(), result.begin() + (k - 1), result.end(), compareFunc);
+        result.erase(result.begin() + k, result.end());
+        std::sort(result.begin(), result.end(), compareFunc);
+        return result;
+    }
 
-        template<typename F_copy>
-        static Arity_Return_t<element_t&, index_t, self_t&> test(std::function<GetNormalFuncType_t<F_copy, element_t&, index_t, self_t&>>);
+    // order[k] is the index of the element that goes to position k when sorting stably by keyFn
+    template<typename F>
+    inline std::vector<std::size_t> sortByOrder(F& keyFn) const noexcept
+    {
+        using sortKey_t = makeKeyType<typename StandardCallbackTraits<F>::return_t>;
 
-        static constexpr std::size_t arity = sizeof(test<F>(std::declval<F>()));
-        using return_t = typename GetStandardCallBackReturnType<F, arity>::type;
-    };
+        std::vector<std::size_t> order(this->size());
+        if constexpr (std::is_integral_v<sortKey_t>)
+        {
+            if (this->size() >= jsDetail::radixSortThreshold)
+            {
+                std::vector<std::pair<std::uint64_t, std::size_t>> pairs(this->size());
+                for (std::size_t i = 0; i < this->size(); i += 1)
+                {
+                    pairs[i] = {jsDetail::radixKey<sortKey_t>(this->standardCallbackHandler(keyFn, i)), i};
+                }
+
+                jsDetail::radixSortPairs(pairs, sizeof(sortKey_t));
+                for (std::size_t k = 0; k < pairs.size(); k += 1)
+                {
+                    order[k] = pairs[k].second;
+                }
+
+                return order;
+            }
+        }
 
-    template<typename F, typename Accumulator_t>
-    struct ReduceCallbackTraits
+        std::vector<std::pair<sortKey_t, std::size_t>> pairs;
+        pairs.reserve(this->size());
+        for (std::size_t i = 0; i < this->size(); i += 1)
+        {
+            pairs.emplace_back(this->standardCallbackHandler(keyFn, i), i);
+        }
+
+        // ties broken by index keeps the sort stable
+        std::sort(pairs.begin(), pairs.end(), [](const std::pair<sortKey_t, std::size_t>& a, const std::pair<sortKey_t, std::size_t>& b)
+        {
+            return a.first < b.first || (!(b.first < a.first) && a.second < b.second);
+        });
+
+        for (std::size_t k = 0; k < pairs.size(); k += 1)
+        {
+            order[k] = pairs[k].second;
+        }
+
+        return order;
+    }
+
+    /**
+     * appends a finite, non zero floating point value the way javascript's Number.prototype.toString does:
+     * the shortest digits that round trip (std::to_chars), written as an integer or a plain decimal for
+     * 1e-7 < |value| < 1e21, and in exponent form ("1e-7", "1.5e+21") otherwise.
+     */
+    static inline void appendJSNumber(std::string& out, element_t value) noexcept
     {
-        template<typename F_copy>
-        static Arity_Return_t<Accumulator_t&, element_t&>                   test(std::function<GetNormalFuncType_t<F_copy, Accumulator_t&, element_t&>>);
+        char scientific[64];
+        const char* const end = std::to_chars(scientific, scientific + sizeof(scientific), value, std::chars_format::scientific).ptr;
+        const char* cursor = scientific;
+        if (*cursor == '-')
+        {
+            out.push_back('-');
+            cursor += 1;
+        }
 
-        template<typename F_copy>
-        static Arity_Return_t<Accumulator_t&, element_t&, index_t>          test(std::function<GetNormalFuncType_t<F_copy, Accumulator_t&, element_t&, index_t>>);
+        // "d.ddde+x" -> digits "dddd", and the decimal point sits after "point" digits (javascript's n)
+        char digits[32];
+        std::size_t digitCount = 0;
+        for (; *cursor != 'e'; cursor += 1)
+        {
+            if (*cursor != '.')
+            {
+                digits[digitCount] = *cursor;
+                digitCount += 1;
+            }
+        }
 
-        template<typename F_copy>
-        static Arity_Return_t<Accumulator_t&, element_t&, index_t, self_t&> test(std::function<GetNormalFuncType_t<F_copy, Accumulator_t&, element_t&, index_t, self_t&>>);
+        int exponent = 0;
+        std::from_chars(cursor + (cursor[1] == '+' ? 2 : 1), end, exponent);
+        const int point = exponent + 1;
+        const int count = static_cast<int>(digitCount);
 
-        static constexpr std::size_t arity = sizeof(test<F>(std::declval<F>()));
-        using return_t = typename GetReduceCallBackReturnType<F, Accumulator_t, arity>::type;
-    };
-#endif
-// END OF FUNCTION TRAITS META PROGRAMMING CODE
+        if (count <= point && point <= 21)
+        {
+            out.append(digits, digitCount);
+            out.append(static_cast<std::size_t>(point - count), '0');
+        }
+        else if (0 < point && point <= 21)
+        {
+            out.append(digits, static_cast<std::size_t>(point));
+            out.push_back('.');
+            out.append(digits + point, digitCount - static_cast<std::size_t>(point));
+        }
+        else if (-6 < point && point <= 0)
+        {
+            out.append("0.");
+            out.append(static_cast<std::size_t>(-point), '0');
+            out.append(digits, digitCount);
+        }
+        else
+        {
+            out.push_back(digits[0]);
+            if (digitCount > 1)
+            {
+                out.push_back('.');
+                out.append(digits + 1, digitCount - 1);
+            }
+
+            out.append(point - 1 < 0 ? "e-" : "e+");
+            char exponentDigits[8];
+            out.append(exponentDigits, std::to_chars(exponentDigits, exponentDigits + sizeof(exponentDigits), point - 1 < 0 ? 1 - point : point - 1).ptr);
+        }
+    }
+
+    // the non empty arrays of a mergeSorted call, in order
+    template<typename Arrays_t>
+    static inline std::vector<jsDetail::MergeRun<element_t>> mergeRunsOf(const Arrays_t& arrays) noexcept
+    {
+        std::vector<jsDetail::MergeRun<element_t>> runs;
+        for (const JSArray<element_t, AllocTemplate>& array : arrays)
+        {
+            if (!array.empty())
+                runs.push_back({array.data(), array.data() + array.size()});
+        }
 
+        return runs;
+    }
 
+    static inline std::size_t mergeRunsSize(const std::vector<jsDetail::MergeRun<element_t>>& runs) noexcept
+    {
+        std::size_t total = 0;
+        for (const jsDetail::MergeRun<element_t>& run : runs)
+        {
+            total += static_cast<std::size_t>(run.end - run.begin);
+        }
 
+        return total;
+    }
 
+    // size of the payload serialize writes, paddings excluded
+    inline std::size_t serialPayloadBytes() const noexcept;
 
+    // reads one serialized array at the reader's position into result, leaves the reader after its trailing padding
+    static inline bool deserializeFrom(jsDetail::SerialReader& reader, JSArray<element_t, AllocTemplate>& result) noexcept;
 
+    // what Array.from(range, mapFn) collects: mapFn(value, index), or mapFn(value) if it takes one argument
+    template<typename Range, typename F>
+    using FromMapResult_t = typename std::conditional_t<
+        std::is_invocable_v<F&, decltype(*std::begin(std::declval<Range&>())), std::size_t>,
+        std::invoke_result<F&, decltype(*std::begin(std::declval<Range&>())), std::size_t>,
+        std::invoke_result<F&, decltype(*std::begin(std::declval<Range&>()))>
+    >::type;
 
+    template<typename Iterator_t, typename = void>
+    struct IsForwardIterator : std::false_type {};
 
+    template<typename Iterator_t>
+    struct IsForwardIterator<Iterator_t, std::void_t<typename std::iterator_traits<Iterator_t>::iterator_category>>
+        : std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<Iterator_t>::iterator_category> {};
 
-    template<typename U>
-    using makeVectorEligibleType = std::remove_reference_t<U>;
+    // reserve only when measuring doesn't consume the range (forward iterators, not generators or input streams)
+    template<typename Result_t, typename Range>
+    static inline void reserveForRange(Result_t& result, Range& range) noexcept
+    {
+        using iterator_t = decltype(std::begin(range));
+        if constexpr (std::is_same_v<iterator_t, decltype(std::end(range))> && IsForwardIterator<iterator_t>::value)
+            result.reserve(static_cast<std::size_t>(std::distance(std::begin(range), std::end(range))));
+    }
 
-    template<typename U>
-    using makeMutableType = std::remove_const_t<U>;
+    inline void firstOccurrencesParallel(mask_t& result, std::size_t taskCount) const noexcept
+    {
+        std::vector<std::uint64_t, AllocTemplate<std::uint64_t>> hashes(this->size());
+        jsDetail::parallelFor(taskCount, [&](std::size_t t)
+        {
+            const auto [begin, end] = jsDetail::taskRange(this->size(), taskCount, t);
+            for (std::size_t i = begin; i < end; i += 1)
+            {
+                hashes[i] = jsDetail::mixHash(jsDetail::SameValueZeroHash<element_t>{}((*this)[i]));
+            }
+        });
+
+        // equal values share a partition and every partition is ascending, so each thread finds first occurrences on its own
+        const jsDetail::HashPartitions partitions = jsDetail::partitionByHash(hashes, taskCount);
+        std::vector<std::vector<std::size_t, AllocTemplate<std::size_t>>> firsts(partitions.partitionCount);
+        jsDetail::parallelFor(partitions.partitionCount, [&](std::size_t p)
+        {
+            ElementIndexSet seen(0, ElementAtHash{this}, ElementAtEqual{this});
+            for (std::size_t position = partitions.bucketOffsets[p]; position < partitions.bucketOffsets[p + 1]; position += 1)
+            {
+                const std::size_t i = partitions.bucketIndices[position];
+                if (seen.insertHashed(hashes[i], i).second)
+                    firsts[p].push_back(i);
+            }
+        });
+
+        for (const auto& partitionFirsts : firsts)
+        {
+            for (const std::size_t i : partitionFirsts)
+            {
+                result.set(i);
+            }
+        }
+    }
 
 
-    template<typename F>
-    inline typename StandardCallbackTraits<F>::return_t standardCallbackHandler(F callback, std::size_t currLoopIndex) const noexcept
+    // mask(callback) into a mask of type Mask_t, 64 callbacks per word
+    template<typename Mask_t, typename F>
+    inline Mask_t maskOf(F& callback) const noexcept
     {
-        constexpr std::size_t argsCount = StandardCallbackTraits<F>::arity;
-        if constexpr (argsCount == 1)
-            return callback((*this)[currLoopIndex]);
-        if constexpr (argsCount == 2)
-            return callback((*this)[currLoopIndex], currLoopIndex);
-        if constexpr (argsCount == 3)
-            return callback((*this)[currLoopIndex], currLoopIndex, *this);
+        Mask_t result(this->size());
+        std::uint64_t* words = result.words();
+        for (std::size_t w = 0; w < result.wordCount(); w += 1)
+        {
+            const std::size_t blockEnd = std::min(this->size(), (w + 1) * 64);
+            std::uint64_t word = 0;
+            for (std::size_t i = w * 64; i < blockEnd; i += 1)
+            {
+                word |= static_cast<std::uint64_t>(this->standardCallbackHandler(callback, i)) << (i % 64);
+            }
+
+            words[w] = word;
+        }
 
-        static_assert(
-            argsCount <= 3 && argsCount >= 1,
-            "\nFunction signature should look like either of these three: (1 to 3 params max)\n"
-            "return_type (auto&& val)\n"
-            "return_type (auto&& val, auto&& index)\n"
-            "return_type (auto&& val, auto&& index, auto&& self)\n"
-            "you can also define explicitly the types if you want. NOTE, the index type must be an integral type and NOT a reference\n"
-        );
+        return result;
     }
 
-    template<typename F, typename Accumulator_t>
-    inline typename ReduceCallbackTraits<F, Accumulator_t>::return_t reduceCallbackHandler(F callback, std::remove_const_t<Accumulator_t>& accumulator, std::size_t currLoopIndex) const noexcept
-    {
-        // I remove const from Accumulator_t to allow the most permissive type to be passed into
-        // callback. Remember this is the "actual" accumulator variable and it's declared and defined internally.
-        // The accumulator declared by the callback acts as nothing more than accessor. The callback will
-        // restrict with cv qualifiers if needed. Also make sure its a ref just incase the accumulator
-        // type is big and heavy to minimize copying.
-
-        constexpr std::size_t argsCount = ReduceCallbackTraits<F, Accumulator_t>::arity;
-        if constexpr (argsCount == 2)
-            return callback(accumulator, (*this)[currLoopIndex]);
-        if constexpr (argsCount == 3)
-            return callback(accumulator, (*this)[currLoopIndex], currLoopIndex);
-        if constexpr (argsCount == 4)
-            return callback(accumulator, (*this)[currLoopIndex], currLoopIndex, *this);
+    template<typename F>
+    inline typename StandardCallbackTraits<F>::return_t standardCallbackHandler(F& callback, std::size_t currLoopIndex) const noexcept
+    {
+        return callback_traits_t::standardCallbackHandler(callback, (*this)[currLoopIndex], currLoopIndex, *this);
+    }
 
-        static_assert(
-            argsCount <= 4 && argsCount >= 2,
-            "\nFunction signature should look like either of these three (2 to 4 params max):\n"
-            "return_type (auto&& accumulator, auto&& val)\n"
-            "return_type (auto&& accumulator, auto&& val, auto&& index)\n"
-            "return_type (auto&& accumulator, auto&& val, auto&& index, auto&& self)\n"
-            "you can also define explicitly the types if you want. NOTE, the index type must be an integral type and NOT a reference\n"
-        );
+    template<typename Accumulator_t, typename F>
+    inline typename ReduceCallbackTraits<F, Accumulator_t>::return_t reduceCallbackHandler(F& callback, std::remove_const_t<Accumulator_t>& accumulator, std::size_t currLoopIndex) const noexcept
+    {
+        return callback_traits_t::template reduceCallbackHandler<Accumulator_t>(callback, accumulator, (*this)[currLoopIndex], currLoopIndex, *this);
     }
 
 public:
@@ -235,6 +527,84 @@ public:
     // if confused about this line go here: https://en.cppreference.com/w/cpp/language/using_declaration
     using std::vector<element_t, AllocTemplate<element_t>>::vector; // inherit all constructors from std::vector
 
+    // Non-const element access can write, so it drops the isSorted() promise. The const overloads keep it:
+    // read a sorted array through a const reference (or std::as_const) to keep binary search.
+    inline typename base_t::reference operator[](std::size_t index) noexcept { sortedAscending = false; return base_t::operator[](index); }
+    inline typename base_t::const_reference operator[](std::size_t index) const noexcept { return base_t::operator[](index); }
+    inline typename base_t::reference at(std::size_t index) { sortedAscending = false; return base_t::at(index); }
+    inline typename base_t::const_reference at(std::size_t index) const { return base_t::at(index); }
+    inline typename base_t::reference front() noexcept { sortedAscending = false; return base_t::front(); }
+    inline typename base_t::const_reference front() const noexcept { return base_t::front(); }
+    inline typename base_t::reference back() noexcept { sortedAscending = false; return base_t::back(); }
+    inline typename base_t::const_reference back() const noexcept { return base_t::back(); }
+    inline typename base_t::pointer data() noexcept { sortedAscending = false; return base_t::data(); }
+    inline typename base_t::const_pointer data() const noexcept { return base_t::data(); }
+    inline typename base_t::iterator begin() noexcept { sortedAscending = false; return base_t::begin(); }
+    inline typename base_t::const_iterator begin() const noexcept { return base_t::begin(); }
+    inline typename base_t::iterator end() noexcept { sortedAscending = false; return base_t::end(); }
+    inline typename base_t::const_iterator end() const noexcept { return base_t::end(); }
+    inline typename base_t::reverse_iterator rbegin() noexcept { sortedAscending = false; return base_t::rbegin(); }
+    inline typename base_t::const_reverse_iterator rbegin() const noexcept { return base_t::rbegin(); }
+    inline typename base_t::reverse_iterator rend() noexcept { sortedAscending = false; return base_t::rend(); }
+    inline typename base_t::const_reverse_iterator rend() const noexcept { return base_t::rend(); }
+
+    // The members below that add elements also drop the isSorted() promise (and record growth for the
+    // instrumentation).
+    inline void push_back(const element_t& value) { JSARRAY_INSTRUMENT_GROWTH(); sortedAscending = false; base_t::push_back(value); }
+    inline void push_back(element_t&& value) { JSARRAY_INSTRUMENT_GROWTH(); sortedAscending = false; base_t::push_back(std::move(value)); }
+
+    template<typename... Args>
+    inline decltype(auto) emplace_back(Args&&... args) { JSARRAY_INSTRUMENT_GROWTH(); sortedAscending = false; return base_t::emplace_back(std::forward<Args>(args)...); }
+
+    template<typename... Args>
+    inline typename base_t::iterator emplace(typename base_t::const_iterator position, Args&&... args) { JSARRAY_INSTRUMENT_GROWTH(); sortedAscending = false; return base_t::emplace(position, std::forward<Args>(args)...); }
+
+    template<typename... Args>
+    inline typename base_t::iterator insert(typename base_t::const_iterator position, Args&&... args) { JSARRAY_INSTRUMENT_GROWTH(); sortedAscending = false; return base_t::insert(position, std::forward<Args>(args)...); }
+    inline typename base_t::iterator insert(typename base_t::const_iterator position, std::initializer_list<element_t> values) { JSARRAY_INSTRUMENT_GROWTH(); sortedAscending = false; return base_t::insert(position, values); }
+
+    template<typename... Args>
+    inline void assign(Args&&... args) { JSARRAY_INSTRUMENT_GROWTH(); sortedAscending = false; base_t::assign(std::forward<Args>(args)...); }
+    inline void assign(std::initializer_list<element_t> values) { JSARRAY_INSTRUMENT_GROWTH(); sortedAscending = false; base_t::assign(values); }
+
+    inline void resize(std::size_t count) { JSARRAY_INSTRUMENT_GROWTH(); sortedAscending = false; base_t::resize(count); }
+    inline void resize(std::size_t count, const element_t& value) { JSARRAY_INSTRUMENT_GROWTH(); sortedAscending = false; base_t::resize(count, value); }
+    inline void reserve(std::size_t count) { JSARRAY_INSTRUMENT_GROWTH(); base_t::reserve(count); }
+
+    inline void swap(JSArray<element_t, AllocTemplate>& other) noexcept
+    {
+        base_t::swap(other);
+        std::swap(sortedAscending, other.sortedAscending);
+    }
+
+    /**
+     * @brief true while the array carries the promise that it is in ascending order (operator<). sort(),
+     * sortParallel(), toSorted() and markSorted() make that promise; the JSArray methods that add elements
+     * (push_back, insert, resize...) or reorder them some other way (sort(compareFunc), sortBy...) drop it.
+     * Only the default ascending order is tracked, never a custom comparator's.
+     * Non-const element access ([], at, front, back, data, begin, end, forEach...) drops it too, even when it
+     * only reads, because the reference it returns could write. Writes the array can't see (through a
+     * std::vector&, or an iterator taken before the promise was made) need markSorted(false).
+     * sortedIndexOf, rangeFilter, median and the set operations use binary search, direct indexing or
+     * merging while the promise holds. The set operations also merge sorted arrays that carry no promise.
+     *
+     * @return bool
+     */
+    inline bool isSorted() const noexcept { return sortedAscending; }
+
+    /**
+     * @brief promise that the array is in ascending order (ex. it was loaded sorted from somewhere else),
+     * so the methods that need sorted input can use binary search. markSorted(false) withdraws the promise.
+     *
+     * @param sorted whether the array is in ascending order
+     * @return JSArray<T, AllocTemplate>&
+     */
+    inline JSArray<element_t, AllocTemplate>& markSorted(bool sorted = true) noexcept
+    {
+        sortedAscending = sorted;
+        return *this;
+    }
+
 
     /**
      * @brief creates a new array populated with the results of calling a provided function on every element in the calling array
@@ -247,17 +617,35 @@ public:
      * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/map#parameters
      */
     template<typename F>
-    inline JSArray<makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>, AllocTemplate> map(F callback) const noexcept
+    inline JSArray<makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>, AllocTemplate> map(F&& callback) const noexcept
     {
+        JSARRAY_INSTRUMENT("map");
         JSArray<makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>, AllocTemplate> result(this->size());
         for (std::size_t i = 0; i < this->size(); i += 1)
         {
             result[i] = this->standardCallbackHandler(callback, i);
         }
 
+        JSARRAY_INSTRUMENT_RESULT(result);
         return result;
     }
 
+    /**
+     * @brief same as map but the callback runs on the shared work stealing pool (or the installed JSExecutor),
+     * which hands out index ranges as threads become free, so uneven callbacks still keep every thread busy.
+     * The first elements are timed on the calling thread: when the rest would be quick it's finished there too,
+     * otherwise the ranges are sized from the measured cost (remembered per call site, see jsDetail::adaptiveProbe).
+     * The callback may itself call parallel methods. It must be safe to call from several threads at once.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return JSArray<makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>, AllocTemplate>
+     *
+     * @note defined in jsArrayParallel.h
+     */
+    template<typename F>
+    inline auto mapParallel(F&& callback) const noexcept;
+
     /**
      * @brief executes a user-supplied "reducer" callback function on each element of the array, in order,
      * passing in the return value from the calculation on the preceding element. The final result of
@@ -272,17 +660,53 @@ public:
      * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/reduce#parameters
      */
     template<typename Accumulator_t, typename F> // flipped Accumulator_t as first template param for when Accumulator_t can't be deduced don't have to put the type of F
-    inline Accumulator_t reduce(F callback, const Accumulator_t& initValue) const noexcept
+    inline Accumulator_t reduce(F&& callback, const Accumulator_t& initValue) const noexcept
     {
+        JSARRAY_INSTRUMENT("reduce");
         makeMutableType<Accumulator_t> result = initValue;
         for (std::size_t i = 0; i < this->size(); i += 1)
         {
-            result = this->reduceCallbackHandler<F, Accumulator_t>(callback, result, i);
+            result = this->reduceCallbackHandler<Accumulator_t>(callback, result, i);
         }
 
         return result;
     }
 
+    /**
+     * @brief reduce spread over the shared work stealing pool (or the installed JSExecutor). The first elements
+     * are reduced on the calling thread and timed (see mapParallel); if the rest is worth it, it is cut into
+     * blocks sized from the measured cost, every block is reduced on its own starting from identity, and the
+     * block results are combined in order with combineFunc. Equal to reduce when callback and combineFunc are
+     * associative and identity really is one (0 for a sum, 1 for a product...). Both must be safe to call from several threads at once.
+     *
+     * @tparam Accumulator_t accumulator type
+     * @tparam F callback type
+     * @tparam C combiner type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 2, 3, or 4 arguments (accumulator, value, index, self)
+     * @param identity initial value of every block's accumulator
+     * @param combineFunc merges two accumulators, (left, right) -> accumulator
+     * @return Accumulator_t
+     *
+     * @note defined in jsArrayParallel.h
+     */
+    template<typename Accumulator_t, typename F, typename C>
+    inline auto reduceParallel(F&& callback, const Accumulator_t& identity, C combineFunc) const noexcept;
+
+    /**
+     * @brief reduceParallel for callbacks that can also combine two accumulators, like a sum over numbers:
+     * the callback is used as the combiner. See reduceParallel(callback, identity, combineFunc).
+     *
+     * @tparam Accumulator_t accumulator type
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded) with 2 arguments (accumulator, value)
+     * @param identity initial value of every block's accumulator
+     * @return Accumulator_t
+     *
+     * @note defined in jsArrayParallel.h
+     */
+    template<typename Accumulator_t, typename F>
+    inline auto reduceParallel(F&& callback, const Accumulator_t& identity) const noexcept;
+
     /**
      * @brief applies a function against an accumulator and each value of the array (from right-to-left) to reduce it to a single value. 
      * 
@@ -295,12 +719,13 @@ public:
      * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/reduceRight#parameters
      */
     template<typename Accumulator_t, typename F>
-    inline Accumulator_t reduceRight(F callback, const Accumulator_t& initValue) const noexcept
+    inline Accumulator_t reduceRight(F&& callback, const Accumulator_t& initValue) const noexcept
     {
+        JSARRAY_INSTRUMENT("reduceRight");
         makeMutableType<Accumulator_t> result = initValue;
         for (std::size_t i = 0; i < this->size(); i += 1)
         {
-            result = this->reduceCallbackHandler<F, Accumulator_t>(callback, result, this->size() - 1 - i);
+            result = this->reduceCallbackHandler<Accumulator_t>(callback, result, this->size() - 1 - i);
         }
 
         return result;
@@ -316,8 +741,9 @@ public:
      * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/forEach#parameters
      */
     template<typename F>
-    inline void forEach(F callback)
+    inline void forEach(F&& callback)
     {
+        JSARRAY_INSTRUMENT("forEach");
         for (std::size_t i = 0; i < this->size(); i += 1)
         {
             this->standardCallbackHandler(callback, i);
@@ -335,23 +761,33 @@ public:
      * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/filter#parameters
      */
     template<typename F>
-    inline JSArray<element_t, AllocTemplate> filter(F callback) const noexcept
+    inline JSArray<element_t, AllocTemplate> filter(F&& callback) const noexcept
     {
+        JSARRAY_INSTRUMENT("filter");
         static_assert(
             std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
             "callback return type must be bool!!!"
         );
 
-        JSArray<element_t, AllocTemplate> result;
-        for (std::size_t i = 0; i < this->size(); i += 1)
-        {
-            if (this->standardCallbackHandler(callback, i))
-                result.push_back((*this)[i]);
-        }
-
-        return result;
+        // test everything into a bit mask first, so the result is allocated once at its final size. The mask's words
+        // come from AllocTemplate too, filter costs exactly two allocations
+        return this->select(this->maskOf<mask_t>(callback));
     }
 
+    /**
+     * @brief same as filter but the callback runs on the shared work stealing pool (or the installed JSExecutor),
+     * serially when it's measured to be cheap enough (see mapParallel), the kept elements are then copied in order.
+     * The callback must be safe to call from several threads at once.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return JSArray<T, AllocTemplate>
+     *
+     * @note defined in jsArrayParallel.h
+     */
+    template<typename F>
+    inline auto filterParallel(F&& callback) const noexcept;
+
     /**
      * @brief tests whether all elements in the array pass the test implemented by the provided function.
      * 
@@ -362,9 +798,10 @@ public:
      * @note
      * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/every#parameters
      */
-    template<typename F>
-    inline bool every(F callback) const noexcept
+    template<typename F, typename = std::enable_if_t<!jsDetail::IsBitMask<std::decay_t<F>>::value>> // masks go to every(mask)
+    inline bool every(F&& callback) const noexcept
     {
+        JSARRAY_INSTRUMENT("every");
         static_assert(
             std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
             "callback return type must be bool!!!"
@@ -387,9 +824,10 @@ public:
      * @note
      * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/some#parameters
      */
-    template<typename F>
-    inline bool some(F callback) const noexcept
+    template<typename F, typename = std::enable_if_t<!jsDetail::IsBitMask<std::decay_t<F>>::value>> // masks go to some(mask)
+    inline bool some(F&& callback) const noexcept
     {
+        JSARRAY_INSTRUMENT("some");
         static_assert(
             std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
             "callback return type must be bool!!!"
@@ -405,29 +843,973 @@ public:
     }
 
     /**
-     * @brief sort all the elements inplace in ascending order
-     * 
-     * @return JSArray<T, AllocTemplate>& 
+     * @brief runs the test implemented by the provided function on every element and keeps the answers
+     * as a bit packed mask (bit i = result for element i). Masks from several predicates can then be
+     * combined with &, |, ^, ~ a whole word at a time before calling select(mask).
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return JSBasicBitMask<AllocTemplate<std::uint64_t>> (JSBitMask for std::allocator)
      */
-    inline JSArray<element_t, AllocTemplate>& sort() noexcept
+    template<typename F>
+    inline mask_t mask(F&& callback) const noexcept
     {
-        std::sort(this->begin(), this->end(), [](const element_t& a, const element_t& b){return a < b;});
-        return *this;
+        JSARRAY_INSTRUMENT("mask");
+        static_assert(
+            std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
+            "callback return type must be bool!!!"
+        );
+
+        return this->maskOf<mask_t>(callback);
     }
 
     /**
-     * @brief sort all the elements inplace according to the callback function
-     * 
-     * @tparam F callback type
-     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
-     * @return JSArray<T, AllocTemplate>& 
-     * 
+     * @brief creates a copy of the elements whose bit is set in the mask, like filter but with the test already done.
+     * The mask must have as many bits as the array has elements.
+     *
+     * @param selection mask, usually from mask(callback) and combinations of masks
+     * @return JSArray<T, AllocTemplate>
      */
-    template<typename F>
-    inline JSArray<element_t, AllocTemplate>& sort(F compareFunc) noexcept
+    template<typename WordAllocator>
+    inline JSArray<element_t, AllocTemplate> select(const JSBasicBitMask<WordAllocator>& selection) const noexcept
     {
-        std::sort(this->begin(), this->end(), compareFunc);
-        return *this;
+        JSArray<element_t, AllocTemplate> result;
+        result.reserve(selection.popcount());
+        selection.forEachSetBit([&](std::size_t i){result.push_back((*this)[i]);});
+        return result;
+    }
+
+    /**
+     * @brief every() for a test that was already done by mask(callback), checked 64 elements at a time
+     *
+     * @param selection mask with one bit per element
+     * @return bool
+     */
+    template<typename WordAllocator>
+    inline bool every(const JSBasicBitMask<WordAllocator>& selection) const noexcept
+    {
+        return selection.all();
+    }
+
+    /**
+     * @brief some() for a test that was already done by mask(callback), checked 64 elements at a time
+     *
+     * @param selection mask with one bit per element
+     * @return bool
+     */
+    template<typename WordAllocator>
+    inline bool some(const JSBasicBitMask<WordAllocator>& selection) const noexcept
+    {
+        return selection.any();
+    }
+
+    /**
+     * @brief groups the elements by the key the callback returns for them, like javascript's Object.groupBy.
+     * Keys go through an open addressing hash table once, then every element is copied straight
+     * to its final place in one contiguous buffer (see JSGroupBy).
+     *
+     * @tparam F callback type
+     * @param keyFn a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self).
+     * Must return a hashable (std::hash) and equality comparable key.
+     * @return JSGroupBy<key type, T, AllocTemplate>
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Object/groupBy#parameters
+     */
+    template<typename F>
+    inline JSGroupBy<makeKeyType<typename StandardCallbackTraits<F>::return_t>, element_t, AllocTemplate> groupBy(F&& keyFn) const noexcept
+    {
+        JSARRAY_INSTRUMENT("groupBy");
+        using groupKey_t = makeKeyType<typename StandardCallbackTraits<F>::return_t>;
+
+        jsDetail::KeyIndex<groupKey_t> index;
+        std::vector<std::size_t> groupOf(this->size());
+        std::vector<std::size_t> counts;
+        for (std::size_t i = 0; i < this->size(); i += 1)
+        {
+            const auto [id, inserted] = index.insert(this->standardCallbackHandler(keyFn, i));
+            if (inserted)
+                counts.push_back(0);
+
+            counts[id] += 1;
+            groupOf[i] = id;
+        }
+
+        JSGroupBy<groupKey_t, element_t, AllocTemplate> result;
+        result.keys.assign(std::make_move_iterator(index.keys().begin()), std::make_move_iterator(index.keys().end()));
+        this->countsToOffsets(counts, result.offsets);
+
+        std::vector<std::size_t> cursors(result.offsets.begin(), result.offsets.end() - 1);
+        result.values.resize(this->size());
+        for (std::size_t i = 0; i < this->size(); i += 1)
+        {
+            result.values[cursors[groupOf[i]]++] = (*this)[i];
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief same as groupBy but spread over all hardware threads: keys are computed in parallel, elements are
+     * partitioned by key hash so every thread groups its own partition with its own hash table.
+     * The result is identical to groupBy. The callback must be safe to call from several threads at once.
+     *
+     * @tparam F callback type
+     * @param keyFn a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return JSGroupBy<key type, T, AllocTemplate>
+     *
+     * @note defined in jsArrayParallel.h
+     */
+    template<typename F>
+    inline auto groupByParallel(F&& keyFn) const noexcept;
+
+    /**
+     * @brief counts the elements per key the callback returns for them, like lodash's countBy.
+     *
+     * @tparam F callback type
+     * @param keyFn a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self).
+     * Must return a hashable (std::hash) and equality comparable key.
+     * @return JSCountBy<key type, AllocTemplate>
+     */
+    template<typename F>
+    inline JSCountBy<makeKeyType<typename StandardCallbackTraits<F>::return_t>, AllocTemplate> countBy(F&& keyFn) const noexcept
+    {
+        JSARRAY_INSTRUMENT("countBy");
+        using groupKey_t = makeKeyType<typename StandardCallbackTraits<F>::return_t>;
+
+        jsDetail::KeyIndex<groupKey_t> index;
+        JSCountBy<groupKey_t, AllocTemplate> result;
+        for (std::size_t i = 0; i < this->size(); i += 1)
+        {
+            const auto [id, inserted] = index.insert(this->standardCallbackHandler(keyFn, i));
+            if (inserted)
+                result.counts.push_back(0);
+
+            result.counts[id] += 1;
+        }
+
+        result.keys.assign(std::make_move_iterator(index.keys().begin()), std::make_move_iterator(index.keys().end()));
+        return result;
+    }
+
+    /**
+     * @brief same as countBy but spread over all hardware threads, see groupByParallel.
+     * The callback must be safe to call from several threads at once.
+     *
+     * @tparam F callback type
+     * @param keyFn a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return JSCountBy<key type, AllocTemplate>
+     *
+     * @note defined in jsArrayParallel.h
+     */
+    template<typename F>
+    inline auto countByParallel(F&& keyFn) const noexcept;
+
+    /**
+     * @brief removes every element that is equal to an element before it, inplace, keeping the first occurrence
+     * and the original order (same result as [...new Set(array)] in javascript, NaN counts as equal to NaN).
+     * See toUnique for how the work is done.
+     *
+     * @return JSArray<T, AllocTemplate>&
+     */
+    inline JSArray<element_t, AllocTemplate>& unique() noexcept
+    {
+        JSARRAY_INSTRUMENT("unique");
+        const bool wasSorted = sortedAscending;
+        const mask_t keep = this->firstOccurrences();
+        std::size_t written = 0;
+        keep.forEachSetBit([&](std::size_t i)
+        {
+            if (written != i)
+                (*this)[written] = std::move((*this)[i]);
+            written += 1;
+        });
+
+        this->erase(this->begin() + written, this->end());
+        sortedAscending = wasSorted; // removing elements doesn't change the order of the rest
+        return *this;
+    }
+
+    /**
+     * @brief copy of the array without the elements that are equal to an element before them. First occurrence wins
+     * and the original order is kept (same result as [...new Set(array)] in javascript, NaN counts as equal to NaN).
+     *
+     * The strategy is picked from the element type and size:
+     * - numbers, enums and pointers: sort (value, index) pairs and keep the first of every run of equal values
+     * - other types with a std::hash: open addressing hash set of element indices
+     * - anything else: sort indices by operator< and keep the first of every run
+     * - very large hashable arrays: elements are radix partitioned by hash and every thread dedupes its own partition
+     *   (threads of the current JSExecutor: the calling thread alone unless the program includes jsThreadPool.h or installs one)
+     *
+     * @return JSArray<T, AllocTemplate>
+     */
+    inline JSArray<element_t, AllocTemplate> toUnique() const noexcept
+    {
+        JSARRAY_INSTRUMENT("toUnique");
+        return this->select(this->firstOccurrences());
+    }
+
+    /**
+     * @brief distinct elements that are in both arrays, like javascript's Set.prototype.intersection.
+     * When both arrays are sorted in ascending order the result is computed by merging (galloping
+     * through the bigger one when the sizes are very different, and comparing 4 x 4 blocks with SSE2
+     * for 32 bit integers) and is sorted. Otherwise a hash set is used and the result keeps the order of this array.
+     * Element types without a std::hash are always merged (from sorted copies).
+     *
+     * @param other the other array
+     * @return JSArray<T, AllocTemplate>
+     */
+    inline JSArray<element_t, AllocTemplate> intersect(const JSArray<element_t, AllocTemplate>& other) const noexcept
+    {
+        JSARRAY_INSTRUMENT("intersect");
+        JSArray<element_t, AllocTemplate> result;
+        if (this->sortedSetOperation(other, result, [](auto&&... args){jsDetail::sortedIntersect(args...);}))
+            return result;
+
+        if constexpr (isHashable)
+        {
+            const ElementIndexSet otherValues = other.distinctValueSet();
+            ElementIndexSet seen(0, ElementAtHash{this}, ElementAtEqual{this});
+            for (std::size_t i = 0; i < this->size(); i += 1)
+            {
+                if (other.setContains(otherValues, (*this)[i]) && seen.insert(i).second)
+                    result.push_back((*this)[i]);
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief distinct elements that are in either array, like javascript's Set.prototype.union.
+     * Sorted inputs (ascending) are merged and give a sorted result, otherwise the result is the distinct
+     * elements of this array followed by the distinct elements of other that aren't in this array.
+     *
+     * @param other the other array
+     * @return JSArray<T, AllocTemplate>
+     */
+    inline JSArray<element_t, AllocTemplate> unionWith(const JSArray<element_t, AllocTemplate>& other) const noexcept
+    {
+        JSARRAY_INSTRUMENT("unionWith");
+        JSArray<element_t, AllocTemplate> result;
+        if (this->sortedSetOperation(other, result, [](auto&&... args){jsDetail::sortedUnion(args...);}))
+            return result;
+
+        if constexpr (isHashable)
+        {
+            const ElementIndexSet thisValues = this->distinctValueSet();
+            for (const std::size_t i : thisValues.keys())
+            {
+                result.push_back((*this)[i]);
+            }
+
+            ElementIndexSet seen(0, ElementAtHash{&other}, ElementAtEqual{&other});
+            for (std::size_t j = 0; j < other.size(); j += 1)
+            {
+                if (!this->setContains(thisValues, other[j]) && seen.insert(j).second)
+                    result.push_back(other[j]);
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief distinct elements of this array that aren't in other, like javascript's Set.prototype.difference.
+     * Sorted inputs (ascending) are merged and give a sorted result, otherwise the order of this array is kept.
+     *
+     * @param other the other array
+     * @return JSArray<T, AllocTemplate>
+     */
+    inline JSArray<element_t, AllocTemplate> difference(const JSArray<element_t, AllocTemplate>& other) const noexcept
+    {
+        JSARRAY_INSTRUMENT("difference");
+        JSArray<element_t, AllocTemplate> result;
+        if (this->sortedSetOperation(other, result, [](auto&&... args){jsDetail::sortedDifference(args...);}))
+            return result;
+
+        if constexpr (isHashable)
+        {
+            const ElementIndexSet otherValues = other.distinctValueSet();
+            ElementIndexSet seen(0, ElementAtHash{this}, ElementAtEqual{this});
+            for (std::size_t i = 0; i < this->size(); i += 1)
+            {
+                if (!other.setContains(otherValues, (*this)[i]) && seen.insert(i).second)
+                    result.push_back((*this)[i]);
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief distinct elements that are in exactly one of the two arrays, like javascript's Set.prototype.symmetricDifference.
+     * Sorted inputs (ascending) are merged and give a sorted result, otherwise the result is the elements
+     * of this array not in other, followed by the elements of other not in this array.
+     *
+     * @param other the other array
+     * @return JSArray<T, AllocTemplate>
+     */
+    inline JSArray<element_t, AllocTemplate> symmetricDifference(const JSArray<element_t, AllocTemplate>& other) const noexcept
+    {
+        JSARRAY_INSTRUMENT("symmetricDifference");
+        JSArray<element_t, AllocTemplate> result;
+        if (this->sortedSetOperation(other, result, [](auto&&... args){jsDetail::sortedSymmetricDifference(args...);}))
+            return result;
+
+        if constexpr (isHashable)
+        {
+            result = this->difference(other);
+            const JSArray<element_t, AllocTemplate> otherOnly = other.difference(*this);
+            result.insert(result.end(), otherOnly.begin(), otherOnly.end());
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief index of the first element that is not less than value, with a branchless binary search.
+     * The array must be sorted in ascending order (see isSorted).
+     *
+     * @param value value to look for
+     * @return std::size_t, size() if every element is less than value
+     */
+    inline std::size_t lowerBound(const element_t& value) const noexcept
+    {
+        return this->lowerBound(value, [](const element_t& a, const element_t& b){return a < b;});
+    }
+
+    /**
+     * @brief index of the first element that does not come before value according to compareFunc, with a branchless binary search.
+     * The array must be sorted with the same compareFunc.
+     *
+     * @tparam F callback type
+     * @param value value to look for
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return std::size_t
+     */
+    template<typename F>
+    inline std::size_t lowerBound(const element_t& value, F compareFunc) const noexcept
+    {
+        if (this->empty())
+            return 0;
+
+        // the range left to search shrinks by half every step, the comparison only picks where
+        // it starts, which compiles to a conditional move instead of a hard to predict branch
+        const element_t* first = this->data();
+        std::size_t length = this->size();
+        while (length > 1)
+        {
+            const std::size_t half = length / 2;
+            first = compareFunc(first[half], value) ? first + half : first;
+            length -= half;
+        }
+
+        return static_cast<std::size_t>(first - this->data()) + static_cast<std::size_t>(compareFunc(*first, value));
+    }
+
+    /**
+     * @brief index of the first element that is greater than value, with a branchless binary search.
+     * The array must be sorted in ascending order (see isSorted).
+     *
+     * @param value value to look for
+     * @return std::size_t, size() if no element is greater than value
+     */
+    inline std::size_t upperBound(const element_t& value) const noexcept
+    {
+        return this->upperBound(value, [](const element_t& a, const element_t& b){return a < b;});
+    }
+
+    /**
+     * @brief index of the first element that comes after value according to compareFunc, with a branchless binary search.
+     * The array must be sorted with the same compareFunc.
+     *
+     * @tparam F callback type
+     * @param value value to look for
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return std::size_t
+     */
+    template<typename F>
+    inline std::size_t upperBound(const element_t& value, F compareFunc) const noexcept
+    {
+        if (this->empty())
+            return 0;
+
+        const element_t* first = this->data();
+        std::size_t length = this->size();
+        while (length > 1)
+        {
+            const std::size_t half = length / 2;
+            first = compareFunc(value, first[half]) ? first : first + half;
+            length -= half;
+        }
+
+        return static_cast<std::size_t>(first - this->data()) + static_cast<std::size_t>(!compareFunc(value, *first));
+    }
+
+    /**
+     * @brief [lowerBound(value), upperBound(value)), the index range of the elements equal to value.
+     * The array must be sorted in ascending order (see isSorted).
+     *
+     * @param value value to look for
+     * @return std::pair<std::size_t, std::size_t>
+     */
+    inline std::pair<std::size_t, std::size_t> equalRange(const element_t& value) const noexcept
+    {
+        return {this->lowerBound(value), this->upperBound(value)};
+    }
+
+    /**
+     * @brief index of the first element equal to value, or -1, like javascript's indexOf.
+     * Binary search when the array is known to be sorted (see isSorted), a linear scan otherwise.
+     *
+     * @param value value to look for
+     * @return std::ptrdiff_t
+     *
+     * @note
+     * Look here for more information: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/indexOf
+     */
+    inline std::ptrdiff_t sortedIndexOf(const element_t& value) const noexcept
+    {
+        if (sortedAscending)
+        {
+            const std::size_t index = this->lowerBound(value);
+            return index < this->size() && !(value < (*this)[index]) ? static_cast<std::ptrdiff_t>(index) : -1;
+        }
+
+        for (std::size_t i = 0; i < this->size(); i += 1)
+        {
+            if ((*this)[i] == value)
+                return static_cast<std::ptrdiff_t>(i);
+        }
+
+        return -1;
+    }
+
+    /**
+     * @brief copy of the elements x with low <= x < high. When the array is known to be sorted (see isSorted)
+     * both ends are found with binary search and the result is a single contiguous copy (and stays sorted),
+     * otherwise it's a filter over the whole array.
+     *
+     * @param low smallest value to keep
+     * @param high first value not to keep
+     * @return JSArray<T, AllocTemplate>
+     */
+    inline JSArray<element_t, AllocTemplate> rangeFilter(const element_t& low, const element_t& high) const noexcept
+    {
+        if (sortedAscending)
+        {
+            const std::size_t begin = this->lowerBound(low);
+            const std::size_t end = std::max(begin, this->lowerBound(high));
+            JSArray<element_t, AllocTemplate> result(this->data() + begin, this->data() + end);
+            result.sortedAscending = true;
+            return result;
+        }
+
+        return this->filter([&](const element_t& x){return !(x < low) && x < high;});
+    }
+
+    /**
+     * @brief the first k elements of toSorted(), without sorting (or copying) the whole array.
+     * Small k keeps a bounded heap of the k best candidates (one pass, O(n log k)), bigger k
+     * copies the array, selects with nth_element (introselect) and only sorts the first k.
+     *
+     * @param k number of elements wanted, clamped to size()
+     * @return JSArray<T, AllocTemplate> sorted in ascending order
+     */
+    inline JSArray<element_t, AllocTemplate> topK(std::size_t k) const noexcept
+    {
+        JSArray<element_t, AllocTemplate> result = this->topK(k, [](const element_t& a, const element_t& b){return a < b;});
+        result.sortedAscending = true;
+        return result;
+    }
+
+    /**
+     * @brief the first k elements of toSorted(compareFunc), see topK(k).
+     * ex. topK(10, [](auto& a, auto& b){return a.score > b.score;}) is a top 10 leaderboard.
+     *
+     * @tparam F callback type
+     * @param k number of elements wanted, clamped to size()
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return JSArray<T, AllocTemplate> sorted according to compareFunc
+     */
+    template<typename F>
+    inline JSArray<element_t, AllocTemplate> topK(std::size_t k, F compareFunc) const noexcept
+    {
+        JSARRAY_INSTRUMENT("topK");
+        return this->topKOfRange(0, this->size(), k, compareFunc);
+    }
+
+    /**
+     * @brief same as topK(k, compareFunc) but every hardware thread first finds the top k of its own chunk,
+     * then the (threads * k) candidates are reduced to the final k. compareFunc must be safe to call from several threads at once.
+     *
+     * @tparam F callback type
+     * @param k number of elements wanted, clamped to size()
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return JSArray<T, AllocTemplate> sorted according to compareFunc
+     *
+     * @note defined in jsArrayParallel.h
+     */
+    template<typename F>
+    inline auto topKParallel(std::size_t k, F compareFunc) const noexcept;
+
+    /**
+     * @brief sorts only the first k positions inplace: afterwards they hold the k smallest elements in ascending order,
+     * the order of the rest is unspecified.
+     *
+     * @param k number of positions to sort, clamped to size()
+     * @return JSArray<T, AllocTemplate>&
+     */
+    inline JSArray<element_t, AllocTemplate>& partialSort(std::size_t k) noexcept
+    {
+        return this->partialSort(k, [](const element_t& a, const element_t& b){return a < b;});
+    }
+
+    /**
+     * @brief sorts only the first k positions inplace according to the callback function, the order of the rest is unspecified.
+     *
+     * @tparam F callback type
+     * @param k number of positions to sort, clamped to size()
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return JSArray<T, AllocTemplate>&
+     */
+    template<typename F>
+    inline JSArray<element_t, AllocTemplate>& partialSort(std::size_t k, F compareFunc) noexcept
+    {
+        std::partial_sort(this->begin(), this->begin() + std::min(k, this->size()), this->end(), compareFunc);
+        sortedAscending = false;
+        return *this;
+    }
+
+    /**
+     * @brief rearranges the array inplace so that position k holds the element a full sort would put there,
+     * everything before it is not greater and everything after it is not less (introselect, O(n) on average).
+     *
+     * @param k position, the array is left as it is when k >= size()
+     * @return JSArray<T, AllocTemplate>&
+     */
+    inline JSArray<element_t, AllocTemplate>& nthElement(std::size_t k) noexcept
+    {
+        return this->nthElement(k, [](const element_t& a, const element_t& b){return a < b;});
+    }
+
+    /**
+     * @brief nthElement(k) according to the callback function
+     *
+     * @tparam F callback type
+     * @param k position, the array is left as it is when k >= size()
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return JSArray<T, AllocTemplate>&
+     */
+    template<typename F>
+    inline JSArray<element_t, AllocTemplate>& nthElement(std::size_t k, F compareFunc) noexcept
+    {
+        if (k >= this->size())
+            return *this;
+
+        std::nth_element(this->begin(), this->begin() + k, this->end(), compareFunc);
+        sortedAscending = false;
+        return *this;
+    }
+
+    /**
+     * @brief the middle element of the sorted array, found with introselect on a copy (O(n) on average).
+     * For an even number of elements it's the lower of the two middle elements. The array must not be empty.
+     *
+     * @return T
+     */
+    inline element_t median() const noexcept
+    {
+        if (sortedAscending)
+            return (*this)[(this->size() - 1) / 2];
+
+        JSArray<element_t, AllocTemplate> copy = *this;
+        return copy.nthElement((this->size() - 1) / 2)[(this->size() - 1) / 2];
+    }
+
+    /**
+     * @brief merges already sorted arrays (ex. per shard results) into one sorted array, much cheaper than
+     * concatenating and calling sort(). The output is allocated once. Up to 4 arrays are merged by comparing
+     * their heads directly, more go through a loser tree (log2(K) comparisons per element).
+     * Stable: equal elements keep the order of the arrays they come from.
+     *
+     * @tparam Arrays_t any range of JSArray<T, AllocTemplate>, ex. std::vector, std::array or std::span
+     * @param arrays the arrays to merge, every one sorted in ascending order
+     * @return JSArray<T, AllocTemplate> sorted in ascending order
+     */
+    template<typename Arrays_t>
+    static inline JSArray<element_t, AllocTemplate> mergeSorted(const Arrays_t& arrays) noexcept
+    {
+        JSArray<element_t, AllocTemplate> result = mergeSorted(arrays, [](const element_t& a, const element_t& b){return a < b;});
+        result.sortedAscending = true;
+        return result;
+    }
+
+    /**
+     * @brief mergeSorted(arrays) for arrays sorted according to the callback function
+     *
+     * @tparam Arrays_t any range of JSArray<T, AllocTemplate>, ex. std::vector, std::array or std::span
+     * @tparam F callback type
+     * @param arrays the arrays to merge, every one sorted according to compareFunc
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return JSArray<T, AllocTemplate> sorted according to compareFunc
+     */
+    template<typename Arrays_t, typename F>
+    static inline JSArray<element_t, AllocTemplate> mergeSorted(const Arrays_t& arrays, F compareFunc) noexcept
+    {
+        std::vector<jsDetail::MergeRun<element_t>> runs = mergeRunsOf(arrays);
+        JSArray<element_t, AllocTemplate> result;
+        result.reserve(mergeRunsSize(runs));
+        jsDetail::multiwayMerge(runs, compareFunc, std::back_inserter(result));
+        return result;
+    }
+
+    /**
+     * @brief same as mergeSorted(arrays) but the output is split evenly between the hardware threads:
+     * for every thread's first output position, a merge path search finds where each input has to be cut,
+     * then every thread merges its slices straight into its part of the output.
+     *
+     * @tparam Arrays_t any range of JSArray<T, AllocTemplate>, ex. std::vector, std::array or std::span
+     * @param arrays the arrays to merge, every one sorted in ascending order
+     * @return JSArray<T, AllocTemplate> sorted in ascending order
+     *
+     * @note defined in jsArrayParallel.h
+     */
+    template<typename Arrays_t>
+    static inline auto mergeSortedParallel(const Arrays_t& arrays) noexcept;
+
+    /**
+     * @brief mergeSortedParallel(arrays) for arrays sorted according to the callback function.
+     * compareFunc must be safe to call from several threads at once.
+     *
+     * @tparam Arrays_t any range of JSArray<T, AllocTemplate>, ex. std::vector, std::array or std::span
+     * @tparam F callback type
+     * @param arrays the arrays to merge, every one sorted according to compareFunc
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return JSArray<T, AllocTemplate> sorted according to compareFunc
+     *
+     * @note defined in jsArrayParallel.h
+     */
+    template<typename Arrays_t, typename F>
+    static inline auto mergeSortedParallel(const Arrays_t& arrays, F compareFunc) noexcept;
+
+    /**
+     * @brief concatenates every element, converted to a string, separated by separator. Builds the string
+     * in place instead of through a chain of temporaries like reduce would:
+     * string-like elements (std::string, std::string_view, const char*) and char get their lengths summed first
+     * and are copied into one allocation, numbers are written with std::to_chars straight into the result.
+     * Floating point numbers print like javascript's Number.prototype.toString: shortest round trip digits,
+     * exponent form below 1e-6 and from 1e21 on ("1e-7", "1e+21"), "NaN", "Infinity", -0 as "0".
+     * Integers print all their digits, bools as "true"/"false".
+     *
+     * @param separator put between every two elements, "," by default like javascript
+     * @return std::string
+     *
+     * @note
+     * Look here for more information: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/join
+     */
+    inline std::string join(std::string_view separator = ",") const noexcept
+    {
+        JSARRAY_INSTRUMENT("join");
+        static_assert(
+            std::is_convertible_v<const element_t&, std::string_view> || std::is_arithmetic_v<element_t>,
+            "join needs string-like or arithmetic elements"
+        );
+
+        std::string result;
+        if (this->empty())
+            return result;
+
+        if constexpr (std::is_convertible_v<const element_t&, std::string_view> || std::is_same_v<element_t, char> || std::is_same_v<element_t, bool>)
+        {
+            const auto text = [](const element_t& value) -> std::string_view
+            {
+                if constexpr (std::is_same_v<element_t, bool>)
+                    return value ? "true" : "false";
+                else if constexpr (std::is_same_v<element_t, char>)
+                    return std::string_view(&value, 1);
+                else
+                    return value;
+            };
+
+            std::size_t length = separator.size() * (this->size() - 1);
+            for (std::size_t i = 0; i < this->size(); i += 1)
+            {
+                length += text((*this)[i]).size();
+            }
+
+            result.reserve(length);
+            for (std::size_t i = 0; i < this->size(); i += 1)
+            {
+                if (i != 0)
+                    result.append(separator);
+                // vector<bool> hands out temporaries, keep them alive for text()
+                const element_t value = (*this)[i];
+                result.append(text(value));
+            }
+        }
+        else
+        {
+            // big enough for any integer
+            char digits[64];
+            result.reserve(this->size() * (separator.size() + (std::is_integral_v<element_t> ? 4 : 8)));
+            for (std::size_t i = 0; i < this->size(); i += 1)
+            {
+                if (i != 0)
+                    result.append(separator);
+
+                const element_t value = (*this)[i];
+                if constexpr (std::is_floating_point_v<element_t>)
+                {
+                    if (value != value)
+                    {
+                        result.append("NaN");
+                        continue;
+                    }
+                    if (value == std::numeric_limits<element_t>::infinity() || value == -std::numeric_limits<element_t>::infinity())
+                    {
+                        result.append(value > 0 ? "Infinity" : "-Infinity");
+                        continue;
+                    }
+                    if (value == 0)
+                    {
+                        result.push_back('0');
+                        continue;
+                    }
+
+                    appendJSNumber(result, value);
+                }
+                else
+                {
+                    const std::to_chars_result written = std::to_chars(digits, digits + sizeof(digits), value);
+                    result.append(digits, written.ptr);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief writes the array in the binary format described in jsSerialize.h: a header with the element
+     * type, count and alignment, then the elements. Numbers and other trivially copyable elements are written
+     * in one block, strings are length prefixed and nested JSArrays are written recursively.
+     * The result can be read back with deserialize, or viewed without a copy with JSArrayView<T>::fromBuffer.
+     *
+     * @tparam Writer callback type
+     * @param writer a lambda, a function ptr, or a functor called as writer(const void* bytes, std::size_t byteCount)
+     * for every chunk, in order (ex. appending to a buffer or writing to a socket). Whatever it throws is let through.
+     *
+     * @note defined in jsArraySerialize.h
+     */
+    template<typename Writer>
+    inline auto serialize(Writer&& writer) const;
+
+    /**
+     * @brief number of bytes serialize will write
+     *
+     * @note defined in jsArraySerialize.h
+     */
+    inline auto serializedSize() const noexcept;
+
+    /**
+     * @brief reads back an array written by serialize, copying the elements. Use JSArrayView<T>::fromBuffer instead
+     * to read trivially copyable elements in place.
+     *
+     * @param buffer start of the serialized array
+     * @param size size of buffer in bytes
+     * @return std::optional<JSArray<T, AllocTemplate>> empty if buffer isn't a serialized array of this type or is truncated
+     *
+     * @note defined in jsArraySerialize.h
+     */
+    static inline auto deserialize(const void* buffer, std::size_t size) noexcept;
+
+    /**
+     * @brief creates a new array from anything that can be iterated over (containers, views, coroutine generators...),
+     * like javascript's Array.from(iterable). Reserves up front when the range can be measured without consuming it.
+     *
+     * @tparam Range range type
+     * @param range the elements, converted to T
+     * @return JSArray<T, AllocTemplate>
+     *
+     * @note
+     * Look here for more information: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/from
+     */
+    template<typename Range>
+    static inline JSArray<element_t, AllocTemplate> from(Range&& range) noexcept
+    {
+        JSArray<element_t, AllocTemplate> result;
+        reserveForRange(result, range);
+        for (auto&& value : range)
+        {
+            result.push_back(std::forward<decltype(value)>(value));
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Array.from(iterable, mapFn): creates a new array with the results of calling mapFn on every element of the range
+     *
+     * @tparam Range range type
+     * @tparam F callback type
+     * @param range the elements
+     * @param mapFn a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1 or 2 arguments (value, index)
+     * @return JSArray<return type of mapFn, AllocTemplate>
+     */
+    template<typename Range, typename F>
+    static inline JSArray<makeVectorEligibleType<FromMapResult_t<Range, F>>, AllocTemplate> from(Range&& range, F mapFn) noexcept
+    {
+        using range_value_t = decltype(*std::begin(range));
+
+        JSArray<makeVectorEligibleType<FromMapResult_t<Range, F>>, AllocTemplate> result;
+        reserveForRange(result, range);
+        std::size_t i = 0;
+        for (auto&& value : range)
+        {
+            if constexpr (std::is_invocable_v<F&, range_value_t, std::size_t>)
+                result.push_back(mapFn(std::forward<decltype(value)>(value), i));
+            else
+                result.push_back(mapFn(std::forward<decltype(value)>(value)));
+            i += 1;
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief map for callbacks that return an awaitable (a JSTask, or anything co_await accepts), typically
+     * because they do I/O: up to maxConcurrency callbacks are in flight at once instead of one after the other.
+     * Results are collected in order. Blocks until every callback is done and rethrows the first exception
+     * one of them threw. Use a JSAsyncPool to move blocking calls off the calling thread, see jsAsync.h.
+     * C++20 only.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self).
+     * Must be safe to call from several threads at once if the awaitables resume on other threads.
+     * @param maxConcurrency most callbacks awaited at the same time, jsDetail::defaultAsyncConcurrency when left out
+     * @return JSArray<what co_await on the callback's return value gives, AllocTemplate>
+     *
+     * @note defined in jsArrayAsync.h
+     */
+    template<typename F>
+    inline auto mapAsync(F&& callback) const;
+
+    template<typename F>
+    inline auto mapAsync(F&& callback, std::size_t maxConcurrency) const;
+
+    /**
+     * @brief forEach for callbacks that return an awaitable, with up to maxConcurrency of them in flight at once,
+     * see mapAsync. Blocks until every callback is done. C++20 only.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @param maxConcurrency most callbacks awaited at the same time, jsDetail::defaultAsyncConcurrency when left out
+     *
+     * @note defined in jsArrayAsync.h
+     */
+    template<typename F>
+    inline auto forEachAsync(F&& callback) const;
+
+    template<typename F>
+    inline auto forEachAsync(F&& callback, std::size_t maxConcurrency) const;
+
+    /**
+     * @brief sort all the elements inplace in ascending order
+     * 
+     * @return JSArray<T, AllocTemplate>& 
+     */
+    inline JSArray<element_t, AllocTemplate>& sort() noexcept
+    {
+        JSARRAY_INSTRUMENT("sort");
+        std::sort(this->begin(), this->end(), [](const element_t& a, const element_t& b){return a < b;});
+        sortedAscending = true;
+        return *this;
+    }
+
+    /**
+     * @brief sort all the elements inplace according to the callback function
+     * 
+     * @tparam F callback type
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return JSArray<T, AllocTemplate>& 
+     * 
+     */
+    template<typename F>
+    inline JSArray<element_t, AllocTemplate>& sort(F compareFunc) noexcept
+    {
+        JSARRAY_INSTRUMENT("sort");
+        std::sort(this->begin(), this->end(), compareFunc);
+        sortedAscending = false;
+        return *this;
+    }
+
+    /**
+     * @brief sort all the elements inplace in ascending order, in parallel, see sortParallel(compareFunc)
+     *
+     * @return JSArray<T, AllocTemplate>&
+     *
+     * @note defined in jsArrayParallel.h
+     */
+    inline auto& sortParallel() noexcept;
+
+    /**
+     * @brief sort all the elements inplace according to the callback function, in parallel: one slice per
+     * thread of the current executor is sorted, then the slices are merged with a parallel multiway merge
+     * into a buffer and moved back. Not stable, like sort. compareFunc must be safe to call from several threads at once.
+     *
+     * @tparam F callback type
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return JSArray<T, AllocTemplate>&
+     *
+     * @note defined in jsArrayParallel.h
+     */
+    template<typename F>
+    inline auto& sortParallel(F compareFunc) noexcept;
+
+    /**
+     * @brief sorts the elements inplace in ascending order of the key the callback returns for them.
+     * Unlike sort(compareFunc), which would recompute expensive keys (lowercased strings, derived scores...)
+     * in every comparison, every key is computed exactly once. Then (key, index) pairs are sorted (radix sort
+     * when the key is an integer) and the elements are moved straight to their final place. Stable: elements
+     * with equal keys keep their order.
+     *
+     * @tparam F callback type
+     * @param keyFn a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self).
+     * Must return something with operator<.
+     * @return JSArray<T, AllocTemplate>&
+     */
+    template<typename F>
+    inline JSArray<element_t, AllocTemplate>& sortBy(F&& keyFn) noexcept
+    {
+        JSARRAY_INSTRUMENT("sortBy");
+        std::vector<std::size_t> order = this->sortByOrder(keyFn);
+        jsDetail::applyPermutation(*this, order);
+        sortedAscending = false;
+        return *this;
+    }
+
+    /**
+     * @brief make a copy of the current array sorted by the key the callback returns for every element, see sortBy.
+     *
+     * @tparam F callback type
+     * @param keyFn a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return JSArray<T, AllocTemplate>
+     */
+    template<typename F>
+    inline JSArray<element_t, AllocTemplate> toSortedBy(F&& keyFn) const noexcept
+    {
+        JSARRAY_INSTRUMENT("toSortedBy");
+        const std::vector<std::size_t> order = this->sortByOrder(keyFn);
+        JSArray<element_t, AllocTemplate> result;
+        result.reserve(this->size());
+        for (const std::size_t i : order)
+        {
+            result.push_back((*this)[i]);
+        }
+
+        return result;
     }
 
     /**
@@ -437,8 +1819,11 @@ public:
      */
     inline JSArray<element_t, AllocTemplate> toSorted() const noexcept
     {
+        JSARRAY_INSTRUMENT("toSorted");
         JSArray<element_t, AllocTemplate> result = *this;
+        JSARRAY_INSTRUMENT_RESULT(result);
         std::sort(result.begin(), result.end(), [](const element_t& a, const element_t& b){return a < b;});
+        result.sortedAscending = true;
         return result;
     }
 
@@ -453,8 +1838,11 @@ public:
     template<typename F>
     inline JSArray<element_t, AllocTemplate> toSorted(F compareFunc) const noexcept
     {
+        JSARRAY_INSTRUMENT("toSorted");
         JSArray<element_t, AllocTemplate> result = *this;
+        JSARRAY_INSTRUMENT_RESULT(result);
         std::sort(result.begin(), result.end(), compareFunc);
+        result.sortedAscending = false;
         return result;
     }
 };
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <optional>
+
+#include "jsArray.h"
+#include "jsAsync.h"
+
+// definitions of JSArray's mapAsync and forEachAsync (declared and documented in jsArray.h), C++20 only
+
+#if defined(JSARRAY_HAS_COROUTINES)
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename F>
+inline auto JSArray<T, AllocTemplate>::mapAsync(F&& callback) const
+{
+    return this->mapAsync(std::forward<F>(callback), jsDetail::defaultAsyncConcurrency);
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename F>
+inline auto JSArray<T, AllocTemplate>::mapAsync(F&& callback, std::size_t maxConcurrency) const
+{
+    JSARRAY_INSTRUMENT("mapAsync");
+    using result_element_t = makeVectorEligibleType<jsDetail::AwaitResult_t<typename StandardCallbackTraits<F>::return_t>>;
+
+    std::vector<std::optional<result_element_t>> results(this->size());
+    auto step = [&](std::size_t i) -> JSTask<void>
+    {
+        // a coroutine lambda's captures live in its closure: call the callback in place, never a copy that dies before the coroutine ends
+        results[i].emplace(co_await callback_traits_t::standardCallbackHandler(callback, (*this)[i], i, *this));
+    };
+    jsDetail::runAsync(this->size(), maxConcurrency, step);
+
+    JSArray<result_element_t, AllocTemplate> result;
+    result.reserve(this->size());
+    for (std::optional<result_element_t>& value : results)
+    {
+        result.push_back(std::move(*value));
+    }
+
+    return result;
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename F>
+inline auto JSArray<T, AllocTemplate>::forEachAsync(F&& callback) const
+{
+    return this->forEachAsync(std::forward<F>(callback), jsDetail::defaultAsyncConcurrency);
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename F>
+inline auto JSArray<T, AllocTemplate>::forEachAsync(F&& callback, std::size_t maxConcurrency) const
+{
+    JSARRAY_INSTRUMENT("forEachAsync");
+    auto step = [&](std::size_t i) -> JSTask<void>
+    {
+        co_await callback_traits_t::standardCallbackHandler(callback, (*this)[i], i, *this);
+    };
+    jsDetail::runAsync(this->size(), maxConcurrency, step);
+}
+
+#endif
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <optional>
+#include <algorithm>
+
+#include "jsArray.h"
+#include "jsParallel.h"
+#include "jsThreadPool.h"
+
+// definitions of JSArray's ...Parallel methods (declared and documented in jsArray.h). Including this also makes
+// the shared JSThreadPool the default executor, see JSExecutor.
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename F>
+inline auto JSArray<T, AllocTemplate>::mapParallel(F&& callback) const noexcept
+{
+    JSARRAY_INSTRUMENT("mapParallel");
+    using result_element_t = makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>;
+
+    JSArray<result_element_t, AllocTemplate> result(this->size());
+    if constexpr (std::is_same_v<result_element_t, bool>)
+    {
+        // neighbouring bits of a std::vector<bool> can't be written from different threads
+        std::vector<unsigned char> flags(this->size());
+        jsDetail::adaptiveFor<jsDetail::CallSite<self_t, std::decay_t<F>>>(this->size(), [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; i += 1)
+            {
+                flags[i] = this->standardCallbackHandler(callback, i);
+            }
+        });
+
+        for (std::size_t i = 0; i < this->size(); i += 1)
+        {
+            result[i] = flags[i] != 0;
+        }
+    }
+    else
+    {
+        result_element_t* const output = result.data();
+        jsDetail::adaptiveFor<jsDetail::CallSite<self_t, std::decay_t<F>>>(this->size(), [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; i += 1)
+            {
+                output[i] = this->standardCallbackHandler(callback, i);
+            }
+        });
+    }
+
+    JSARRAY_INSTRUMENT_RESULT(result);
+    return result;
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename Accumulator_t, typename F, typename C>
+inline auto JSArray<T, AllocTemplate>::reduceParallel(F&& callback, const Accumulator_t& identity, C combineFunc) const noexcept
+{
+    JSARRAY_INSTRUMENT("reduceParallel");
+    const std::size_t n = this->size();
+    makeMutableType<Accumulator_t> result = identity;
+    auto reduceRange = [&](makeMutableType<Accumulator_t>& accumulator, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; i += 1)
+        {
+            accumulator = this->reduceCallbackHandler<Accumulator_t>(callback, accumulator, i);
+        }
+    };
+
+    const jsDetail::AdaptivePlan plan = jsDetail::adaptiveProbe<jsDetail::CallSite<self_t, std::decay_t<F>>>(n, [&](std::size_t begin, std::size_t end){reduceRange(result, begin, end);});
+    if (!plan.parallel)
+    {
+        reduceRange(result, plan.probed, n);
+        return result;
+    }
+
+    // one partial result per block, blocks are only made bigger than the grain to bound that storage
+    const std::size_t rest = n - plan.probed;
+    const std::size_t blockCount = std::min((rest + plan.grain - 1) / plan.grain, JSExecutor::current().concurrency() * 64);
+    std::vector<std::optional<makeMutableType<Accumulator_t>>> partials(blockCount);
+    jsDetail::parallelFor(blockCount, [&](std::size_t b)
+    {
+        const auto [begin, end] = jsDetail::taskRange(rest, blockCount, b);
+        makeMutableType<Accumulator_t> accumulator = identity;
+        reduceRange(accumulator, plan.probed + begin, plan.probed + end);
+        partials[b].emplace(std::move(accumulator));
+    });
+
+    for (std::optional<makeMutableType<Accumulator_t>>& partial : partials)
+    {
+        result = combineFunc(result, *partial);
+    }
+
+    return result;
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename Accumulator_t, typename F>
+inline auto JSArray<T, AllocTemplate>::reduceParallel(F&& callback, const Accumulator_t& identity) const noexcept
+{
+    return this->reduceParallel(callback, identity, [&callback](const Accumulator_t& left, const Accumulator_t& right){return callback(left, right);});
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename F>
+inline auto JSArray<T, AllocTemplate>::filterParallel(F&& callback) const noexcept
+{
+    JSARRAY_INSTRUMENT("filterParallel");
+    static_assert(
+        std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
+        "callback return type must be bool!!!"
+    );
+
+    std::vector<unsigned char> keep(this->size());
+    std::atomic<std::size_t> kept{0};
+    jsDetail::adaptiveFor<jsDetail::CallSite<self_t, std::decay_t<F>>>(this->size(), [&](std::size_t begin, std::size_t end)
+    {
+        std::size_t rangeKept = 0;
+        for (std::size_t i = begin; i < end; i += 1)
+        {
+            keep[i] = this->standardCallbackHandler(callback, i);
+            rangeKept += keep[i];
+        }
+
+        kept.fetch_add(rangeKept, std::memory_order_relaxed);
+    });
+
+    JSArray<element_t, AllocTemplate> result;
+    result.reserve(kept.load(std::memory_order_relaxed));
+    for (std::size_t i = 0; i < this->size(); i += 1)
+    {
+        if (keep[i])
+            result.push_back((*this)[i]);
+    }
+
+    return result;
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename F>
+inline auto JSArray<T, AllocTemplate>::groupByParallel(F&& keyFn) const noexcept
+{
+    JSARRAY_INSTRUMENT("groupByParallel");
+    using groupKey_t = makeKeyType<typename StandardCallbackTraits<F>::return_t>;
+
+    const std::size_t taskCount = jsDetail::parallelTaskCount(this->size(), jsDetail::parallelGrain);
+    if (taskCount == 1)
+        return this->groupBy(keyFn);
+
+    jsDetail::ParallelGroups<groupKey_t> groups = jsDetail::groupInParallel<groupKey_t>(this->size(), taskCount, [&](std::size_t i){return this->standardCallbackHandler(keyFn, i);});
+
+    JSGroupBy<groupKey_t, element_t, AllocTemplate> result;
+    result.keys.assign(std::make_move_iterator(groups.keys.begin()), std::make_move_iterator(groups.keys.end()));
+    this->countsToOffsets(groups.counts, result.offsets);
+
+    // a group never spans two partitions, so every thread owns the cursors of its groups
+    std::vector<std::size_t> cursors(result.offsets.begin(), result.offsets.end() - 1);
+    result.values.resize(this->size());
+    jsDetail::parallelFor(groups.partitionCount, [&](std::size_t p)
+    {
+        for (std::size_t position = groups.bucketOffsets[p]; position < groups.bucketOffsets[p + 1]; position += 1)
+        {
+            const std::size_t i = groups.bucketIndices[position];
+            result.values[cursors[groups.groupOf[i]]++] = (*this)[i];
+        }
+    });
+
+    return result;
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename F>
+inline auto JSArray<T, AllocTemplate>::countByParallel(F&& keyFn) const noexcept
+{
+    JSARRAY_INSTRUMENT("countByParallel");
+    using groupKey_t = makeKeyType<typename StandardCallbackTraits<F>::return_t>;
+
+    const std::size_t taskCount = jsDetail::parallelTaskCount(this->size(), jsDetail::parallelGrain);
+    if (taskCount == 1)
+        return this->countBy(keyFn);
+
+    jsDetail::ParallelGroups<groupKey_t> groups = jsDetail::groupInParallel<groupKey_t>(this->size(), taskCount, [&](std::size_t i){return this->standardCallbackHandler(keyFn, i);});
+
+    JSCountBy<groupKey_t, AllocTemplate> result;
+    result.keys.assign(std::make_move_iterator(groups.keys.begin()), std::make_move_iterator(groups.keys.end()));
+    result.counts.assign(groups.counts.begin(), groups.counts.end());
+    return result;
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename F>
+inline auto JSArray<T, AllocTemplate>::topKParallel(std::size_t k, F compareFunc) const noexcept
+{
+    JSARRAY_INSTRUMENT("topKParallel");
+    const std::size_t taskCount = jsDetail::parallelTaskCount(this->size(), std::max(jsDetail::parallelGrain, k * 4));
+    if (taskCount == 1)
+        return this->topK(k, compareFunc);
+
+    std::vector<JSArray<element_t, AllocTemplate>> chunkResults(taskCount);
+    jsDetail::parallelFor(taskCount, [&](std::size_t t)
+    {
+        const auto [begin, end] = jsDetail::taskRange(this->size(), taskCount, t);
+        chunkResults[t] = this->topKOfRange(begin, end, k, compareFunc);
+    });
+
+    JSArray<element_t, AllocTemplate> candidates;
+    for (JSArray<element_t, AllocTemplate>& chunkResult : chunkResults)
+    {
+        candidates.insert(candidates.end(), std::make_move_iterator(chunkResult.begin()), std::make_move_iterator(chunkResult.end()));
+    }
+
+    return candidates.topK(k, compareFunc);
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename Arrays_t>
+inline auto JSArray<T, AllocTemplate>::mergeSortedParallel(const Arrays_t& arrays) noexcept
+{
+    JSArray<element_t, AllocTemplate> result = mergeSortedParallel(arrays, [](const element_t& a, const element_t& b){return a < b;});
+    result.sortedAscending = true;
+    return result;
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename Arrays_t, typename F>
+inline auto JSArray<T, AllocTemplate>::mergeSortedParallel(const Arrays_t& arrays, F compareFunc) noexcept
+{
+    const std::vector<jsDetail::MergeRun<element_t>> runs = mergeRunsOf(arrays);
+    const std::size_t total = mergeRunsSize(runs);
+    const std::size_t taskCount = jsDetail::parallelTaskCount(total, jsDetail::parallelGrain);
+    // the threads write into a presized output
+    if constexpr (std::is_default_constructible_v<element_t>)
+    {
+        if (taskCount > 1)
+        {
+            JSArray<element_t, AllocTemplate> result(total);
+            element_t* const output = result.data();
+            jsDetail::parallelFor(taskCount, [&](std::size_t t)
+            {
+                const auto [begin, end] = jsDetail::taskRange(total, taskCount, t);
+                const std::vector<std::size_t> beginCuts = jsDetail::mergeCuts(runs, begin, compareFunc);
+                const std::vector<std::size_t> endCuts = jsDetail::mergeCuts(runs, end, compareFunc);
+                std::vector<jsDetail::MergeRun<element_t>> slices(runs.size());
+                for (std::size_t r = 0; r < runs.size(); r += 1)
+                {
+                    slices[r] = {runs[r].begin + beginCuts[r], runs[r].begin + endCuts[r]};
+                }
+
+                jsDetail::multiwayMerge(slices, compareFunc, output + begin);
+            });
+
+            return result;
+        }
+    }
+
+    return mergeSorted(arrays, compareFunc);
+}
+
+template<typename T, template<typename> class AllocTemplate>
+inline auto& JSArray<T, AllocTemplate>::sortParallel() noexcept
+{
+    JSARRAY_INSTRUMENT("sortParallel");
+    this->sortParallel([](const element_t& a, const element_t& b){return a < b;});
+    sortedAscending = true;
+    return *this;
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename F>
+inline auto& JSArray<T, AllocTemplate>::sortParallel(F compareFunc) noexcept
+{
+    JSARRAY_INSTRUMENT("sortParallel");
+    const std::size_t taskCount = jsDetail::parallelTaskCount(this->size(), jsDetail::parallelGrain);
+    if constexpr (std::is_default_constructible_v<element_t> && !std::is_same_v<element_t, bool>)
+    {
+        if (taskCount > 1)
+        {
+            const std::size_t n = this->size();
+            element_t* const values = this->data();
+            std::vector<jsDetail::MergeRun<element_t>> runs(taskCount);
+            jsDetail::parallelFor(taskCount, [&](std::size_t t)
+            {
+                const auto [begin, end] = jsDetail::taskRange(n, taskCount, t);
+                std::sort(values + begin, values + end, compareFunc);
+                runs[t] = {values + begin, values + end};
+            });
+
+            std::vector<element_t> merged(n);
+            jsDetail::parallelFor(taskCount, [&](std::size_t t)
+            {
+                const auto [begin, end] = jsDetail::taskRange(n, taskCount, t);
+                const std::vector<std::size_t> beginCuts = jsDetail::mergeCuts(runs, begin, compareFunc);
+                const std::vector<std::size_t> endCuts = jsDetail::mergeCuts(runs, end, compareFunc);
+                std::vector<jsDetail::MergeRun<element_t>> slices(taskCount);
+                for (std::size_t r = 0; r < taskCount; r += 1)
+                {
+                    slices[r] = {runs[r].begin + beginCuts[r], runs[r].begin + endCuts[r]};
+                }
+
+                jsDetail::multiwayMerge(slices, compareFunc, merged.data() + begin);
+            });
+
+            jsDetail::parallelFor(taskCount, [&](std::size_t t)
+            {
+                const auto [begin, end] = jsDetail::taskRange(n, taskCount, t);
+                std::move(merged.begin() + begin, merged.begin() + end, values + begin);
+            });
+
+            sortedAscending = false;
+            return *this;
+        }
+    }
+
+    return this->sort(compareFunc);
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <type_traits>
+
+#include "jsArray.h"
+#include "jsSerialize.h"
+
+// definitions of JSArray's serialize, serializedSize and deserialize (declared and documented in jsArray.h),
+// in the binary format of jsSerialize.h
+
+template<typename T, template<typename> class AllocTemplate>
+inline std::size_t JSArray<T, AllocTemplate>::serialPayloadBytes() const noexcept
+{
+    if constexpr (jsDetail::isSerializedRaw<element_t>)
+        return this->size() * sizeof(element_t);
+    else if constexpr (std::is_same_v<element_t, std::string>)
+    {
+        std::size_t bytes = this->size() * sizeof(std::uint64_t);
+        for (const std::string& value : *this)
+        {
+            bytes += value.size();
+        }
+
+        return bytes;
+    }
+    else
+    {
+        std::size_t bytes = 0;
+        for (const element_t& value : *this)
+        {
+            bytes += value.serializedSize();
+        }
+
+        return bytes;
+    }
+}
+
+template<typename T, template<typename> class AllocTemplate>
+inline bool JSArray<T, AllocTemplate>::deserializeFrom(jsDetail::SerialReader& reader, JSArray<element_t, AllocTemplate>& result) noexcept
+{
+    const std::size_t start = reader.position;
+    jsDetail::SerialHeader header;
+    if (!jsDetail::readSerialHeader<element_t>(reader, header))
+        return false;
+
+    const std::size_t payloadEnd = reader.position + static_cast<std::size_t>(header.payloadBytes);
+    if constexpr (jsDetail::isSerializedRaw<element_t>)
+    {
+        const std::size_t count = static_cast<std::size_t>(header.count);
+        if constexpr (std::is_same_v<element_t, bool>)
+        {
+            result.resize(count);
+            for (std::size_t i = 0; i < count; i += 1)
+            {
+                result[i] = reader.current()[i] != 0;
+            }
+        }
+        else
+        {
+            result.resize(count);
+            if (count != 0)
+                std::memcpy(static_cast<void*>(result.base_t::data()), reader.current(), count * sizeof(element_t));
+        }
+
+        reader.position = payloadEnd;
+    }
+    else
+    {
+        // the count comes from outside: don't let it reserve more than the payload could hold
+        result.reserve(std::min(static_cast<std::size_t>(header.count), static_cast<std::size_t>(header.payloadBytes) / 8));
+        for (std::uint64_t i = 0; i < header.count; i += 1)
+        {
+            if constexpr (std::is_same_v<element_t, std::string>)
+            {
+                std::uint64_t length = 0;
+                if (!reader.read(&length, sizeof(length)) || length > payloadEnd - std::min(payloadEnd, reader.position))
+                    return false;
+
+                result.emplace_back(reinterpret_cast<const char*>(reader.current()), static_cast<std::size_t>(length));
+                reader.position += static_cast<std::size_t>(length);
+            }
+            else
+            {
+                element_t value;
+                if (!element_t::deserializeFrom(reader, value))
+                    return false;
+                result.push_back(std::move(value));
+            }
+        }
+
+        if (reader.position != payloadEnd)
+            return false;
+    }
+
+    const std::size_t read = reader.position - start;
+    return reader.skip(jsDetail::alignUp(read, 8) - read);
+}
+
+template<typename T, template<typename> class AllocTemplate>
+template<typename Writer>
+inline auto JSArray<T, AllocTemplate>::serialize(Writer&& writer) const
+{
+    static_assert(jsDetail::isSerializable<element_t>, "serialize needs trivially copyable, std::string or JSArray elements");
+
+    const jsDetail::SerialHeader header = {
+        jsDetail::serialMagic,
+        jsDetail::serialVersion,
+        static_cast<std::uint16_t>(jsDetail::serialTypeOf<element_t>()),
+        jsDetail::serialElementSize<element_t>,
+        jsDetail::serialAlignment<element_t>,
+        static_cast<std::uint64_t>(this->size()),
+        static_cast<std::uint64_t>(this->serialPayloadBytes())
+    };
+    writer(static_cast<const void*>(&header), sizeof(header));
+    jsDetail::writeSerialPadding(writer, jsDetail::serialPayloadOffset(header.alignment) - sizeof(header));
+
+    if constexpr (std::is_same_v<element_t, bool>)
+    {
+        // vector<bool> is bit packed, write one byte per element in chunks
+        unsigned char chunk[256];
+        for (std::size_t begin = 0; begin < this->size(); begin += sizeof(chunk))
+        {
+            const std::size_t end = std::min(this->size(), begin + sizeof(chunk));
+            for (std::size_t i = begin; i < end; i += 1)
+            {
+                chunk[i - begin] = (*this)[i] ? 1 : 0;
+            }
+
+            writer(static_cast<const void*>(chunk), end - begin);
+        }
+    }
+    else if constexpr (jsDetail::isSerializedRaw<element_t>)
+    {
+        if (!this->empty())
+            writer(static_cast<const void*>(this->base_t::data()), this->size() * sizeof(element_t));
+    }
+    else if constexpr (std::is_same_v<element_t, std::string>)
+    {
+        for (const std::string& value : *this)
+        {
+            const std::uint64_t length = value.size();
+            writer(static_cast<const void*>(&length), sizeof(length));
+            writer(static_cast<const void*>(value.data()), value.size());
+        }
+    }
+    else
+    {
+        for (const element_t& value : *this)
+        {
+            value.serialize(writer);
+        }
+    }
+
+    const std::size_t written = jsDetail::serialPayloadOffset(header.alignment) + static_cast<std::size_t>(header.payloadBytes);
+    jsDetail::writeSerialPadding(writer, jsDetail::alignUp(written, 8) - written);
+}
+
+template<typename T, template<typename> class AllocTemplate>
+inline auto JSArray<T, AllocTemplate>::serializedSize() const noexcept
+{
+    return jsDetail::alignUp(jsDetail::serialPayloadOffset(jsDetail::serialAlignment<element_t>) + this->serialPayloadBytes(), 8);
+}
+
+template<typename T, template<typename> class AllocTemplate>
+inline auto JSArray<T, AllocTemplate>::deserialize(const void* buffer, std::size_t size) noexcept
+{
+    jsDetail::SerialReader reader{static_cast<const unsigned char*>(buffer), size};
+    std::optional<JSArray<element_t, AllocTemplate>> result(std::in_place);
+    if (!JSArray<element_t, AllocTemplate>::deserializeFrom(reader, *result))
+        result.reset();
+
+    return result;
+}
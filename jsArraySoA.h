@@ -0,0 +1,379 @@
+#pragma once
+
+#include <tuple>
+#include <utility>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+
+#include "jsArray.h"
+
+/**
+ * @brief A structure of arrays container. Instead of JSArray<Trade> where every Trade {px, qty, ...}
+ * sits next to each other in memory, every field gets its own contiguous JSArray "column". Scanning
+ * one field (ex. map over px) then only touches the bytes of that field instead of dragging every
+ * record through the cache.
+ *
+ * The JS methods take the column(s) they work on as template parameters:
+ * map<0>(cb), reduce<1>(cb, init), filter<2>(cb), sort<0>() etc.
+ * Single column methods forward to the JSArray method of that column, so the callback
+ * gets (value, index, self) like usual, where self is the column. Methods that accept several
+ * columns (map<0, 1>, filter<0, 1>) pass one value per column to the callback instead.
+ *
+ * @tparam Fields   element type of every column, in order. (ex. JSArraySoA<double, int> for {px, qty})
+ */
+template<typename... Fields>
+class JSArraySoA
+{
+private:
+    using index_t = std::size_t;
+    using self_t = JSArraySoA<Fields...>;
+    using columns_t = std::tuple<JSArray<Fields>...>;
+    using all_columns_t = std::index_sequence_for<Fields...>;
+
+    template<std::size_t I>
+    using field_t = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    columns_t columns;
+
+    template<std::size_t... Is>
+    inline void reserveColumns(std::size_t n, std::index_sequence<Is...>) noexcept
+    {
+        (std::get<Is>(columns).reserve(n), ...);
+    }
+
+    // if a column throws, the columns that already got their value drop it again so every column keeps the same size
+    template<typename Row_t, std::size_t... Is>
+    inline void pushColumns(Row_t&& values, std::index_sequence<Is...>)
+    {
+        const std::size_t rows = this->size();
+        try
+        {
+            (std::get<Is>(columns).push_back(std::get<Is>(std::forward<Row_t>(values))), ...);
+        }
+        catch (...)
+        {
+            (this->truncateColumn<Is>(rows), ...);
+            throw;
+        }
+    }
+
+    template<std::size_t I>
+    inline void truncateColumn(std::size_t rows) noexcept
+    {
+        JSArray<field_t<I>>& column = std::get<I>(columns);
+        while (column.size() > rows)
+            column.pop_back();
+    }
+
+    template<std::size_t... Is>
+    inline void swapRows(std::size_t a, std::size_t b, std::index_sequence<Is...>) noexcept
+    {
+        using std::swap;
+        (swap(std::get<Is>(columns)[a], std::get<Is>(columns)[b]), ...);
+    }
+
+    template<std::size_t... Is>
+    inline std::tuple<Fields&...> rowRefs(std::size_t index, std::index_sequence<Is...>) noexcept
+    {
+        return std::tuple<Fields&...>(std::get<Is>(columns)[index]...);
+    }
+
+    template<std::size_t... Is>
+    inline std::tuple<const Fields&...> rowRefs(std::size_t index, std::index_sequence<Is...>) const noexcept
+    {
+        return std::tuple<const Fields&...>(std::get<Is>(columns)[index]...);
+    }
+
+    // result column k holds column[selection[k]], done for every column
+    template<std::size_t... Is>
+    inline self_t gather(const JSArray<index_t>& selection, std::index_sequence<Is...>) const noexcept
+    {
+        self_t result;
+        (gatherColumn<Is>(result, selection), ...);
+        return result;
+    }
+
+    template<std::size_t I>
+    inline void gatherColumn(self_t& result, const JSArray<index_t>& selection) const noexcept
+    {
+        const JSArray<field_t<I>>& source = std::get<I>(columns);
+        JSArray<field_t<I>>& destination = std::get<I>(result.columns);
+        destination.reserve(selection.size());
+        for (std::size_t k = 0; k < selection.size(); k += 1)
+        {
+            destination.push_back(source[selection[k]]);
+        }
+    }
+
+    // permutation that sorts column I according to compareFunc
+    template<std::size_t I, typename F>
+    inline JSArray<index_t> sortedOrder(F compareFunc) const noexcept
+    {
+        const JSArray<field_t<I>>& key = std::get<I>(columns);
+        JSArray<index_t> order(key.size());
+        std::iota(order.begin(), order.end(), index_t{0});
+        std::sort(order.begin(), order.end(), [&](index_t a, index_t b){return compareFunc(key[a], key[b]);});
+        return order;
+    }
+
+public:
+    JSArraySoA() noexcept = default;
+
+    /**
+     * @brief takes over ready made columns
+     *
+     * @throw std::invalid_argument if the columns don't all have the same size
+     */
+    explicit JSArraySoA(JSArray<Fields>... initialColumns)
+        : columns(std::move(initialColumns)...)
+    {
+        const std::size_t rows = this->size();
+        const bool sameSize = std::apply([rows](const auto&... column){return ((column.size() == rows) && ...);}, columns);
+        if (!sameSize)
+            throw std::invalid_argument("JSArraySoA: every column must have the same number of rows");
+    }
+
+    /**
+     * @brief number of rows. Every column has this many elements.
+     */
+    inline std::size_t size() const noexcept { return std::get<0>(columns).size(); }
+    inline bool empty() const noexcept { return this->size() == 0; }
+
+    inline void reserve(std::size_t n) noexcept
+    {
+        this->reserveColumns(n, all_columns_t{});
+    }
+
+    /**
+     * @brief read only access to one column, it is a plain JSArray so every const JSArray method works on it.
+     * It is const so a single column can't be resized behind the others' back: change elements through row()
+     * and add rows with push().
+     *
+     * @tparam I index of the field
+     * @return const JSArray<field_t<I>>&
+     */
+    template<std::size_t I>
+    inline const JSArray<field_t<I>>& column() const noexcept { return std::get<I>(columns); }
+
+    /**
+     * @brief one row as a tuple of references into every column
+     *
+     * @param index row index
+     * @return std::tuple<Fields&...>
+     */
+    inline std::tuple<Fields&...> row(std::size_t index) noexcept { return this->rowRefs(index, all_columns_t{}); }
+    inline std::tuple<const Fields&...> row(std::size_t index) const noexcept { return this->rowRefs(index, all_columns_t{}); }
+
+    /**
+     * @brief append one row, one value per column. If constructing one of the values throws, the row isn't added
+     * to any column and the exception is passed on.
+     *
+     * @return std::size_t the new number of rows
+     */
+    template<typename... Values>
+    inline std::size_t push(Values&&... values)
+    {
+        static_assert(sizeof...(Values) == sizeof...(Fields), "push needs exactly one value per column");
+        this->pushColumns(std::forward_as_tuple(std::forward<Values>(values)...), all_columns_t{});
+        return this->size();
+    }
+
+    /**
+     * @brief creates a new array populated with the results of calling a provided function on the given column(s) of every row
+     *
+     * @tparam Is   the columns to project. With one column the callback can be 1, 2, or 3 arguments (value, index, column),
+     *              with several columns it gets exactly one value per column, in order.
+     * @tparam F    callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded)
+     * @return JSArray of the callback return type
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/map#parameters
+     */
+    template<std::size_t... Is, typename F>
+    inline auto map(F&& callback) const noexcept
+    {
+        static_assert(sizeof...(Is) >= 1, "map needs at least one column index, ex. map<0>(callback)");
+
+        if constexpr (sizeof...(Is) == 1)
+        {
+            return std::get<Is...>(columns).map(callback);
+        }
+        else
+        {
+            using result_element_t = std::remove_reference_t<std::invoke_result_t<F&, const field_t<Is>&...>>;
+            JSArray<result_element_t> result(this->size());
+            for (std::size_t i = 0; i < this->size(); i += 1)
+            {
+                result[i] = callback(std::get<Is>(columns)[i]...);
+            }
+
+            return result;
+        }
+    }
+
+    /**
+     * @brief reduce one column to a single value, see JSArray::reduce
+     *
+     * @tparam I index of the field
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 2, 3, or 4 arguments (accumulator, value, index, column)
+     * @param initValue initial value for the accumulator param (0th paramater)
+     * @return Accumulator_t
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/reduce#parameters
+     */
+    template<std::size_t I, typename Accumulator_t, typename F>
+    inline Accumulator_t reduce(F&& callback, const Accumulator_t& initValue) const noexcept
+    {
+        return std::get<I>(columns).template reduce<Accumulator_t>(callback, initValue);
+    }
+
+    /**
+     * @brief executes a provided callback function once for each element of one column, see JSArray::forEach
+     *
+     * @tparam I index of the field
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, column)
+     */
+    template<std::size_t I, typename F>
+    inline void forEach(F&& callback)
+    {
+        std::get<I>(columns).forEach(callback);
+    }
+
+    /**
+     * @brief tests whether all elements of one column pass the test implemented by the provided function, see JSArray::every
+     */
+    template<std::size_t I, typename F>
+    inline bool every(F&& callback) const noexcept
+    {
+        return std::get<I>(columns).every(callback);
+    }
+
+    /**
+     * @brief tests whether at least one element of one column passes the test implemented by the provided function, see JSArray::some
+     */
+    template<std::size_t I, typename F>
+    inline bool some(F&& callback) const noexcept
+    {
+        return std::get<I>(columns).some(callback);
+    }
+
+    /**
+     * @brief creates a copy of the rows whose projected column(s) pass the test implemented by the provided function.
+     * The test is run once over the projected columns to build a selection vector of row indices, then every
+     * column is gathered with that selection.
+     *
+     * @tparam Is   the columns the test looks at. With one column the callback can be 1, 2, or 3 arguments (value, index, column),
+     *              with several columns it gets exactly one value per column, in order.
+     * @tparam F    callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded) returning bool
+     * @return JSArraySoA<Fields...>
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/filter#parameters
+     */
+    template<std::size_t... Is, typename F>
+    inline self_t filter(F&& callback) const noexcept
+    {
+        static_assert(sizeof...(Is) >= 1, "filter needs at least one column index, ex. filter<0>(callback)");
+
+        JSArray<index_t> selection;
+        selection.reserve(this->size());
+        if constexpr (sizeof...(Is) == 1)
+        {
+            constexpr std::size_t I = (Is + ...); // the one and only column index
+            using column_t = JSArray<field_t<I>>;
+            using column_traits_t = JSCallbackTraits<field_t<I>, column_t>;
+            static_assert(
+                std::is_same_v<std::remove_cv_t<typename column_traits_t::template StandardCallbackTraits<std::remove_reference_t<F>>::return_t>, bool>,
+                "callback return type must be bool!!!"
+            );
+
+            const column_t& projected = std::get<I>(columns);
+            for (std::size_t i = 0; i < projected.size(); i += 1)
+            {
+                if (column_traits_t::standardCallbackHandler(callback, projected[i], i, projected))
+                    selection.push_back(i);
+            }
+        }
+        else
+        {
+            static_assert(
+                std::is_same_v<std::remove_cv_t<std::invoke_result_t<F&, const field_t<Is>&...>>, bool>,
+                "callback return type must be bool!!!"
+            );
+
+            for (std::size_t i = 0; i < this->size(); i += 1)
+            {
+                if (callback(std::get<Is>(columns)[i]...))
+                    selection.push_back(i);
+            }
+        }
+
+        return this->gather(selection, all_columns_t{});
+    }
+
+    /**
+     * @brief sort all rows inplace in ascending order of column I
+     *
+     * @tparam I index of the key field
+     * @return JSArraySoA<Fields...>&
+     */
+    template<std::size_t I>
+    inline self_t& sort() noexcept
+    {
+        return this->sort<I>([](const field_t<I>& a, const field_t<I>& b){return a < b;});
+    }
+
+    /**
+     * @brief sort all rows inplace, comparing the values of column I with the callback function.
+     * The permutation is computed on the key column only and then applied to every column in place, following
+     * its cycles with swaps, so no column is copied and the fields don't need to be default constructible.
+     *
+     * @tparam I index of the key field
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return JSArraySoA<Fields...>&
+     */
+    template<std::size_t I, typename F>
+    inline self_t& sort(F compareFunc) noexcept
+    {
+        // row k takes the row at order[k]. Every cycle of the permutation is walked once, order[k] = k marks a placed row
+        JSArray<index_t> order = this->sortedOrder<I>(compareFunc);
+        for (std::size_t start = 0; start < order.size(); start += 1)
+        {
+            std::size_t k = start;
+            while (order[k] != start)
+            {
+                const std::size_t next = order[k];
+                this->swapRows(k, next, all_columns_t{});
+                order[k] = k;
+                k = next;
+            }
+
+            order[k] = k;
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief make a copy of all rows sorted in ascending order of column I
+     */
+    template<std::size_t I>
+    inline self_t toSorted() const noexcept
+    {
+        return this->toSorted<I>([](const field_t<I>& a, const field_t<I>& b){return a < b;});
+    }
+
+    /**
+     * @brief make a copy of all rows sorted by column I according to the callback function
+     */
+    template<std::size_t I, typename F>
+    inline self_t toSorted(F compareFunc) const noexcept
+    {
+        return this->gather(this->sortedOrder<I>(compareFunc), all_columns_t{});
+    }
+};
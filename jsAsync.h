@@ -0,0 +1,352 @@
+#pragma once
+
+// coroutine support for JSArray::mapAsync and forEachAsync, C++20 only
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define JSARRAY_HAS_COROUTINES 1
+#endif
+#endif
+
+#if defined(JSARRAY_HAS_COROUTINES)
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <optional>
+#include <exception>
+#include <coroutine>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+#include "jsParallel.h"
+#include "jsThreadPool.h"
+
+/**
+ * @brief lazily started coroutine producing a T, what the callbacks of mapAsync/forEachAsync usually return:
+ * [&](const Key& key) -> JSTask<Value> { co_return co_await pool.run([&]{return cache.lookup(key);}); }
+ * It starts when awaited and resumes its awaiter when done. Exceptions are rethrown to the awaiter.
+ *
+ * @tparam T result type, void for none
+ */
+template<typename T = void>
+class JSTask
+{
+public:
+    struct promise_type;
+
+private:
+    struct PromiseBase
+    {
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+        std::exception_ptr error;
+
+        // symmetric transfer back to the awaiter, so long chains don't grow the stack
+        struct FinalAwaiter
+        {
+            inline bool await_ready() const noexcept { return false; }
+
+            template<typename Promise_t>
+            inline std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise_t> finished) noexcept
+            {
+                return finished.promise().continuation;
+            }
+
+            inline void await_resume() const noexcept {}
+        };
+
+        inline std::suspend_always initial_suspend() const noexcept { return {}; }
+        inline FinalAwaiter final_suspend() const noexcept { return {}; }
+        inline void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    template<typename U>
+    struct ValuePromise : PromiseBase
+    {
+        std::optional<U> value;
+
+        template<typename V>
+        inline void return_value(V&& result) { value.emplace(std::forward<V>(result)); }
+
+        inline U take()
+        {
+            if (this->error)
+                std::rethrow_exception(this->error);
+            return std::move(*value);
+        }
+    };
+
+    struct VoidPromise : PromiseBase
+    {
+        inline void return_void() const noexcept {}
+
+        inline void take()
+        {
+            if (this->error)
+                std::rethrow_exception(this->error);
+        }
+    };
+
+    using promise_base_t = std::conditional_t<std::is_void_v<T>, VoidPromise, ValuePromise<std::conditional_t<std::is_void_v<T>, int, T>>>;
+
+    std::coroutine_handle<promise_type> handle;
+
+    explicit JSTask(std::coroutine_handle<promise_type> coroutine) noexcept : handle(coroutine) {}
+
+public:
+    struct promise_type : promise_base_t
+    {
+        inline JSTask<T> get_return_object() noexcept
+        {
+            return JSTask<T>(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+    };
+
+    JSTask(const JSTask&) = delete;
+
+    JSTask(JSTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    JSTask& operator=(JSTask other) noexcept
+    {
+        std::swap(handle, other.handle);
+        return *this;
+    }
+
+    ~JSTask() noexcept
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    inline auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            std::coroutine_handle<promise_type> task;
+
+            inline bool await_ready() const noexcept { return false; }
+
+            inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                task.promise().continuation = awaiting;
+                return task;
+            }
+
+            inline T await_resume() { return task.promise().take(); }
+        };
+
+        return Awaiter{handle};
+    }
+};
+
+/**
+ * @brief fixed set of threads resuming coroutines, for running blocking calls (disk reads, cache lookups...)
+ * off the calling thread: co_await pool.schedule() continues the coroutine on a pool thread, and
+ * co_await pool.run(fn) runs fn there and hands back its result. With mapAsync/forEachAsync this overlaps as many
+ * blocking calls as there are pool threads. Pending work is finished before the destructor returns.
+ */
+class JSAsyncPool
+{
+private:
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::deque<std::coroutine_handle<>> queue;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+
+    inline void enqueue(std::coroutine_handle<> coroutine)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(coroutine);
+        }
+        wakeUp.notify_one();
+    }
+
+    inline void work()
+    {
+        while (true)
+        {
+            std::coroutine_handle<> coroutine;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait(lock, [this]{return stopping || !queue.empty();});
+                if (queue.empty())
+                    return;
+
+                coroutine = queue.front();
+                queue.pop_front();
+            }
+
+            coroutine.resume();
+        }
+    }
+
+public:
+    /**
+     * @param threadCount number of threads, as many as blocking calls that should be in flight at once
+     */
+    explicit JSAsyncPool(std::size_t threadCount = jsDetail::hardwareThreads())
+    {
+        threads.reserve(threadCount);
+        for (std::size_t t = 0; t < std::max<std::size_t>(threadCount, 1); t += 1)
+            threads.emplace_back([this]{this->work();});
+    }
+
+    JSAsyncPool(const JSAsyncPool&) = delete;
+    JSAsyncPool& operator=(const JSAsyncPool&) = delete;
+
+    ~JSAsyncPool() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+    inline std::size_t size() const noexcept { return threads.size(); }
+
+    /**
+     * @brief awaitable moving the awaiting coroutine onto a pool thread
+     */
+    inline auto schedule() noexcept
+    {
+        struct Awaiter
+        {
+            JSAsyncPool* pool;
+
+            inline bool await_ready() const noexcept { return false; }
+            inline void await_suspend(std::coroutine_handle<> awaiting) { pool->enqueue(awaiting); }
+            inline void await_resume() const noexcept {}
+        };
+
+        return Awaiter{this};
+    }
+
+    /**
+     * @brief runs fn() on a pool thread, co_await the result
+     *
+     * @tparam G callable type
+     * @param fn blocking work
+     * @return JSTask<return type of fn>
+     */
+    template<typename G>
+    inline JSTask<std::invoke_result_t<G&>> run(G fn)
+    {
+        co_await this->schedule();
+        co_return fn();
+    }
+};
+
+// the driver behind mapAsync/forEachAsync. Not meant to be used directly.
+namespace jsDetail
+{
+    // how many callbacks mapAsync/forEachAsync keep in flight unless told otherwise
+    inline constexpr std::size_t defaultAsyncConcurrency = 64;
+
+    template<typename Awaitable_t>
+    inline decltype(auto) getAwaiter(Awaitable_t&& awaitable) noexcept
+    {
+        if constexpr (requires {std::forward<Awaitable_t>(awaitable).operator co_await();})
+            return std::forward<Awaitable_t>(awaitable).operator co_await();
+        else if constexpr (requires {operator co_await(std::forward<Awaitable_t>(awaitable));})
+            return operator co_await(std::forward<Awaitable_t>(awaitable));
+        else
+            return std::forward<Awaitable_t>(awaitable);
+    }
+
+    // what co_await on an Awaitable_t prvalue evaluates to
+    template<typename Awaitable_t>
+    using AwaitResult_t = decltype(getAwaiter(std::declval<Awaitable_t>()).await_resume());
+
+    // fire and forget coroutine, starts right away and frees itself when done
+    struct DetachedTask
+    {
+        struct promise_type
+        {
+            inline DetachedTask get_return_object() const noexcept { return {}; }
+            inline std::suspend_never initial_suspend() const noexcept { return {}; }
+            inline std::suspend_never final_suspend() const noexcept { return {}; }
+            inline void return_void() const noexcept {}
+            inline void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    };
+
+    // counts the workers down and keeps the first exception
+    struct AsyncCompletion
+    {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::size_t remaining;
+        std::exception_ptr error;
+
+        explicit AsyncCompletion(std::size_t workers) noexcept : remaining(workers) {}
+
+        inline void finish(std::exception_ptr workerError) noexcept
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (workerError && !error)
+                error = workerError;
+            remaining -= 1;
+            // notify while holding the lock: the waiter may destroy *this as soon as it's released
+            if (remaining == 0)
+                done.notify_all();
+        }
+
+        inline void wait() noexcept
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this]{return remaining == 0;});
+        }
+    };
+
+    template<typename Step>
+    inline DetachedTask asyncWorker(std::atomic<std::size_t>& next, std::size_t n, Step& step, AsyncCompletion& completion)
+    {
+        std::exception_ptr error;
+        try
+        {
+            for (std::size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1))
+                co_await step(i);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+            // no new work after a failure
+            next.store(n);
+        }
+
+        completion.finish(error);
+    }
+
+    /**
+     * @brief awaits step(i) for every i in [0, n), at most maxConcurrency at once, and returns when all are done.
+     * Every worker coroutine claims the next index when its previous step completes, so a slow step doesn't
+     * hold the others back. Rethrows the first exception a step threw.
+     */
+    template<typename Step>
+    inline void runAsync(std::size_t n, std::size_t maxConcurrency, Step& step)
+    {
+        if (n == 0)
+            return;
+
+        const std::size_t workers = std::min(n, std::max<std::size_t>(maxConcurrency, 1));
+        std::atomic<std::size_t> next{0};
+        AsyncCompletion completion(workers);
+        for (std::size_t w = 0; w < workers; w += 1)
+            asyncWorker(next, n, step, completion);
+
+        completion.wait();
+        if (completion.error)
+            std::rethrow_exception(completion.error);
+    }
+}
+
+#endif
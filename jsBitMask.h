@@ -0,0 +1,219 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#if __cplusplus >= 202002L
+#include <bit>
+#endif
+
+/**
+ * @brief one bit per element of an array, packed 64 to a word. Returned by JSArray::mask(callback)
+ * so the result of a predicate can be kept around and combined with other predicates using
+ * &, |, ^ and ~ one whole word (64 elements) at a time, instead of re-scanning the array or
+ * building an intermediate filtered array for every predicate.
+ *
+ * Bits past size() in the last word are always kept at 0 so popcount/all/any never need a tail mask.
+ *
+ * JSBitMask is the std::allocator one. JSArray keeps its masks (mask, filter, unique...) in the array's
+ * own AllocTemplate, so a counting (or mmap, NUMA...) allocator sees the words too.
+ *
+ * @tparam WordAllocator allocator of the 64 bit words
+ */
+template<typename WordAllocator = std::allocator<std::uint64_t>>
+class JSBasicBitMask
+{
+private:
+    using word_t = std::uint64_t;
+    static constexpr std::size_t bitsPerWord = 64;
+
+    std::vector<word_t, WordAllocator> bits;
+    std::size_t bitCount = 0;
+
+    static inline std::size_t popcountWord(word_t word) noexcept
+    {
+#if __cplusplus >= 202002L
+        return static_cast<std::size_t>(std::popcount(word));
+#elif defined(__GNUC__)
+        return static_cast<std::size_t>(__builtin_popcountll(word));
+#else
+        word = word - ((word >> 1) & 0x5555555555555555ull);
+        word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+        word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return static_cast<std::size_t>((word * 0x0101010101010101ull) >> 56);
+#endif
+    }
+
+    static inline std::size_t countTrailingZeros(word_t word) noexcept
+    {
+#if __cplusplus >= 202002L
+        return static_cast<std::size_t>(std::countr_zero(word));
+#elif defined(__GNUC__)
+        return static_cast<std::size_t>(__builtin_ctzll(word));
+#else
+        std::size_t result = 0;
+        for (; (word & 1) == 0; word >>= 1)
+            result += 1;
+        return result;
+#endif
+    }
+
+    // bits of the last word that are actually in use
+    inline word_t lastWordMask() const noexcept
+    {
+        const std::size_t usedBits = bitCount % bitsPerWord;
+        return usedBits == 0 ? ~word_t{0} : (word_t{1} << usedBits) - 1;
+    }
+
+    inline void clearUnusedBits() noexcept
+    {
+        if (!bits.empty())
+            bits.back() &= this->lastWordMask();
+    }
+
+public:
+    JSBasicBitMask() noexcept = default;
+
+    /**
+     * @param size number of bits
+     * @param value initial value of every bit
+     */
+    explicit JSBasicBitMask(std::size_t size, bool value = false) noexcept
+        : bits((size + bitsPerWord - 1) / bitsPerWord, value ? ~word_t{0} : word_t{0}), bitCount(size)
+    {
+        this->clearUnusedBits();
+    }
+
+    inline std::size_t size() const noexcept { return bitCount; }
+    inline std::size_t wordCount() const noexcept { return bits.size(); }
+
+    // raw words, bit i lives in word i / 64 at position i % 64
+    inline const word_t* words() const noexcept { return bits.data(); }
+    inline word_t* words() noexcept { return bits.data(); }
+
+    inline bool operator[](std::size_t index) const noexcept
+    {
+        return (bits[index / bitsPerWord] >> (index % bitsPerWord)) & 1;
+    }
+
+    inline void set(std::size_t index, bool value = true) noexcept
+    {
+        const word_t bit = word_t{1} << (index % bitsPerWord);
+        word_t& word = bits[index / bitsPerWord];
+        word = value ? (word | bit) : (word & ~bit);
+    }
+
+    /**
+     * @brief number of set bits
+     */
+    inline std::size_t popcount() const noexcept
+    {
+        std::size_t result = 0;
+        for (const word_t word : bits)
+            result += popcountWord(word);
+
+        return result;
+    }
+
+    /**
+     * @brief true if every bit is set (also true for an empty mask, like [].every())
+     */
+    inline bool all() const noexcept
+    {
+        if (bits.empty())
+            return true;
+
+        for (std::size_t w = 0; w + 1 < bits.size(); w += 1)
+        {
+            if (bits[w] != ~word_t{0})
+                return false;
+        }
+
+        return bits.back() == this->lastWordMask();
+    }
+
+    /**
+     * @brief true if at least one bit is set
+     */
+    inline bool any() const noexcept
+    {
+        for (const word_t word : bits)
+        {
+            if (word != 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    inline bool none() const noexcept { return !this->any(); }
+
+    /**
+     * @brief calls visit(index) for every set bit, in increasing index order
+     */
+    template<typename G>
+    inline void forEachSetBit(G&& visit) const noexcept
+    {
+        for (std::size_t w = 0; w < bits.size(); w += 1)
+        {
+            for (word_t word = bits[w]; word != 0; word &= word - 1)
+                visit(w * bitsPerWord + countTrailingZeros(word));
+        }
+    }
+
+    // both masks must have the same size
+    inline JSBasicBitMask& operator&=(const JSBasicBitMask& other) noexcept
+    {
+        for (std::size_t w = 0; w < bits.size(); w += 1)
+            bits[w] &= other.bits[w];
+        return *this;
+    }
+
+    inline JSBasicBitMask& operator|=(const JSBasicBitMask& other) noexcept
+    {
+        for (std::size_t w = 0; w < bits.size(); w += 1)
+            bits[w] |= other.bits[w];
+        return *this;
+    }
+
+    inline JSBasicBitMask& operator^=(const JSBasicBitMask& other) noexcept
+    {
+        for (std::size_t w = 0; w < bits.size(); w += 1)
+            bits[w] ^= other.bits[w];
+        return *this;
+    }
+
+    inline JSBasicBitMask operator~() const noexcept
+    {
+        JSBasicBitMask result = *this;
+        for (word_t& word : result.bits)
+            word = ~word;
+        result.clearUnusedBits();
+        return result;
+    }
+
+    friend inline JSBasicBitMask operator&(JSBasicBitMask a, const JSBasicBitMask& b) noexcept { return a &= b; }
+    friend inline JSBasicBitMask operator|(JSBasicBitMask a, const JSBasicBitMask& b) noexcept { return a |= b; }
+    friend inline JSBasicBitMask operator^(JSBasicBitMask a, const JSBasicBitMask& b) noexcept { return a ^= b; }
+
+    friend inline bool operator==(const JSBasicBitMask& a, const JSBasicBitMask& b) noexcept
+    {
+        return a.bitCount == b.bitCount && a.bits == b.bits;
+    }
+
+    friend inline bool operator!=(const JSBasicBitMask& a, const JSBasicBitMask& b) noexcept { return !(a == b); }
+};
+
+using JSBitMask = JSBasicBitMask<>;
+
+namespace jsDetail
+{
+    // true for every JSBasicBitMask, so callback overloads can step aside for the mask overloads
+    template<typename T>
+    struct IsBitMask : std::false_type {};
+
+    template<typename WordAllocator>
+    struct IsBitMask<JSBasicBitMask<WordAllocator>> : std::true_type {};
+}
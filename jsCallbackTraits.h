@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief callback arity detection shared by JSArray and the other JS style containers.
+ * Every container hands its callbacks (value, index, self), (accumulator, value, index, self)
+ * or any prefix of those, so the meta programming only depends on the element type and
+ * on the type of "self".
+ *
+ * @tparam Element_t    element type of the container
+ * @tparam Self_t       container type passed as the "self" callback parameter
+ */
+template<typename Element_t, typename Self_t>
+struct JSCallbackTraits
+{
+// START OF FUNCTION TRAITS META PROGRAMMING CODE
+    // just to convey intention in code
+    using element_t = Element_t;
+    using index_t = std::size_t;
+    using self_t = Self_t;
+
+    // the programer should not use this directly. use StandardCallbackTraits<F>::return_t
+    template<typename F, std::size_t arity>
+    struct GetStandardCallBackReturnType;
+
+    // no signature matched, only there so the static_assert in the traits is the first error reported
+    template<typename F>
+    struct GetStandardCallBackReturnType<F, 0> {using type = void;};
+
+    template<typename F>
+    struct GetStandardCallBackReturnType<F, 1> {using type = std::invoke_result_t<F&, element_t&>;};
+
+    template<typename F>
+    struct GetStandardCallBackReturnType<F, 2> {using type = std::invoke_result_t<F&, element_t&, index_t>;};
+
+    template<typename F>
+    struct GetStandardCallBackReturnType<F, 3> {using type = std::invoke_result_t<F&, element_t&, index_t, self_t&>;};
+
+
+
+
+    // the programer should not use this directly. use ReduceCallbackTraits<F, Accumulator_t>::return_t
+    template<typename F, typename Accumulator_t, std::size_t arity>
+    struct GetReduceCallBackReturnType;
+
+    template<typename F, typename Accumulator_t>
+    struct GetReduceCallBackReturnType<F, Accumulator_t, 0> {using type = void;};
+
+    template<typename F, typename Accumulator_t>
+    struct GetReduceCallBackReturnType<F, Accumulator_t, 2> {using type = std::invoke_result_t<F&, Accumulator_t&, element_t&>;};
+
+    template<typename F, typename Accumulator_t>
+    struct GetReduceCallBackReturnType<F, Accumulator_t, 3> {using type = std::invoke_result_t<F&, Accumulator_t&, element_t&, index_t>;};
+
+    template<typename F, typename Accumulator_t>
+    struct GetReduceCallBackReturnType<F, Accumulator_t, 4> {using type = std::invoke_result_t<F&, Accumulator_t&, element_t&, index_t, self_t&>;};
+
+
+    /**
+     * this struct (along with ReduceCallbackTraits) was made to allow for auto lambdas,
+     * aka [](auto a, auto b){}; previously the function_traits struct forced defined types,
+     * and due to the method of meta programming, the callbacks were not allowed to contain auto
+     * parameters. This fixes that, and makes the interfaces just that much easier to use.
+     * 
+     * Note about the following type sequences:
+     * element_t&
+     * element_t& index_t
+     * element_t& index_t self_t&
+     * 
+     * In std::is_invocable_v && std::invoke_result_t, as far as I understand it,
+     * these types are the ones that are "passed" into the function, and therefore
+     * I choose the most unconstrained types that the callback function itself
+     * can later choose to constrain with const, volatile, or just straight make a
+     * copy without any reference. There might be the question of "well all the methods
+     * that are being added (map, reduce, etc) are const and therefore I should actually
+     * pass in const element_t& and const self_t&", but I would prefer for the error to be
+     * thrown closer to the calling method than here at the compile time meta programming stage.
+     *
+     * Oh also, index_t is not passed as a reference as I don't want the callback mucking
+     * up my index variable. So it must always be passed by value. Having the callback
+     * modify the index can result in very undefined behavior so we won't allow for that.
+     * And in addition there is no later mechanism from the const methods to say that
+     * a reference to index_t is not ok so I have to put my foot down here unfortunately.
+     * 
+     * A note though. r value references are not allowed as types here
+     * tbh I don't feel like I know them well enough to implement them so I'll
+     * stay away.
+     *
+     * The probe is a chain of if constexpr, so only the signatures up to the first one that
+     * matches get instantiated (usually just one), the same for c++17 and c++20. The shortest
+     * signature wins if more than one matches. 0 means none matched, which fails the static_assert
+     * right below the probe before anything else tries to use return_t.
+     *
+     * F is probed as F& because the handlers below call the callback through a reference, the one
+     * the container methods take it by. The callback is never copied, so a stateful functor keeps
+     * its state from one element to the next.
+     */
+    template<typename F>
+    struct StandardCallbackTraits
+    {
+        static constexpr std::size_t probe() noexcept
+        {
+            if constexpr (std::is_invocable_v<F&, element_t&>)
+                return 1;
+            else if constexpr (std::is_invocable_v<F&, element_t&, index_t>)
+                return 2;
+            else if constexpr (std::is_invocable_v<F&, element_t&, index_t, self_t&>)
+                return 3;
+            else
+                return 0;
+        }
+
+        static constexpr std::size_t arity = probe();
+        static_assert(arity != 0, "\nCallback can't be called with (val), (val, index) or (val, index, self), see standardCallbackHandler\n");
+        using return_t = typename GetStandardCallBackReturnType<F, arity>::type;
+    };
+
+    template<typename F, typename Accumulator_t>
+    struct ReduceCallbackTraits
+    {
+        // virtually the same as StandardCallbackTraits except the range of acceptable
+        // arity is [2, 4] and there needs to be an Accumulator_t
+        static constexpr std::size_t probe() noexcept
+        {
+            if constexpr (std::is_invocable_v<F&, Accumulator_t&, element_t&>)
+                return 2;
+            else if constexpr (std::is_invocable_v<F&, Accumulator_t&, element_t&, index_t>)
+                return 3;
+            else if constexpr (std::is_invocable_v<F&, Accumulator_t&, element_t&, index_t, self_t&>)
+                return 4;
+            else
+                return 0;
+        }
+
+        static constexpr std::size_t arity = probe();
+        static_assert(arity != 0, "\nCallback can't be called with (accumulator, val), (accumulator, val, index) or (accumulator, val, index, self), see reduceCallbackHandler\n");
+        using return_t = typename GetReduceCallBackReturnType<F, Accumulator_t, arity>::type;
+    };
+// END OF FUNCTION TRAITS META PROGRAMMING CODE
+
+
+
+
+    // not noexcept, whatever the callback throws reaches the container method and it decides: JSArray and
+    // JSDeque methods are noexcept (so a throw terminates), MappedJSArray's and the external sort let it through
+    template<typename F, typename Value_t>
+    static inline typename StandardCallbackTraits<F>::return_t standardCallbackHandler(F& callback, Value_t& value, index_t currLoopIndex, const self_t& self)
+    {
+        constexpr std::size_t argsCount = StandardCallbackTraits<F>::arity;
+        if constexpr (argsCount == 1)
+            return callback(value);
+        if constexpr (argsCount == 2)
+            return callback(value, currLoopIndex);
+        if constexpr (argsCount == 3)
+            return callback(value, currLoopIndex, self);
+
+        static_assert(
+            argsCount <= 3 && argsCount >= 1,
+            "\nFunction signature should look like either of these three: (1 to 3 params max)\n"
+            "return_type (auto&& val)\n"
+            "return_type (auto&& val, auto&& index)\n"
+            "return_type (auto&& val, auto&& index, auto&& self)\n"
+            "you can also define explicitly the types if you want. NOTE, the index type must be an integral type and NOT a reference\n"
+        );
+    }
+
+    template<typename Accumulator_t, typename F, typename Value_t>
+    static inline typename ReduceCallbackTraits<F, Accumulator_t>::return_t reduceCallbackHandler(F& callback, std::remove_const_t<Accumulator_t>& accumulator, Value_t& value, index_t currLoopIndex, const self_t& self)
+    {
+        // I remove const from Accumulator_t to allow the most permissive type to be passed into
+        // callback. Remember this is the "actual" accumulator variable and it's declared and defined internally.
+        // The accumulator declared by the callback acts as nothing more than accessor. The callback will
+        // restrict with cv qualifiers if needed. Also make sure its a ref just incase the accumulator
+        // type is big and heavy to minimize copying.
+
+        constexpr std::size_t argsCount = ReduceCallbackTraits<F, Accumulator_t>::arity;
+        if constexpr (argsCount == 2)
+            return callback(accumulator, value);
+        if constexpr (argsCount == 3)
+            return callback(accumulator, value, currLoopIndex);
+        if constexpr (argsCount == 4)
+            return callback(accumulator, value, currLoopIndex, self);
+
+        static_assert(
+            argsCount <= 4 && argsCount >= 2,
+            "\nFunction signature should look like either of these three (2 to 4 params max):\n"
+            "return_type (auto&& accumulator, auto&& val)\n"
+            "return_type (auto&& accumulator, auto&& val, auto&& index)\n"
+            "return_type (auto&& accumulator, auto&& val, auto&& index, auto&& self)\n"
+            "you can also define explicitly the types if you want. NOTE, the index type must be an integral type and NOT a reference\n"
+        );
+    }
+};
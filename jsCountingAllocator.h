@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+/**
+ * @brief allocation counts and bytes, all JSCountingAllocator instances together
+ */
+struct JSAllocationStats
+{
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+    std::size_t bytesAllocated = 0;
+    std::size_t bytesDeallocated = 0;
+
+    inline std::size_t liveBytes() const noexcept { return bytesAllocated - bytesDeallocated; }
+
+    inline JSAllocationStats operator-(const JSAllocationStats& earlier) const noexcept
+    {
+        return {allocations - earlier.allocations, deallocations - earlier.deallocations, bytesAllocated - earlier.bytesAllocated, bytesDeallocated - earlier.bytesDeallocated};
+    }
+
+    /**
+     * @brief totals since the program started (or the last reset)
+     */
+    static inline JSAllocationStats current() noexcept;
+
+    static inline void reset() noexcept;
+};
+
+// the process wide counters behind JSCountingAllocator. Not meant to be used directly.
+namespace jsDetail
+{
+    struct AllocationCounters
+    {
+        std::atomic<std::size_t> allocations{0};
+        std::atomic<std::size_t> deallocations{0};
+        std::atomic<std::size_t> bytesAllocated{0};
+        std::atomic<std::size_t> bytesDeallocated{0};
+    };
+
+    inline AllocationCounters& allocationCounters() noexcept
+    {
+        static AllocationCounters counters;
+        return counters;
+    }
+}
+
+inline JSAllocationStats JSAllocationStats::current() noexcept
+{
+    const jsDetail::AllocationCounters& counters = jsDetail::allocationCounters();
+    return {
+        counters.allocations.load(std::memory_order_relaxed),
+        counters.deallocations.load(std::memory_order_relaxed),
+        counters.bytesAllocated.load(std::memory_order_relaxed),
+        counters.bytesDeallocated.load(std::memory_order_relaxed)
+    };
+}
+
+inline void JSAllocationStats::reset() noexcept
+{
+    jsDetail::AllocationCounters& counters = jsDetail::allocationCounters();
+    counters.allocations.store(0, std::memory_order_relaxed);
+    counters.deallocations.store(0, std::memory_order_relaxed);
+    counters.bytesAllocated.store(0, std::memory_order_relaxed);
+    counters.bytesDeallocated.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief what the JSCountingAllocator arrays allocated between its construction and counted()
+ *
+ *     JSArray<int, JSCountingAllocator> values = ...;
+ *     JSAllocationScope scope;
+ *     auto doubled = values.map([](int v){return v * 2;});
+ *     assert(scope.counted().allocations == 1);
+ */
+class JSAllocationScope
+{
+private:
+    JSAllocationStats start = JSAllocationStats::current();
+
+public:
+    inline JSAllocationStats counted() const noexcept { return JSAllocationStats::current() - start; }
+};
+
+/**
+ * @brief std::allocator that counts every allocation and deallocation it makes (see JSAllocationStats), to check
+ * how many allocations a method costs: JSArray<T, JSCountingAllocator> returns JSCountingAllocator arrays
+ * from map, filter... too. The counters are shared by every element type and thread.
+ *
+ * Has a single template parameter so it can be used as JSArray's AllocTemplate.
+ *
+ * @tparam T element type
+ */
+template<typename T>
+class JSCountingAllocator
+{
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {using other = JSCountingAllocator<U>;};
+
+    JSCountingAllocator() noexcept = default;
+
+    template<typename U>
+    JSCountingAllocator(const JSCountingAllocator<U>&) noexcept {}
+
+    inline T* allocate(std::size_t n)
+    {
+        T* pointer = std::allocator<T>().allocate(n);
+        jsDetail::AllocationCounters& counters = jsDetail::allocationCounters();
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.bytesAllocated.fetch_add(n * sizeof(T), std::memory_order_relaxed);
+        return pointer;
+    }
+
+    inline void deallocate(T* pointer, std::size_t n) noexcept
+    {
+        std::allocator<T>().deallocate(pointer, n);
+        jsDetail::AllocationCounters& counters = jsDetail::allocationCounters();
+        counters.deallocations.fetch_add(1, std::memory_order_relaxed);
+        counters.bytesDeallocated.fetch_add(n * sizeof(T), std::memory_order_relaxed);
+    }
+
+    template<typename U>
+    inline bool operator==(const JSCountingAllocator<U>&) const noexcept { return true; }
+
+    template<typename U>
+    inline bool operator!=(const JSCountingAllocator<U>&) const noexcept { return false; }
+};
@@ -0,0 +1,565 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <initializer_list>
+#include <type_traits>
+#include <algorithm>
+
+#include "jsCallbackTraits.h"
+
+/**
+ * @brief A double ended queue with the same functional methods as JSArray (map, filter, reduce, ...)
+ * but where push, pop, shift and unshift are all amortized O(1). Meant for the javascript habit
+ * of using an array as a queue, where JSArray would pay an O(n) erase(begin()) on every shift().
+ *
+ * Elements live in a growable ring buffer whose capacity is always a power of two, so wrapping
+ * an index around is a single mask. Since the occupied part of the ring is at most two contiguous
+ * runs, every method iterates over (at most) two plain spans so the inner loops stay simple enough
+ * for the compiler to vectorize.
+ *
+ * @tparam T                element type of the deque
+ * @tparam AllocTemplate    allocator template class accepting only one template paramater "T" element type (ex. std::allocator)
+ *
+ * @note noexcept like JSArray: a callback that throws ends in std::terminate.
+ */
+template<typename T, template<typename> class AllocTemplate = std::allocator>
+class JSDeque
+{
+private:
+    using element_t = T;
+    using index_t = std::size_t;
+    using self_t = JSDeque<T, AllocTemplate>;
+    using allocator_t = AllocTemplate<element_t>;
+    using alloc_traits_t = std::allocator_traits<allocator_t>;
+
+    using callback_traits_t = JSCallbackTraits<element_t, self_t>;
+
+    template<typename F>
+    using StandardCallbackTraits = typename callback_traits_t::template StandardCallbackTraits<std::remove_reference_t<F>>;
+
+    template<typename F, typename Accumulator_t>
+    using ReduceCallbackTraits = typename callback_traits_t::template ReduceCallbackTraits<std::remove_reference_t<F>, Accumulator_t>;
+
+    template<typename U>
+    using makeVectorEligibleType = std::remove_reference_t<U>;
+
+    template<typename U>
+    using makeMutableType = std::remove_const_t<U>;
+
+    // a deque is allowed to access the internals of a deque of another element type (needed by map)
+    template<typename U, template<typename> class OtherAllocTemplate>
+    friend class JSDeque;
+
+    static constexpr std::size_t minimumCapacity = 8;
+
+    allocator_t allocator;
+    element_t* buffer = nullptr;
+    std::size_t bufferCapacity = 0; // always 0 or a power of two
+    std::size_t headIndex = 0;      // physical index of the logical element 0
+    std::size_t count = 0;
+
+    inline std::size_t physicalIndex(std::size_t logicalIndex) const noexcept
+    {
+        return (headIndex + logicalIndex) & (bufferCapacity - 1);
+    }
+
+    static inline std::size_t roundUpToPowerOfTwo(std::size_t n) noexcept
+    {
+        std::size_t result = minimumCapacity;
+        while (result < n)
+            result *= 2;
+
+        return result;
+    }
+
+    /**
+     * visits the occupied part of the ring as at most two contiguous spans, in logical order.
+     * visit(pointer to first element, length of span, logical index of the first element)
+     */
+    template<typename G>
+    inline void forEachSpan(G&& visit) const noexcept
+    {
+        if (count == 0)
+            return;
+
+        const std::size_t firstLength = std::min(count, bufferCapacity - headIndex);
+        visit(buffer + headIndex, firstLength, std::size_t{0});
+        if (firstLength < count)
+            visit(buffer, count - firstLength, firstLength);
+    }
+
+    // same as forEachSpan but last span first
+    template<typename G>
+    inline void forEachSpanReversed(G&& visit) const noexcept
+    {
+        if (count == 0)
+            return;
+
+        const std::size_t firstLength = std::min(count, bufferCapacity - headIndex);
+        if (firstLength < count)
+            visit(buffer, count - firstLength, firstLength);
+        visit(buffer + headIndex, firstLength, std::size_t{0});
+    }
+
+    // move every element into newBuffer (of newCapacity), with logical element 0 at physical index 0
+    inline void adoptBuffer(element_t* newBuffer, std::size_t newCapacity) noexcept
+    {
+        std::size_t written = 0;
+        forEachSpan([&](element_t* span, std::size_t length, std::size_t)
+        {
+            for (std::size_t i = 0; i < length; i += 1)
+            {
+                alloc_traits_t::construct(allocator, newBuffer + written, std::move(span[i]));
+                alloc_traits_t::destroy(allocator, span + i);
+                written += 1;
+            }
+        });
+
+        if (buffer != nullptr)
+            alloc_traits_t::deallocate(allocator, buffer, bufferCapacity);
+
+        buffer = newBuffer;
+        bufferCapacity = newCapacity;
+        headIndex = 0;
+    }
+
+    inline void reallocate(std::size_t newCapacity) noexcept
+    {
+        this->adoptBuffer(alloc_traits_t::allocate(allocator, newCapacity), newCapacity);
+    }
+
+    /**
+     * adds value to the front or the back of a full deque: value is constructed in the new buffer before the old
+     * elements are moved out, since it may be one of them (d.push(d[0])), the same as std::vector does
+     */
+    template<typename U>
+    inline void growAndAdd(U&& value, bool atFront) noexcept
+    {
+        const std::size_t newCapacity = bufferCapacity == 0 ? minimumCapacity : bufferCapacity * 2;
+        element_t* newBuffer = alloc_traits_t::allocate(allocator, newCapacity);
+        alloc_traits_t::construct(allocator, newBuffer + (atFront ? newCapacity - 1 : count), std::forward<U>(value));
+        this->adoptBuffer(newBuffer, newCapacity);
+        if (atFront)
+            headIndex = newCapacity - 1;
+        count += 1;
+    }
+
+    // sort needs one contiguous range
+    inline void linearize() noexcept
+    {
+        if (headIndex + count > bufferCapacity)
+            this->reallocate(bufferCapacity);
+    }
+
+    inline void releaseBuffer() noexcept
+    {
+        this->clear();
+        if (buffer != nullptr)
+            alloc_traits_t::deallocate(allocator, buffer, bufferCapacity);
+
+        buffer = nullptr;
+        bufferCapacity = 0;
+        headIndex = 0;
+    }
+
+public:
+    JSDeque() noexcept = default;
+
+    JSDeque(std::initializer_list<element_t> values) noexcept
+    {
+        this->reserve(values.size());
+        for (const element_t& value : values)
+            this->push(value);
+    }
+
+    JSDeque(const JSDeque& other) noexcept
+        : allocator(alloc_traits_t::select_on_container_copy_construction(other.allocator))
+    {
+        this->reserve(other.count);
+        other.forEachSpan([this](const element_t* span, std::size_t length, std::size_t)
+        {
+            for (std::size_t i = 0; i < length; i += 1)
+                this->push(span[i]);
+        });
+    }
+
+    JSDeque(JSDeque&& other) noexcept
+        : allocator(std::move(other.allocator)), buffer(other.buffer), bufferCapacity(other.bufferCapacity), headIndex(other.headIndex), count(other.count)
+    {
+        other.buffer = nullptr;
+        other.bufferCapacity = 0;
+        other.headIndex = 0;
+        other.count = 0;
+    }
+
+    JSDeque& operator=(JSDeque other) noexcept
+    {
+        std::swap(allocator, other.allocator);
+        std::swap(buffer, other.buffer);
+        std::swap(bufferCapacity, other.bufferCapacity);
+        std::swap(headIndex, other.headIndex);
+        std::swap(count, other.count);
+        return *this;
+    }
+
+    ~JSDeque() noexcept
+    {
+        this->releaseBuffer();
+    }
+
+    inline std::size_t size() const noexcept { return count; }
+    inline bool empty() const noexcept { return count == 0; }
+    inline std::size_t capacity() const noexcept { return bufferCapacity; }
+
+    inline element_t& operator[](std::size_t index) noexcept { return buffer[this->physicalIndex(index)]; }
+    inline const element_t& operator[](std::size_t index) const noexcept { return buffer[this->physicalIndex(index)]; }
+
+    inline element_t& front() noexcept { return buffer[headIndex]; }
+    inline const element_t& front() const noexcept { return buffer[headIndex]; }
+    inline element_t& back() noexcept { return buffer[this->physicalIndex(count - 1)]; }
+    inline const element_t& back() const noexcept { return buffer[this->physicalIndex(count - 1)]; }
+
+    /**
+     * @brief make sure at least n elements fit without another reallocation
+     *
+     * @param n number of elements
+     */
+    inline void reserve(std::size_t n) noexcept
+    {
+        if (n > bufferCapacity)
+            this->reallocate(roundUpToPowerOfTwo(n));
+    }
+
+    /**
+     * @brief destroy every element, the buffer is kept for reuse
+     */
+    inline void clear() noexcept
+    {
+        forEachSpan([this](element_t* span, std::size_t length, std::size_t)
+        {
+            for (std::size_t i = 0; i < length; i += 1)
+                alloc_traits_t::destroy(allocator, span + i);
+        });
+        headIndex = 0;
+        count = 0;
+    }
+
+    /**
+     * @brief adds the specified element to the end of the deque
+     *
+     * @tparam U element type, anything element_t can be constructed from
+     * @param value element to add
+     * @return std::size_t the new length of the deque
+     *
+     * @note
+     * Look here for more information: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/push
+     */
+    template<typename U = element_t>
+    inline std::size_t push(U&& value) noexcept
+    {
+        if (count == bufferCapacity)
+        {
+            this->growAndAdd(std::forward<U>(value), false);
+            return count;
+        }
+
+        alloc_traits_t::construct(allocator, buffer + this->physicalIndex(count), std::forward<U>(value));
+        count += 1;
+        return count;
+    }
+
+    /**
+     * @brief removes the last element from the deque and returns that element. The deque must not be empty.
+     *
+     * @return element_t
+     *
+     * @note
+     * Look here for more information: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/pop
+     */
+    inline element_t pop() noexcept
+    {
+        element_t* last = buffer + this->physicalIndex(count - 1);
+        element_t result = std::move(*last);
+        alloc_traits_t::destroy(allocator, last);
+        count -= 1;
+        return result;
+    }
+
+    /**
+     * @brief removes the first element from the deque and returns that element. The deque must not be empty.
+     *
+     * @return element_t
+     *
+     * @note
+     * Look here for more information: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/shift
+     */
+    inline element_t shift() noexcept
+    {
+        element_t* first = buffer + headIndex;
+        element_t result = std::move(*first);
+        alloc_traits_t::destroy(allocator, first);
+        headIndex = (headIndex + 1) & (bufferCapacity - 1);
+        count -= 1;
+        return result;
+    }
+
+    /**
+     * @brief adds the specified element to the beginning of the deque
+     *
+     * @tparam U element type, anything element_t can be constructed from
+     * @param value element to add
+     * @return std::size_t the new length of the deque
+     *
+     * @note
+     * Look here for more information: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/unshift
+     */
+    template<typename U = element_t>
+    inline std::size_t unshift(U&& value) noexcept
+    {
+        if (count == bufferCapacity)
+        {
+            this->growAndAdd(std::forward<U>(value), true);
+            return count;
+        }
+
+        headIndex = (headIndex - 1) & (bufferCapacity - 1);
+        alloc_traits_t::construct(allocator, buffer + headIndex, std::forward<U>(value));
+        count += 1;
+        return count;
+    }
+
+    /**
+     * @brief creates a new deque populated with the results of calling a provided function on every element in the calling deque
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return JSDeque<makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>, AllocTemplate>
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/map#parameters
+     */
+    template<typename F>
+    inline JSDeque<makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>, AllocTemplate> map(F&& callback) const noexcept
+    {
+        using result_element_t = makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>;
+        using result_alloc_traits_t = std::allocator_traits<AllocTemplate<result_element_t>>;
+
+        JSDeque<result_element_t, AllocTemplate> result;
+        result.reserve(count);
+        forEachSpan([&](const element_t* span, std::size_t length, std::size_t offset)
+        {
+            // result starts empty so its elements are contiguous from index 0
+            for (std::size_t i = 0; i < length; i += 1)
+                result_alloc_traits_t::construct(result.allocator, result.buffer + offset + i, callback_traits_t::standardCallbackHandler(callback, span[i], offset + i, *this));
+            result.count += length;
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief executes a user-supplied "reducer" callback function on each element of the deque, in order,
+     * passing in the return value from the calculation on the preceding element.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 2, 3, or 4 arguments (accumulator, value, index, self)
+     * @param initValue initial value for the accumulator param (0th paramater)
+     * @return Accumulator_t
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/reduce#parameters
+     */
+    template<typename Accumulator_t, typename F>
+    inline Accumulator_t reduce(F&& callback, const Accumulator_t& initValue) const noexcept
+    {
+        makeMutableType<Accumulator_t> result = initValue;
+        forEachSpan([&](const element_t* span, std::size_t length, std::size_t offset)
+        {
+            for (std::size_t i = 0; i < length; i += 1)
+                result = callback_traits_t::template reduceCallbackHandler<Accumulator_t>(callback, result, span[i], offset + i, *this);
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief applies a function against an accumulator and each value of the deque (from right-to-left) to reduce it to a single value.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 2, 3, or 4 arguments (accumulator, value, index, self)
+     * @param initValue initial value for the accumulator param (0th paramater)
+     * @return Accumulator_t
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/reduceRight#parameters
+     */
+    template<typename Accumulator_t, typename F>
+    inline Accumulator_t reduceRight(F&& callback, const Accumulator_t& initValue) const noexcept
+    {
+        makeMutableType<Accumulator_t> result = initValue;
+        forEachSpanReversed([&](const element_t* span, std::size_t length, std::size_t offset)
+        {
+            for (std::size_t i = length; i > 0; i -= 1)
+                result = callback_traits_t::template reduceCallbackHandler<Accumulator_t>(callback, result, span[i - 1], offset + i - 1, *this);
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief method executes a provided callback function once for each deque element.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/forEach#parameters
+     */
+    template<typename F>
+    inline void forEach(F&& callback)
+    {
+        forEachSpan([&](const element_t* span, std::size_t length, std::size_t offset)
+        {
+            for (std::size_t i = 0; i < length; i += 1)
+                callback_traits_t::standardCallbackHandler(callback, span[i], offset + i, *this);
+        });
+    }
+
+    /**
+     * @brief creates a new deque with just the elements from the calling deque that pass the test implemented by the provided function.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return JSDeque<T, AllocTemplate>
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/filter#parameters
+     */
+    template<typename F>
+    inline JSDeque<element_t, AllocTemplate> filter(F&& callback) const noexcept
+    {
+        static_assert(
+            std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
+            "callback return type must be bool!!!"
+        );
+
+        JSDeque<element_t, AllocTemplate> result;
+        forEachSpan([&](const element_t* span, std::size_t length, std::size_t offset)
+        {
+            for (std::size_t i = 0; i < length; i += 1)
+            {
+                if (callback_traits_t::standardCallbackHandler(callback, span[i], offset + i, *this))
+                    result.push(span[i]);
+            }
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief tests whether all elements in the deque pass the test implemented by the provided function.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return bool
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/every#parameters
+     */
+    template<typename F>
+    inline bool every(F&& callback) const noexcept
+    {
+        static_assert(
+            std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
+            "callback return type must be bool!!!"
+        );
+
+        bool result = true;
+        forEachSpan([&](const element_t* span, std::size_t length, std::size_t offset)
+        {
+            for (std::size_t i = 0; i < length && result; i += 1)
+                result = callback_traits_t::standardCallbackHandler(callback, span[i], offset + i, *this);
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief tests whether at least one element in the deque passes the test implemented by the provided function.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return bool
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/some#parameters
+     */
+    template<typename F>
+    inline bool some(F&& callback) const noexcept
+    {
+        static_assert(
+            std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
+            "callback return type must be bool!!!"
+        );
+
+        bool result = false;
+        forEachSpan([&](const element_t* span, std::size_t length, std::size_t offset)
+        {
+            for (std::size_t i = 0; i < length && !result; i += 1)
+                result = callback_traits_t::standardCallbackHandler(callback, span[i], offset + i, *this);
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief sort all the elements inplace in ascending order
+     *
+     * @return JSDeque<T, AllocTemplate>&
+     */
+    inline JSDeque<element_t, AllocTemplate>& sort() noexcept
+    {
+        return this->sort([](const element_t& a, const element_t& b){return a < b;});
+    }
+
+    /**
+     * @brief sort all the elements inplace according to the callback function
+     *
+     * @tparam F callback type
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return JSDeque<T, AllocTemplate>&
+     */
+    template<typename F>
+    inline JSDeque<element_t, AllocTemplate>& sort(F compareFunc) noexcept
+    {
+        this->linearize();
+        std::sort(buffer + headIndex, buffer + headIndex + count, compareFunc);
+        return *this;
+    }
+
+    /**
+     * @brief make a copy of the current deque and sort in ascending order.
+     *
+     * @return JSDeque<T, AllocTemplate>
+     */
+    inline JSDeque<element_t, AllocTemplate> toSorted() const noexcept
+    {
+        JSDeque<element_t, AllocTemplate> result = *this;
+        return std::move(result.sort());
+    }
+
+    /**
+     * @brief make a copy of the current deque and sort according to the callback function
+     *
+     * @tparam F callback type
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return JSDeque<T, AllocTemplate>
+     */
+    template<typename F>
+    inline JSDeque<element_t, AllocTemplate> toSorted(F compareFunc) const noexcept
+    {
+        JSDeque<element_t, AllocTemplate> result = *this;
+        return std::move(result.sort(compareFunc));
+    }
+};
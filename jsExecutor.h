@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+// the executor interface the parallel helpers run on, without the thread pool behind it (see jsThreadPool.h)
+
+/**
+ * @brief non owning reference to a body(begin, end) callable, what executors are handed to run.
+ * Cheap to copy, the callable must outlive it.
+ */
+class JSRangeFunction
+{
+private:
+    void* context;
+    void (*trampoline)(void*, std::size_t, std::size_t);
+
+public:
+    template<typename G, typename = std::enable_if_t<!std::is_same_v<std::decay_t<G>, JSRangeFunction>>>
+    JSRangeFunction(G& body) noexcept
+        : context(const_cast<void*>(static_cast<const void*>(&body)))
+        , trampoline([](void* callable, std::size_t begin, std::size_t end){(*static_cast<G*>(callable))(begin, end);})
+    {}
+
+    inline void operator()(std::size_t begin, std::size_t end) const noexcept { trampoline(context, begin, end); }
+};
+
+/**
+ * @brief where the ...Parallel methods of JSArray run their work. By default that is a JSThreadPool shared by the
+ * whole process (as soon as any translation unit includes jsThreadPool.h, which jsArrayParallel.h does; a program
+ * without it runs everything on the calling thread). Install another implementation with JSExecutor::setCurrent
+ * to route the work to your own scheduler (a TBB arena, a game engine's job system...), or a JSInlineExecutor to
+ * keep everything on the calling thread.
+ */
+class JSExecutor
+{
+public:
+    virtual ~JSExecutor() = default;
+
+    /**
+     * @brief how many threads run work at once. The parallel methods never split their work into more
+     * even tasks than this, and run sequentially when it's 1.
+     */
+    virtual std::size_t concurrency() const noexcept = 0;
+
+    /**
+     * @brief calls body(begin, end) on disjoint ranges covering [0, n), each one grain long or shorter only at the end
+     * of a split, and returns once all of them are done. Called from inside a body too (a map callback
+     * doing its own reduceParallel), which must neither deadlock nor start more threads.
+     */
+    virtual void parallelFor(std::size_t n, std::size_t grain, JSRangeFunction body) noexcept = 0;
+
+    /**
+     * @brief the executor the parallel methods use right now
+     */
+    static inline JSExecutor& current() noexcept;
+
+    /**
+     * @brief installs executor for every parallel method called afterwards, nullptr goes back to the default pool.
+     * Don't swap it while parallel methods are running, and keep it alive as long as it is installed.
+     */
+    static inline void setCurrent(JSExecutor* executor) noexcept;
+};
+
+/**
+ * @brief runs everything on the calling thread, in one body(0, n) call
+ */
+class JSInlineExecutor final : public JSExecutor
+{
+public:
+    inline std::size_t concurrency() const noexcept override { return 1; }
+
+    inline void parallelFor(std::size_t n, std::size_t grain, JSRangeFunction body) noexcept override
+    {
+        (void)grain;
+        if (n != 0)
+            body(0, n);
+    }
+};
+
+namespace jsDetail
+{
+    inline std::atomic<JSExecutor*>& installedExecutor() noexcept
+    {
+        static std::atomic<JSExecutor*> executor{nullptr};
+        return executor;
+    }
+
+    using DefaultExecutor_t = JSExecutor& (*)() noexcept;
+
+    inline JSExecutor& inlineExecutor() noexcept
+    {
+        static JSInlineExecutor executor;
+        return executor;
+    }
+
+    // what current() falls back to when nothing is installed: the calling thread, until jsThreadPool.h puts its shared pool here
+    inline std::atomic<DefaultExecutor_t>& defaultExecutor() noexcept
+    {
+        static std::atomic<DefaultExecutor_t> executor{&inlineExecutor};
+        return executor;
+    }
+}
+
+inline JSExecutor& JSExecutor::current() noexcept
+{
+    JSExecutor* executor = jsDetail::installedExecutor().load(std::memory_order_acquire);
+    return executor != nullptr ? *executor : jsDetail::defaultExecutor().load(std::memory_order_acquire)();
+}
+
+inline void JSExecutor::setCurrent(JSExecutor* executor) noexcept
+{
+    jsDetail::installedExecutor().store(executor, std::memory_order_release);
+}
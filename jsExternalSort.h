@@ -0,0 +1,312 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cerrno>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <system_error>
+
+#include <unistd.h>
+
+#include "jsSort.h"
+#include "jsParallel.h"
+#include "jsThreadPool.h"
+
+// out of core sorting kernels for MappedJSArray::toSorted and forEachSorted. Not meant to be used directly.
+namespace jsDetail
+{
+    // the merge reads every spilled run in blocks of at least this many bytes, fewer runs are merged per pass if needed
+    inline constexpr std::size_t externalSortBlockBytes = std::size_t{1} << 16;
+
+    /**
+     * @brief temporary file holding one sorted run of trivially copyable elements, unlinked as soon as it's
+     * created so it disappears with its descriptor. Write failures throw std::system_error.
+     */
+    template<typename T>
+    class SpillFile
+    {
+    private:
+        int fd = -1;
+        std::size_t count = 0;
+
+    public:
+        explicit SpillFile(const std::string& directory)
+        {
+            std::string path = directory + "/jsarray-sort-XXXXXX";
+            fd = ::mkstemp(path.data());
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "mkstemp");
+
+            ::unlink(path.c_str());
+        }
+
+        SpillFile(const SpillFile&) = delete;
+        SpillFile& operator=(const SpillFile&) = delete;
+
+        SpillFile(SpillFile&& other) noexcept : fd(other.fd), count(other.count)
+        {
+            other.fd = -1;
+            other.count = 0;
+        }
+
+        ~SpillFile() noexcept
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+
+        inline std::size_t size() const noexcept { return count; }
+
+        inline void append(const T* values, std::size_t n)
+        {
+            const char* bytes = reinterpret_cast<const char*>(values);
+            std::size_t remaining = n * sizeof(T);
+            while (remaining != 0)
+            {
+                const ::ssize_t written = ::write(fd, bytes, remaining);
+                if (written < 0 && errno == EINTR)
+                    continue;
+                if (written <= 0)
+                    throw std::system_error(errno, std::generic_category(), "write");
+
+                bytes += written;
+                remaining -= static_cast<std::size_t>(written);
+            }
+
+            count += n;
+        }
+
+        // reads up to n elements starting at element offset, returns how many were read
+        inline std::size_t read(std::size_t offset, T* out, std::size_t n) const
+        {
+            n = std::min(n, count - std::min(offset, count));
+            char* bytes = reinterpret_cast<char*>(out);
+            std::size_t done = 0;
+            while (done < n * sizeof(T))
+            {
+                const ::ssize_t got = ::pread(fd, bytes + done, n * sizeof(T) - done, static_cast<off_t>(offset * sizeof(T) + done));
+                if (got < 0 && errno == EINTR)
+                    continue;
+                if (got <= 0)
+                    throw std::system_error(errno, std::generic_category(), "pread");
+
+                done += static_cast<std::size_t>(got);
+            }
+
+            return n;
+        }
+    };
+
+    /**
+     * @brief output iterator collecting what a merge writes into a fixed block and handing every
+     * full block to emit(const T* values, std::size_t n). Call flush() after the last write.
+     */
+    template<typename T, typename Emit>
+    class BlockSink
+    {
+    private:
+        std::vector<T> block;
+        std::size_t used = 0;
+        Emit& emit;
+
+    public:
+        BlockSink(std::size_t blockElements, Emit& emitBlock) : block(std::max<std::size_t>(blockElements, 1)), emit(emitBlock) {}
+
+        inline void push(const T& value)
+        {
+            block[used] = value;
+            used += 1;
+            if (used == block.size())
+                this->flush();
+        }
+
+        inline void flush()
+        {
+            if (used != 0)
+                emit(static_cast<const T*>(block.data()), used);
+            used = 0;
+        }
+
+        class Iterator
+        {
+        private:
+            BlockSink* sink;
+
+        public:
+            using iterator_category = std::output_iterator_tag;
+            using value_type = void;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = void;
+
+            explicit Iterator(BlockSink& target) noexcept : sink(&target) {}
+
+            inline Iterator& operator=(const T& value) { sink->push(value); return *this; }
+            inline Iterator& operator*() noexcept { return *this; }
+            inline Iterator& operator++() noexcept { return *this; }
+            inline Iterator operator++(int) noexcept { return *this; }
+        };
+
+        inline Iterator iterator() noexcept { return Iterator(*this); }
+    };
+
+    /**
+     * @brief sorts values inplace, one slice per hardware thread, and emits the slices merged
+     */
+    template<typename T, typename Compare, typename Emit>
+    inline void sortRunInto(T* values, std::size_t n, const Compare& compareFunc, std::size_t sinkElements, Emit& emit)
+    {
+        const std::size_t taskCount = parallelTaskCount(n, parallelGrain);
+        std::vector<MergeRun<T>> slices(taskCount);
+        parallelFor(taskCount, [&](std::size_t t)
+        {
+            const auto [begin, end] = taskRange(n, taskCount, t);
+            std::sort(values + begin, values + end, compareFunc);
+            slices[t] = {values + begin, values + end};
+        });
+
+        BlockSink<T, Emit> sink(sinkElements, emit);
+        multiwayMerge(slices, compareFunc, sink.iterator());
+        sink.flush();
+    }
+
+    /**
+     * @brief k way merge of sorted spill files, reading each in blocks of blockElements. Every round, of the runs
+     * that still have data on disk the one whose buffered block ends lowest (j) bounds what is safe to output:
+     * everything up to its last element, minus the elements equal to it in the runs after j, which could
+     * still be preceded by equal elements of run j that aren't read yet. Those prefixes are merged with
+     * multiwayMerge and the buffers topped up.
+     */
+    template<typename T, typename Compare, typename Emit>
+    inline void mergeSpills(const std::vector<const SpillFile<T>*>& files, std::size_t blockElements, const Compare& compareFunc, Emit& emit)
+    {
+        struct Stream
+        {
+            std::vector<T> buffer;
+            std::size_t length = 0;     // buffered elements
+            std::size_t fileOffset = 0; // next element to read from the file
+        };
+
+        const std::size_t runCount = files.size();
+        std::vector<Stream> streams(runCount);
+        for (Stream& stream : streams)
+            stream.buffer.resize(blockElements);
+
+        BlockSink<T, Emit> sink(blockElements, emit);
+        std::vector<MergeRun<T>> prefixes(runCount);
+        while (true)
+        {
+            bool anyBuffered = false;
+            std::size_t bounding = runCount;
+            for (std::size_t r = 0; r < runCount; r += 1)
+            {
+                Stream& stream = streams[r];
+                const std::size_t got = files[r]->read(stream.fileOffset, stream.buffer.data() + stream.length, blockElements - stream.length);
+                stream.fileOffset += got;
+                stream.length += got;
+                anyBuffered = anyBuffered || stream.length != 0;
+
+                const bool moreOnDisk = stream.fileOffset < files[r]->size();
+                if (moreOnDisk && (bounding == runCount || compareFunc(stream.buffer[stream.length - 1], streams[bounding].buffer[streams[bounding].length - 1])))
+                    bounding = r;
+            }
+
+            if (!anyBuffered)
+                break;
+
+            for (std::size_t r = 0; r < runCount; r += 1)
+            {
+                const T* first = streams[r].buffer.data();
+                const T* last = first + streams[r].length;
+                if (bounding != runCount && r != bounding)
+                {
+                    const T& bound = streams[bounding].buffer[streams[bounding].length - 1];
+                    last = r < bounding ? std::upper_bound(first, last, bound, compareFunc) : std::lower_bound(first, last, bound, compareFunc);
+                }
+
+                prefixes[r] = {first, last};
+            }
+
+            std::vector<MergeRun<T>> consumed = prefixes;
+            multiwayMerge(consumed, compareFunc, sink.iterator());
+
+            // keep what wasn't output at the front of every buffer
+            for (std::size_t r = 0; r < runCount; r += 1)
+            {
+                Stream& stream = streams[r];
+                const std::size_t used = static_cast<std::size_t>(prefixes[r].end - prefixes[r].begin);
+                std::move(stream.buffer.begin() + used, stream.buffer.begin() + stream.length, stream.buffer.begin());
+                stream.length -= used;
+            }
+        }
+
+        sink.flush();
+    }
+
+    /**
+     * @brief sorts n values that don't fit in memory: runs of about memoryBudget bytes are sorted in memory
+     * (in parallel) and spilled to temporary files in directory, then merged back, in several passes if
+     * the budget can't hold a block of every run at once. The sorted values are handed to
+     * emit(const T* values, std::size_t n) in order, block by block.
+     */
+    template<typename T, typename Compare, typename Emit>
+    inline void externalSort(const T* values, std::size_t n, const Compare& compareFunc, std::size_t memoryBudget, const std::string& directory, Emit&& emit)
+    {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>, "externalSort needs trivially copyable, default constructible elements");
+
+        const std::size_t blockElements = std::max<std::size_t>(1, externalSortBlockBytes / sizeof(T));
+        const std::size_t budgetElements = std::max(memoryBudget / sizeof(T), blockElements * 3);
+        const std::size_t runElements = budgetElements - blockElements;
+
+        std::vector<SpillFile<T>> spills;
+        {
+            std::vector<T> run(std::min(n, runElements));
+            if (n <= runElements)
+            {
+                std::copy(values, values + n, run.data());
+                sortRunInto(run.data(), n, compareFunc, blockElements, emit);
+                return;
+            }
+
+            for (std::size_t begin = 0; begin < n; begin += runElements)
+            {
+                const std::size_t length = std::min(runElements, n - begin);
+                std::copy(values + begin, values + begin + length, run.data());
+                SpillFile<T>& spill = spills.emplace_back(directory);
+                auto append = [&spill](const T* sorted, std::size_t count){spill.append(sorted, count);};
+                sortRunInto(run.data(), length, compareFunc, blockElements, append);
+            }
+        }
+
+        // one block per run plus one for the output must fit in the budget
+        const std::size_t fanIn = std::max<std::size_t>(2, budgetElements / blockElements - 1);
+        while (spills.size() > fanIn)
+        {
+            std::vector<SpillFile<T>> merged;
+            for (std::size_t begin = 0; begin < spills.size(); begin += fanIn)
+            {
+                std::vector<const SpillFile<T>*> group;
+                for (std::size_t r = begin; r < std::min(spills.size(), begin + fanIn); r += 1)
+                    group.push_back(&spills[r]);
+
+                SpillFile<T>& output = merged.emplace_back(directory);
+                auto append = [&output](const T* sorted, std::size_t count){output.append(sorted, count);};
+                mergeSpills(group, budgetElements / (group.size() + 1), compareFunc, append);
+            }
+
+            spills = std::move(merged);
+        }
+
+        std::vector<const SpillFile<T>*> files;
+        for (const SpillFile<T>& spill : spills)
+            files.push_back(&spill);
+
+        mergeSpills(files, budgetElements / (files.size() + 1), compareFunc, emit);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <cstddef>
+
+template<typename T, template<typename> class AllocTemplate>
+class JSArray;
+
+/**
+ * @brief result of JSArray::groupBy. Instead of a map of arrays, all groups share one contiguous
+ * values buffer (CSR layout): group g is values[offsets[g], offsets[g + 1]).
+ * Groups are in order of the first appearance of their key, and elements keep their original
+ * order inside a group, like javascript's Object.groupBy.
+ *
+ * @tparam Key              key type returned by the groupBy callback
+ * @tparam T                element type of the grouped array
+ * @tparam AllocTemplate    allocator template of the grouped array
+ */
+template<typename Key, typename T, template<typename> class AllocTemplate = std::allocator>
+struct JSGroupBy
+{
+    JSArray<Key, AllocTemplate> keys;               // key of every group
+    JSArray<std::size_t, AllocTemplate> offsets;    // size() + 1 entries, group g starts at offsets[g] and ends at offsets[g + 1]
+    JSArray<T, AllocTemplate> values;               // every element, grouped
+
+    /**
+     * @brief number of groups
+     */
+    inline std::size_t size() const noexcept { return keys.size(); }
+
+    inline std::size_t groupSize(std::size_t g) const noexcept { return offsets[g + 1] - offsets[g]; }
+
+    // [groupBegin(g), groupEnd(g)) are the elements of group g, no copy involved
+    inline const T* groupBegin(std::size_t g) const noexcept { return values.data() + offsets[g]; }
+    inline const T* groupEnd(std::size_t g) const noexcept { return values.data() + offsets[g + 1]; }
+
+    /**
+     * @brief copy of the elements of group g
+     */
+    inline JSArray<T, AllocTemplate> group(std::size_t g) const noexcept
+    {
+        return JSArray<T, AllocTemplate>(this->groupBegin(g), this->groupEnd(g));
+    }
+};
+
+/**
+ * @brief result of JSArray::countBy, the distinct keys in order of first appearance and how many elements had each one.
+ *
+ * @tparam Key              key type returned by the countBy callback
+ * @tparam AllocTemplate    allocator template of the counted array
+ */
+template<typename Key, template<typename> class AllocTemplate = std::allocator>
+struct JSCountBy
+{
+    JSArray<Key, AllocTemplate> keys;
+    JSArray<std::size_t, AllocTemplate> counts; // counts[g] is the number of elements with key keys[g]
+
+    /**
+     * @brief number of distinct keys
+     */
+    inline std::size_t size() const noexcept { return keys.size(); }
+};
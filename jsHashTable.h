@@ -0,0 +1,418 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+
+#include "jsParallel.h"
+
+// hashing helpers for groupBy, countBy, ... Not meant to be used directly.
+namespace jsDetail
+{
+    /**
+     * @brief scrambles a hash so every bit depends on every input bit (murmur3 finalizer).
+     * std::hash of integers is usually the identity, which piles up consecutive keys in
+     * neighbouring slots of a power of two table.
+     */
+    inline std::uint64_t mixHash(std::uint64_t h) noexcept
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /**
+     * @brief equality used for deduplication, javascript's SameValueZero: == except that NaN equals NaN
+     */
+    template<typename T>
+    struct SameValueZeroEqual
+    {
+        inline bool operator()(const T& a, const T& b) const noexcept
+        {
+            if constexpr (std::is_floating_point_v<T>)
+                return a == b || (a != a && b != b);
+            else
+                return a == b;
+        }
+    };
+
+    /**
+     * @brief hash consistent with SameValueZeroEqual (every NaN hashes the same, so do +0 and -0)
+     */
+    template<typename T>
+    struct SameValueZeroHash
+    {
+        inline std::size_t operator()(const T& value) const noexcept
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                if (value != value)
+                    return 0x7ff8000000000000ull;
+                if (value == 0)
+                    return 0;
+            }
+
+            return std::hash<T>{}(value);
+        }
+    };
+
+    /**
+     * @brief strict weak order consistent with SameValueZeroEqual, NaNs go last
+     */
+    template<typename T>
+    struct SameValueZeroLess
+    {
+        inline bool operator()(const T& a, const T& b) const noexcept
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                if (b != b)
+                    return a == a;
+                if (a != a)
+                    return false;
+            }
+
+            if constexpr (std::is_pointer_v<T>)
+                return std::less<T>{}(a, b);
+            else
+                return a < b;
+        }
+    };
+
+    /**
+     * @brief open addressing (linear probing) hash table that gives every distinct key a dense id,
+     * in the order the keys were first inserted (0, 1, 2, ...). The keys themselves are kept in one
+     * contiguous array indexed by id, so callers keep their per key data (counts, offsets, ...)
+     * in plain arrays indexed by id instead of in the table.
+     *
+     * @tparam Key      key type
+     * @tparam Hash     hash functor
+     * @tparam Equal    equality functor
+     * @tparam AllocTemplate allocator of the slots and of the keys, so a JSArray can keep its scratch tables in its own allocator
+     */
+    template<typename Key, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>, template<typename> class AllocTemplate = std::allocator>
+    class KeyIndex
+    {
+    private:
+        struct Slot
+        {
+            std::size_t idPlusOne = 0; // 0 means empty
+            std::uint64_t hash = 0;
+        };
+
+        using slots_t = std::vector<Slot, AllocTemplate<Slot>>;
+        using keys_t = std::vector<Key, AllocTemplate<Key>>;
+
+        slots_t slots;
+        keys_t denseKeys;
+        Hash hasher;
+        Equal equal;
+
+        inline std::size_t slotMask() const noexcept { return slots.size() - 1; }
+
+        // keep the table at most half full
+        inline void growIfNeeded() noexcept
+        {
+            if ((denseKeys.size() + 1) * 2 <= slots.size())
+                return;
+
+            slots_t oldSlots(std::max<std::size_t>(16, slots.size() * 2));
+            oldSlots.swap(slots);
+            for (const Slot& slot : oldSlots)
+            {
+                if (slot.idPlusOne == 0)
+                    continue;
+
+                std::size_t position = slot.hash & this->slotMask();
+                while (slots[position].idPlusOne != 0)
+                    position = (position + 1) & this->slotMask();
+                slots[position] = slot;
+            }
+        }
+
+    public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        explicit KeyIndex(std::size_t expectedKeys = 0, Hash keyHasher = Hash{}, Equal keyEqual = Equal{}) noexcept
+            : hasher(std::move(keyHasher)), equal(std::move(keyEqual))
+        {
+            std::size_t capacity = 16;
+            while (capacity < expectedKeys * 2)
+                capacity *= 2;
+
+            slots.resize(capacity);
+            denseKeys.reserve(expectedKeys);
+        }
+
+        inline std::uint64_t hashOf(const Key& key) const noexcept
+        {
+            return mixHash(static_cast<std::uint64_t>(hasher(key)));
+        }
+
+        // same as hashOf for callers that don't have a table at hand (Hash must be default constructible)
+        static inline std::uint64_t hashKey(const Key& key) noexcept
+        {
+            return mixHash(static_cast<std::uint64_t>(Hash{}(key)));
+        }
+
+        /**
+         * @brief id of key, inserting it with the next free id if it isn't there yet
+         *
+         * @param hash must be hashOf(key), lets callers that already hashed the key skip doing it again
+         * @return std::pair<std::size_t, bool> (id, true if the key was just inserted)
+         */
+        template<typename K>
+        inline std::pair<std::size_t, bool> insertHashed(std::uint64_t hash, K&& key) noexcept
+        {
+            this->growIfNeeded();
+
+            std::size_t position = hash & this->slotMask();
+            while (slots[position].idPlusOne != 0)
+            {
+                const Slot& slot = slots[position];
+                if (slot.hash == hash && equal(denseKeys[slot.idPlusOne - 1], key))
+                    return {slot.idPlusOne - 1, false};
+
+                position = (position + 1) & this->slotMask();
+            }
+
+            denseKeys.emplace_back(std::forward<K>(key));
+            slots[position] = Slot{denseKeys.size(), hash};
+            return {denseKeys.size() - 1, true};
+        }
+
+        template<typename K>
+        inline std::pair<std::size_t, bool> insert(K&& key) noexcept
+        {
+            const std::uint64_t hash = this->hashOf(key);
+            return this->insertHashed(hash, std::forward<K>(key));
+        }
+
+        /**
+         * @brief id of key, or npos if it was never inserted
+         */
+        inline std::size_t find(const Key& key) const noexcept
+        {
+            const std::uint64_t hash = this->hashOf(key);
+            std::size_t position = hash & this->slotMask();
+            while (slots[position].idPlusOne != 0)
+            {
+                const Slot& slot = slots[position];
+                if (slot.hash == hash && equal(denseKeys[slot.idPlusOne - 1], key))
+                    return slot.idPlusOne - 1;
+
+                position = (position + 1) & this->slotMask();
+            }
+
+            return npos;
+        }
+
+        /**
+         * @brief id of the key for which matches(key) is true, or npos. Lets callers look up something that
+         * isn't a Key (ex. a value, when the keys are indices of values) as long as they know its hash.
+         */
+        template<typename Matches>
+        inline std::size_t findHashed(std::uint64_t hash, Matches&& matches) const noexcept
+        {
+            std::size_t position = hash & this->slotMask();
+            while (slots[position].idPlusOne != 0)
+            {
+                const Slot& slot = slots[position];
+                if (slot.hash == hash && matches(denseKeys[slot.idPlusOne - 1]))
+                    return slot.idPlusOne - 1;
+
+                position = (position + 1) & this->slotMask();
+            }
+
+            return npos;
+        }
+
+        inline std::size_t size() const noexcept { return denseKeys.size(); }
+
+        // key of every id, indexed by id
+        inline const keys_t& keys() const noexcept { return denseKeys; }
+        inline keys_t& keys() noexcept { return denseKeys; }
+    };
+
+    /**
+     * @brief element indices split into partitions by the high bits of their hash (equal keys always share a partition)
+     */
+    struct HashPartitions
+    {
+        std::vector<std::size_t> bucketOffsets;  // partition p owns bucketIndices[bucketOffsets[p], bucketOffsets[p + 1])
+        std::vector<std::size_t> bucketIndices;  // element indices by partition, ascending inside every partition
+        std::size_t partitionCount = 0;
+    };
+
+    /**
+     * @brief radix partitions the elements by hash with taskCount threads (histogram pass, then scatter pass).
+     * The low bits of the hashes are left alone for the hash table used inside every partition.
+     *
+     * @tparam Hashes_t vector of std::uint64_t (any allocator)
+     * @param hashes hash of every element
+     * @param taskCount number of threads, also the number of partitions
+     */
+    template<typename Hashes_t>
+    inline HashPartitions partitionByHash(const Hashes_t& hashes, std::size_t taskCount) noexcept
+    {
+        const std::size_t n = hashes.size();
+        const std::size_t partitions = taskCount;
+        auto partitionOf = [partitions](std::uint64_t hash){return static_cast<std::size_t>(((hash >> 32) * partitions) >> 32);};
+
+        std::vector<std::size_t> histogram(taskCount * partitions, 0); // [task][partition]
+        parallelFor(taskCount, [&](std::size_t t)
+        {
+            const auto [begin, end] = taskRange(n, taskCount, t);
+            for (std::size_t i = begin; i < end; i += 1)
+                histogram[t * partitions + partitionOf(hashes[i])] += 1;
+        });
+
+        HashPartitions result;
+        result.partitionCount = partitions;
+        result.bucketOffsets.assign(partitions + 1, 0);
+        std::vector<std::size_t> cursors(taskCount * partitions);
+        std::size_t running = 0;
+        for (std::size_t p = 0; p < partitions; p += 1)
+        {
+            result.bucketOffsets[p] = running;
+            for (std::size_t t = 0; t < taskCount; t += 1)
+            {
+                cursors[t * partitions + p] = running;
+                running += histogram[t * partitions + p];
+            }
+        }
+        result.bucketOffsets[partitions] = running;
+
+        // tasks scatter in order so every partition stays ascending
+        result.bucketIndices.resize(n);
+        parallelFor(taskCount, [&](std::size_t t)
+        {
+            const auto [begin, end] = taskRange(n, taskCount, t);
+            for (std::size_t i = begin; i < end; i += 1)
+                result.bucketIndices[cursors[t * partitions + partitionOf(hashes[i])]++] = i;
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief result of groupInParallel. Group ids are dense and in order of first appearance,
+     * exactly as a serial KeyIndex pass would have numbered them.
+     */
+    template<typename Key>
+    struct ParallelGroups : HashPartitions
+    {
+        std::vector<Key> keys;                   // key of every group, indexed by group id
+        std::vector<std::size_t> counts;         // number of elements of every group, indexed by group id
+        std::vector<std::size_t> groupOf;        // group id of every element, indexed by element
+    };
+
+    /**
+     * @brief groups n elements by key using taskCount threads. Keys are computed in parallel, the elements are
+     * partitioned by the high bits of their key hash (so equal keys always land in the same partition),
+     * then every partition is grouped on its own thread with its own KeyIndex. No locks, no shared table.
+     *
+     * @param n number of elements
+     * @param taskCount number of threads / partitions
+     * @param keyOf keyOf(i) returns the key of element i, must be safe to call from several threads at once
+     */
+    template<typename Key, typename KeyOf>
+    inline ParallelGroups<Key> groupInParallel(std::size_t n, std::size_t taskCount, KeyOf&& keyOf) noexcept
+    {
+        // std::vector<bool> packs bits, so threads writing neighbouring keys would race. Store bools as bytes.
+        using stored_key_t = std::conditional_t<std::is_same_v<Key, bool>, unsigned char, Key>;
+
+        // 1. keys and hashes
+        std::vector<stored_key_t> keys(n);
+        std::vector<std::uint64_t> hashes(n);
+        parallelFor(taskCount, [&](std::size_t t)
+        {
+            const auto [begin, end] = taskRange(n, taskCount, t);
+            for (std::size_t i = begin; i < end; i += 1)
+            {
+                keys[i] = keyOf(i);
+                hashes[i] = KeyIndex<stored_key_t>::hashKey(keys[i]);
+            }
+        });
+
+        // 2. partition element indices by hash
+        ParallelGroups<Key> result;
+        static_cast<HashPartitions&>(result) = partitionByHash(hashes, taskCount);
+        const std::size_t partitions = result.partitionCount;
+
+        // 3. group every partition on its own
+        struct LocalGroups
+        {
+            std::vector<stored_key_t> keys;
+            std::vector<std::size_t> counts;
+            std::vector<std::size_t> firstIndex;
+            std::vector<std::size_t> localIds; // per position in the bucket
+        };
+        std::vector<LocalGroups> locals(partitions);
+        parallelFor(partitions, [&](std::size_t p)
+        {
+            const std::size_t begin = result.bucketOffsets[p];
+            const std::size_t end = result.bucketOffsets[p + 1];
+            LocalGroups& local = locals[p];
+            local.localIds.resize(end - begin);
+
+            KeyIndex<stored_key_t> index;
+            for (std::size_t position = begin; position < end; position += 1)
+            {
+                const std::size_t i = result.bucketIndices[position];
+                const auto [id, inserted] = index.insertHashed(hashes[i], std::move(keys[i]));
+                if (inserted)
+                {
+                    local.counts.push_back(0);
+                    local.firstIndex.push_back(i);
+                }
+
+                local.counts[id] += 1;
+                local.localIds[position - begin] = id;
+            }
+
+            local.keys = std::move(index.keys());
+        });
+
+        // 4. number groups globally by first appearance
+        struct GroupRef {std::size_t firstIndex; std::size_t partition; std::size_t localId;};
+        std::vector<GroupRef> order;
+        for (std::size_t p = 0; p < partitions; p += 1)
+        {
+            for (std::size_t id = 0; id < locals[p].keys.size(); id += 1)
+                order.push_back(GroupRef{locals[p].firstIndex[id], p, id});
+        }
+        std::sort(order.begin(), order.end(), [](const GroupRef& a, const GroupRef& b){return a.firstIndex < b.firstIndex;});
+
+        std::vector<std::vector<std::size_t>> globalIds(partitions);
+        for (std::size_t p = 0; p < partitions; p += 1)
+            globalIds[p].resize(locals[p].keys.size());
+
+        result.keys.reserve(order.size());
+        result.counts.reserve(order.size());
+        for (std::size_t g = 0; g < order.size(); g += 1)
+        {
+            LocalGroups& local = locals[order[g].partition];
+            globalIds[order[g].partition][order[g].localId] = g;
+            result.keys.push_back(static_cast<Key>(std::move(local.keys[order[g].localId])));
+            result.counts.push_back(local.counts[order[g].localId]);
+        }
+
+        result.groupOf.resize(n);
+        parallelFor(partitions, [&](std::size_t p)
+        {
+            const std::size_t begin = result.bucketOffsets[p];
+            for (std::size_t position = begin; position < result.bucketOffsets[p + 1]; position += 1)
+                result.groupOf[result.bucketIndices[position]] = globalIds[p][locals[p].localIds[position - begin]];
+        });
+
+        return result;
+    }
+}
@@ -0,0 +1,346 @@
+#pragma once
+
+/*
+ * Opt in per method instrumentation: compile with -DJSARRAY_INSTRUMENTATION and every instrumented JSArray
+ * method (map, filter, reduce, sort and friends, their ...Parallel versions...) records, per method and
+ * call site tag:
+ *   - calls
+ *   - elements (size of the array it was called on)
+ *   - wall time in nanoseconds
+ *   - bytes allocated: the storage of the array it returns plus every time an array grew while it ran
+ *   - reallocations: how many times an array outgrew its capacity while it ran (push_back growth...)
+ * A method called while another instrumented method runs on the same thread (sortParallel falling back to
+ * sort, a callback doing its own filter) is counted as part of the outer call. Work the parallel methods
+ * run on pool threads is timed but its allocations aren't attributed.
+ * Read the numbers with JSInstrumentation::toJSON() or toPrometheus(). Without the macro everything here
+ * compiles to nothing, JSCallSiteTag included.
+ */
+
+#include <string>
+#include <cstddef>
+#include <utility>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__has_include)
+#if __has_include(<source_location>) && __cplusplus >= 202002L
+#include <source_location>
+#if defined(__cpp_lib_source_location)
+#define JSARRAY_HAS_SOURCE_LOCATION 1
+#endif
+#endif
+#endif
+
+#if defined(JSARRAY_INSTRUMENTATION)
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * @brief what the registry knows about one method at one call site
+ */
+struct JSMethodStats
+{
+    std::string method;
+    std::string site;               // JSCallSiteTag active when the method was called, empty without one
+    std::uint64_t calls = 0;
+    std::uint64_t elements = 0;
+    std::uint64_t nanos = 0;
+    std::uint64_t bytesAllocated = 0;
+    std::uint64_t reallocations = 0;
+};
+
+/**
+ * @brief process wide registry of JSMethodStats
+ */
+class JSInstrumentation
+{
+private:
+    std::mutex mutex;
+    std::map<std::pair<std::string, std::string>, JSMethodStats> stats;
+
+    static inline void appendEscaped(std::string& out, std::string_view text)
+    {
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (c == '\n')
+                out += "\\n";
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(c)));
+                out += escaped;
+            }
+            else
+                out += c;
+        }
+    }
+
+public:
+    static inline JSInstrumentation& registry() noexcept
+    {
+        static JSInstrumentation instance;
+        return instance;
+    }
+
+    inline void record(const char* method, const std::string& site, std::uint64_t elements, std::uint64_t nanos, std::uint64_t bytesAllocated, std::uint64_t reallocations)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto [entry, inserted] = stats.try_emplace({method, site});
+        JSMethodStats& methodStats = entry->second;
+        if (inserted)
+        {
+            methodStats.method = method;
+            methodStats.site = site;
+        }
+
+        methodStats.calls += 1;
+        methodStats.elements += elements;
+        methodStats.nanos += nanos;
+        methodStats.bytesAllocated += bytesAllocated;
+        methodStats.reallocations += reallocations;
+    }
+
+    /**
+     * @brief copy of every entry, ordered by method then site
+     */
+    inline std::vector<JSMethodStats> snapshot()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<JSMethodStats> result;
+        result.reserve(stats.size());
+        for (const auto& entry : stats)
+            result.push_back(entry.second);
+
+        return result;
+    }
+
+    inline void reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.clear();
+    }
+
+    /**
+     * @brief {"methods":[{"method":"map","site":"","calls":1,"elements":3,"nanos":120,"bytesAllocated":24,"reallocations":0},...]}
+     */
+    inline std::string toJSON()
+    {
+        std::string out = "{\"methods\":[";
+        bool first = true;
+        for (const JSMethodStats& entry : this->snapshot())
+        {
+            out += first ? "{" : ",{";
+            first = false;
+            out += "\"method\":\"";
+            appendEscaped(out, entry.method);
+            out += "\",\"site\":\"";
+            appendEscaped(out, entry.site);
+            out += "\",\"calls\":" + std::to_string(entry.calls);
+            out += ",\"elements\":" + std::to_string(entry.elements);
+            out += ",\"nanos\":" + std::to_string(entry.nanos);
+            out += ",\"bytesAllocated\":" + std::to_string(entry.bytesAllocated);
+            out += ",\"reallocations\":" + std::to_string(entry.reallocations);
+            out += "}";
+        }
+
+        out += "]}";
+        return out;
+    }
+
+    /**
+     * @brief Prometheus text exposition format, one counter family per statistic labelled by method and site
+     */
+    inline std::string toPrometheus()
+    {
+        const std::vector<JSMethodStats> entries = this->snapshot();
+        const std::pair<const char*, std::uint64_t JSMethodStats::*> families[] = {
+            {"jsarray_calls_total", &JSMethodStats::calls},
+            {"jsarray_elements_total", &JSMethodStats::elements},
+            {"jsarray_nanoseconds_total", &JSMethodStats::nanos},
+            {"jsarray_allocated_bytes_total", &JSMethodStats::bytesAllocated},
+            {"jsarray_reallocations_total", &JSMethodStats::reallocations},
+        };
+
+        std::string out;
+        for (const auto& [name, member] : families)
+        {
+            out += "# TYPE ";
+            out += name;
+            out += " counter\n";
+            for (const JSMethodStats& entry : entries)
+            {
+                out += name;
+                out += "{method=\"";
+                appendEscaped(out, entry.method);
+                out += "\",site=\"";
+                appendEscaped(out, entry.site);
+                out += "\"} " + std::to_string(entry.*member) + "\n";
+            }
+        }
+
+        return out;
+    }
+};
+
+namespace jsDetail
+{
+    inline thread_local std::string currentCallSite;
+
+    /**
+     * @brief times one instrumented method call and collects what it allocates, see JSARRAY_INSTRUMENT
+     */
+    class MethodScope
+    {
+    private:
+        inline static thread_local MethodScope* active = nullptr;
+
+        const char* method;
+        std::size_t elements;
+        std::chrono::steady_clock::time_point start;
+        std::uint64_t bytesAllocated = 0;
+        std::uint64_t reallocations = 0;
+        bool outermost;
+
+    public:
+        MethodScope(const char* methodName, std::size_t elementCount) noexcept
+            : method(methodName), elements(elementCount), outermost(active == nullptr)
+        {
+            if (outermost)
+            {
+                active = this;
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        MethodScope(const MethodScope&) = delete;
+        MethodScope& operator=(const MethodScope&) = delete;
+
+        ~MethodScope() noexcept
+        {
+            if (!outermost)
+                return;
+
+            active = nullptr;
+            const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            try
+            {
+                JSInstrumentation::registry().record(method, currentCallSite, elements, static_cast<std::uint64_t>(nanos), bytesAllocated, reallocations);
+            }
+            catch (...)
+            {
+                // statistics are best effort
+            }
+        }
+
+        // a result array allocated up front, counted by the outermost scope
+        inline void allocated(std::size_t bytes) noexcept
+        {
+            if (active != nullptr)
+                active->bytesAllocated += bytes;
+        }
+
+        // an array's storage went from oldBytes to newBytes on this thread
+        static inline void noteGrowth(std::size_t oldBytes, std::size_t newBytes) noexcept
+        {
+            if (active == nullptr || newBytes <= oldBytes)
+                return;
+
+            active->bytesAllocated += newBytes;
+            if (oldBytes != 0)
+                active->reallocations += 1;
+        }
+    };
+
+    template<typename Vector_t>
+    inline std::size_t storageBytes(const Vector_t& values) noexcept
+    {
+        if constexpr (std::is_same_v<typename Vector_t::value_type, bool>)
+            return (values.capacity() + 7) / 8;
+        else
+            return values.capacity() * sizeof(typename Vector_t::value_type);
+    }
+
+    // reports to the active MethodScope if the vector's storage grew during its lifetime
+    template<typename Vector_t>
+    class GrowthGuard
+    {
+    private:
+        const Vector_t& values;
+        std::size_t bytesBefore;
+
+    public:
+        explicit GrowthGuard(const Vector_t& watched) noexcept : values(watched), bytesBefore(storageBytes(watched)) {}
+
+        GrowthGuard(const GrowthGuard&) = delete;
+        GrowthGuard& operator=(const GrowthGuard&) = delete;
+
+        ~GrowthGuard() noexcept
+        {
+            MethodScope::noteGrowth(bytesBefore, storageBytes(values));
+        }
+    };
+}
+
+/**
+ * @brief tags the instrumented calls made on this thread while it's alive, so the registry keeps them apart
+ * from the same methods called elsewhere. Tags nest, the innermost wins.
+ *
+ *     JSCallSiteTag tag;                    // "file.cpp:42" (C++20, std::source_location)
+ *     JSCallSiteTag tag("ingest pipeline"); // any name
+ */
+class JSCallSiteTag
+{
+private:
+    std::string previous;
+
+public:
+#if defined(JSARRAY_HAS_SOURCE_LOCATION)
+    explicit JSCallSiteTag(std::source_location location = std::source_location::current())
+        : JSCallSiteTag(std::string(location.file_name()) + ":" + std::to_string(location.line()))
+    {}
+#endif
+
+    explicit JSCallSiteTag(std::string name) : previous(std::exchange(jsDetail::currentCallSite, std::move(name))) {}
+
+    JSCallSiteTag(const JSCallSiteTag&) = delete;
+    JSCallSiteTag& operator=(const JSCallSiteTag&) = delete;
+
+    ~JSCallSiteTag() noexcept
+    {
+        jsDetail::currentCallSite = std::move(previous);
+    }
+};
+
+// first statement of an instrumented method
+#define JSARRAY_INSTRUMENT(method) jsDetail::MethodScope jsArrayMethodScope(method, this->size())
+// before returning a result array that was allocated in one go (growth is recorded by the array itself)
+#define JSARRAY_INSTRUMENT_RESULT(result) jsArrayMethodScope.allocated(jsDetail::storageBytes(result))
+// first statement of a JSArray member that may grow the array
+#define JSARRAY_INSTRUMENT_GROWTH() const jsDetail::GrowthGuard<base_t> jsArrayGrowthGuard(*this)
+
+#else
+
+class JSCallSiteTag
+{
+public:
+#if defined(JSARRAY_HAS_SOURCE_LOCATION)
+    explicit JSCallSiteTag(std::source_location = std::source_location::current()) noexcept {}
+#endif
+    explicit JSCallSiteTag(std::string_view) noexcept {}
+};
+
+#define JSARRAY_INSTRUMENT(method) ((void)0)
+#define JSARRAY_INSTRUMENT_RESULT(result) ((void)0)
+#define JSARRAY_INSTRUMENT_GROWTH() ((void)0)
+
+#endif
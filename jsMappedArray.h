@@ -0,0 +1,737 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <string>
+#include <utility>
+#include <cerrno>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "jsArraySerialize.h"
+#include "jsExternalSort.h"
+
+// file mapping helpers shared by JSMmapAllocator and MappedJSArray. Not meant to be used directly.
+namespace jsDetail
+{
+    [[noreturn]] inline void throwErrno(const char* what)
+    {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    // only a hint to the kernel, failures are ignored
+    inline void adviseMapping(void* address, std::size_t bytes, int advice) noexcept
+    {
+        if (address != nullptr && bytes != 0)
+            ::madvise(address, bytes, advice);
+    }
+
+    inline void adviseHugePages(void* address, std::size_t bytes) noexcept
+    {
+#if defined(MADV_HUGEPAGE)
+        adviseMapping(address, bytes, MADV_HUGEPAGE);
+#else
+        (void)address;
+        (void)bytes;
+#endif
+    }
+
+    // maps the first bytes of fd shared and writable, so every write ends up in the file
+    inline void* mapFile(int fd, std::size_t bytes)
+    {
+        void* address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED)
+            throwErrno("mmap");
+
+        adviseHugePages(address, bytes);
+        return address;
+    }
+
+    /**
+     * @brief resizes the file with ftruncate and its mapping with mremap, which grows in place when the
+     * address space after the mapping is free and otherwise moves the page table entries, never the data.
+     * Without mremap (not linux) the file is unmapped and mapped again.
+     */
+    inline void* remapFile(int fd, void* address, std::size_t oldBytes, std::size_t newBytes)
+    {
+        if (::ftruncate(fd, static_cast<off_t>(newBytes)) != 0)
+            throwErrno("ftruncate");
+
+#if defined(__linux__)
+        void* moved = ::mremap(address, oldBytes, newBytes, MREMAP_MAYMOVE);
+        if (moved == MAP_FAILED)
+            throwErrno("mremap");
+
+        adviseHugePages(moved, newBytes);
+        return moved;
+#else
+        ::munmap(address, oldBytes);
+        return mapFile(fd, newBytes);
+#endif
+    }
+}
+
+/**
+ * @brief allocator whose big allocations are backed by a file instead of anonymous memory, so the kernel can
+ * write cold pages back to disk and JSArray<T, JSMmapAllocator> can hold more than fits in RAM.
+ * Every allocation gets its own temporary file, unlinked right away so nothing is left behind, in
+ * $JSARRAY_MMAP_DIR (or $TMPDIR, or /tmp). The mappings are advised sequential, as the functional
+ * methods stream through them front to back, and huge pages where the file system supports them.
+ * Allocations under smallAllocationBytes come from std::allocator.
+ *
+ * std::vector grows by allocate-copy-deallocate, so reserve() the final size up front when it's known.
+ * See MappedJSArray for an array that lives in a named file and grows with mremap.
+ *
+ * Has a single template parameter so it can be used as JSArray's AllocTemplate.
+ *
+ * @tparam T element type
+ */
+template<typename T>
+class JSMmapAllocator
+{
+public:
+    using value_type = T;
+
+    static constexpr std::size_t smallAllocationBytes = std::size_t{1} << 16;
+
+    template<typename U>
+    struct rebind {using other = JSMmapAllocator<U>;};
+
+    JSMmapAllocator() noexcept = default;
+
+    template<typename U>
+    JSMmapAllocator(const JSMmapAllocator<U>&) noexcept {}
+
+    /**
+     * @brief directory the backing files are created in
+     */
+    static inline std::string directory()
+    {
+        for (const char* variable : {"JSARRAY_MMAP_DIR", "TMPDIR"})
+        {
+            const char* value = std::getenv(variable);
+            if (value != nullptr && value[0] != '\0')
+                return value;
+        }
+
+        return "/tmp";
+    }
+
+    inline T* allocate(std::size_t n)
+    {
+        const std::size_t bytes = n * sizeof(T);
+        if (bytes < smallAllocationBytes)
+            return std::allocator<T>().allocate(n);
+
+        std::string path = directory() + "/jsarray-XXXXXX";
+        const int fd = ::mkstemp(path.data());
+        if (fd < 0)
+            throw std::bad_alloc();
+
+        // the mapping keeps the file alive
+        ::unlink(path.c_str());
+        void* address = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) == 0)
+            address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        ::close(fd);
+        if (address == MAP_FAILED)
+            throw std::bad_alloc();
+
+        jsDetail::adviseMapping(address, bytes, MADV_SEQUENTIAL);
+        jsDetail::adviseHugePages(address, bytes);
+        return static_cast<T*>(address);
+    }
+
+    inline void deallocate(T* pointer, std::size_t n) noexcept
+    {
+        if (n * sizeof(T) < smallAllocationBytes)
+            std::allocator<T>().deallocate(pointer, n);
+        else
+            ::munmap(static_cast<void*>(pointer), n * sizeof(T));
+    }
+
+    template<typename U>
+    inline bool operator==(const JSMmapAllocator<U>&) const noexcept { return true; }
+
+    template<typename U>
+    inline bool operator!=(const JSMmapAllocator<U>&) const noexcept { return false; }
+};
+
+/**
+ * @brief An array of trivially copyable elements that lives in a file, for datasets bigger than RAM.
+ * The file is mapped shared, so elements are read and written in place and the page cache decides what
+ * stays in memory. The array grows by extending the file (ftruncate) and the mapping (mremap), no copy.
+ * The functional methods (map, filter, reduce, forEach, every, some) advise the kernel that they read
+ * sequentially for the duration of the pass, so it reads ahead and drops pages behind.
+ *
+ * The file is in the format of jsSerialize.h: once closed it's exactly what JSArray::serialize writes,
+ * so it can also be read back with JSArray::deserialize or viewed with JSArrayView::fromBuffer.
+ * Opening or growing the file throws std::system_error when the system calls fail. The methods that take a
+ * callback or build a result let whatever those throw through (ex. std::bad_alloc from JSMmapAllocator).
+ *
+ * @tparam T element type, must be trivially copyable
+ */
+template<typename T>
+class MappedJSArray
+{
+private:
+    static_assert(jsDetail::isSerializedRaw<T>, "MappedJSArray needs trivially copyable elements");
+
+    using element_t = T;
+    using index_t = std::size_t;
+    using self_t = MappedJSArray<T>;
+
+    using callback_traits_t = JSCallbackTraits<element_t, self_t>;
+
+    template<typename F>
+    using StandardCallbackTraits = typename callback_traits_t::template StandardCallbackTraits<std::remove_reference_t<F>>;
+
+    template<typename F, typename Accumulator_t>
+    using ReduceCallbackTraits = typename callback_traits_t::template ReduceCallbackTraits<std::remove_reference_t<F>, Accumulator_t>;
+
+    template<typename U>
+    using makeVectorEligibleType = std::remove_reference_t<U>;
+
+    template<typename U>
+    using makeMutableType = std::remove_const_t<U>;
+
+    static constexpr std::size_t minimumCapacity = 1024;
+    // memory toSorted and forEachSorted sort in at once unless told otherwise
+    static constexpr std::size_t defaultSortMemoryBudget = std::size_t{1} << 30;
+    static constexpr std::size_t payloadOffset = jsDetail::serialPayloadOffset(jsDetail::serialAlignment<element_t>);
+
+    int fd = -1;
+    unsigned char* mapping = nullptr;
+    std::size_t mappedBytes = 0;
+    std::size_t count = 0;
+    std::size_t elementCapacity = 0;
+
+    static constexpr std::size_t fileBytes(std::size_t elements) noexcept
+    {
+        return jsDetail::alignUp(payloadOffset + elements * sizeof(element_t), 8);
+    }
+
+    inline element_t* elements() const noexcept
+    {
+        return reinterpret_cast<element_t*>(mapping + payloadOffset);
+    }
+
+    inline void writeHeader() noexcept
+    {
+        const jsDetail::SerialHeader header = {
+            jsDetail::serialMagic,
+            jsDetail::serialVersion,
+            static_cast<std::uint16_t>(jsDetail::serialTypeOf<element_t>()),
+            jsDetail::serialElementSize<element_t>,
+            jsDetail::serialAlignment<element_t>,
+            static_cast<std::uint64_t>(count),
+            static_cast<std::uint64_t>(count * sizeof(element_t))
+        };
+        std::memcpy(mapping, &header, sizeof(header));
+    }
+
+    // runs visit() with the elements advised for a front to back pass
+    template<typename G>
+    inline void streamSequentially(G&& visit) const
+    {
+        jsDetail::adviseMapping(mapping, mappedBytes, MADV_SEQUENTIAL);
+        visit();
+        jsDetail::adviseMapping(mapping, mappedBytes, MADV_NORMAL);
+    }
+
+    // trims the file to its serialized size so it's a valid serialized array, then lets go of it
+    inline void close() noexcept
+    {
+        if (fd < 0)
+            return;
+
+        this->writeHeader();
+        const std::size_t used = payloadOffset + count * sizeof(element_t);
+        std::memset(mapping + used, 0, fileBytes(count) - used);
+        ::munmap(mapping, mappedBytes);
+        (void)::ftruncate(fd, static_cast<off_t>(fileBytes(count)));
+        ::close(fd);
+
+        fd = -1;
+        mapping = nullptr;
+        mappedBytes = 0;
+        count = 0;
+        elementCapacity = 0;
+    }
+
+    MappedJSArray(int fileDescriptor, std::size_t fileSize) : fd(fileDescriptor)
+    {
+        mapping = static_cast<unsigned char*>(jsDetail::mapFile(fd, fileSize));
+        mappedBytes = fileSize;
+        elementCapacity = (fileSize - payloadOffset) / sizeof(element_t);
+    }
+
+public:
+    /**
+     * @brief creates (or truncates) the file at path and maps it as an empty array
+     *
+     * @param path file to create
+     * @return MappedJSArray<T>
+     */
+    static inline MappedJSArray<element_t> create(const std::string& path)
+    {
+        const int fileDescriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fileDescriptor < 0)
+            jsDetail::throwErrno("open");
+
+        if (::ftruncate(fileDescriptor, static_cast<off_t>(fileBytes(minimumCapacity))) != 0)
+        {
+            ::close(fileDescriptor);
+            jsDetail::throwErrno("ftruncate");
+        }
+
+        MappedJSArray<element_t> result(fileDescriptor, fileBytes(minimumCapacity));
+        result.writeHeader();
+        return result;
+    }
+
+    /**
+     * @brief maps an existing file written by MappedJSArray<T> (or JSArray<T>::serialize)
+     *
+     * @param path file to open
+     * @return MappedJSArray<T>
+     */
+    static inline MappedJSArray<element_t> open(const std::string& path)
+    {
+        const int fileDescriptor = ::open(path.c_str(), O_RDWR);
+        if (fileDescriptor < 0)
+            jsDetail::throwErrno("open");
+
+        struct stat status;
+        if (::fstat(fileDescriptor, &status) != 0 || static_cast<std::size_t>(status.st_size) < payloadOffset)
+        {
+            ::close(fileDescriptor);
+            throw std::system_error(std::make_error_code(std::errc::invalid_argument), "not a serialized array");
+        }
+
+        MappedJSArray<element_t> result(fileDescriptor, static_cast<std::size_t>(status.st_size));
+        jsDetail::SerialReader reader{result.mapping, result.mappedBytes};
+        jsDetail::SerialHeader header;
+        if (!jsDetail::readSerialHeader<element_t>(reader, header) || header.alignment != jsDetail::serialAlignment<element_t>)
+        {
+            // not ours: let go of the file without rewriting it
+            ::munmap(result.mapping, result.mappedBytes);
+            ::close(result.fd);
+            result.fd = -1;
+            throw std::system_error(std::make_error_code(std::errc::invalid_argument), "not a serialized array of this element type");
+        }
+
+        result.count = static_cast<std::size_t>(header.count);
+        return result;
+    }
+
+    MappedJSArray(const MappedJSArray&) = delete;
+
+    MappedJSArray(MappedJSArray&& other) noexcept
+        : fd(other.fd), mapping(other.mapping), mappedBytes(other.mappedBytes), count(other.count), elementCapacity(other.elementCapacity)
+    {
+        other.fd = -1;
+        other.mapping = nullptr;
+        other.mappedBytes = 0;
+        other.count = 0;
+        other.elementCapacity = 0;
+    }
+
+    MappedJSArray& operator=(MappedJSArray other) noexcept
+    {
+        std::swap(fd, other.fd);
+        std::swap(mapping, other.mapping);
+        std::swap(mappedBytes, other.mappedBytes);
+        std::swap(count, other.count);
+        std::swap(elementCapacity, other.elementCapacity);
+        return *this;
+    }
+
+    ~MappedJSArray() noexcept
+    {
+        this->close();
+    }
+
+    inline std::size_t size() const noexcept { return count; }
+    inline bool empty() const noexcept { return count == 0; }
+    inline std::size_t capacity() const noexcept { return elementCapacity; }
+
+    inline element_t* data() noexcept { return this->elements(); }
+    inline const element_t* data() const noexcept { return this->elements(); }
+    inline element_t& operator[](std::size_t index) noexcept { return this->elements()[index]; }
+    inline const element_t& operator[](std::size_t index) const noexcept { return this->elements()[index]; }
+    inline element_t* begin() noexcept { return this->elements(); }
+    inline const element_t* begin() const noexcept { return this->elements(); }
+    inline element_t* end() noexcept { return this->elements() + count; }
+    inline const element_t* end() const noexcept { return this->elements() + count; }
+
+    /**
+     * @brief make sure at least n elements fit without growing the file again
+     *
+     * @param n number of elements
+     */
+    inline void reserve(std::size_t n)
+    {
+        if (n <= elementCapacity)
+            return;
+
+        const std::size_t newCapacity = std::max({n, elementCapacity * 2, minimumCapacity});
+        mapping = static_cast<unsigned char*>(jsDetail::remapFile(fd, mapping, mappedBytes, fileBytes(newCapacity)));
+        mappedBytes = fileBytes(newCapacity);
+        elementCapacity = newCapacity;
+    }
+
+    /**
+     * @brief changes the number of elements, new elements are value initialized (zero)
+     *
+     * @param n new number of elements
+     */
+    inline void resize(std::size_t n)
+    {
+        this->reserve(n);
+        if (n > count)
+            std::memset(static_cast<void*>(this->elements() + count), 0, (n - count) * sizeof(element_t));
+        count = n;
+    }
+
+    /**
+     * @brief removes every element, the file keeps its size for reuse
+     */
+    inline void clear() noexcept
+    {
+        count = 0;
+    }
+
+    /**
+     * @brief adds the specified element to the end of the array
+     *
+     * @param value element to add
+     * @return std::size_t the new length of the array
+     *
+     * @note
+     * Look here for more information: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/push
+     */
+    inline std::size_t push(const element_t& value)
+    {
+        if (count == elementCapacity)
+            this->reserve(count + 1);
+
+        this->elements()[count] = value;
+        count += 1;
+        return count;
+    }
+
+    /**
+     * @brief removes the last element from the array and returns that element. The array must not be empty.
+     *
+     * @return element_t
+     *
+     * @note
+     * Look here for more information: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/pop
+     */
+    inline element_t pop() noexcept
+    {
+        count -= 1;
+        return this->elements()[count];
+    }
+
+    /**
+     * @brief writes the header and flushes every dirty page to the file (msync), blocking until it's on disk
+     */
+    inline void flush()
+    {
+        this->writeHeader();
+        if (::msync(mapping, mappedBytes, MS_SYNC) != 0)
+            jsDetail::throwErrno("msync");
+    }
+
+    /**
+     * @brief creates a new array populated with the results of calling a provided function on every element in the calling array
+     *
+     * @tparam ResultAllocTemplate allocator template of the result, JSMmapAllocator keeps a big result out of RAM too
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return JSArray<makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>, ResultAllocTemplate>
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/map#parameters
+     */
+    template<template<typename> class ResultAllocTemplate = std::allocator, typename F>
+    inline JSArray<makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>, ResultAllocTemplate> map(F&& callback) const
+    {
+        JSArray<makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>, ResultAllocTemplate> result;
+        result.reserve(count);
+        this->streamSequentially([&]
+        {
+            for (std::size_t i = 0; i < count; i += 1)
+            {
+                result.push_back(callback_traits_t::standardCallbackHandler(callback, this->elements()[i], i, *this));
+            }
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief executes a user-supplied "reducer" callback function on each element of the array, in order,
+     * passing in the return value from the calculation on the preceding element.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 2, 3, or 4 arguments (accumulator, value, index, self)
+     * @param initValue initial value for the accumulator param (0th paramater)
+     * @return Accumulator_t
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/reduce#parameters
+     */
+    template<typename Accumulator_t, typename F>
+    inline Accumulator_t reduce(F&& callback, const Accumulator_t& initValue) const
+    {
+        makeMutableType<Accumulator_t> result = initValue;
+        this->streamSequentially([&]
+        {
+            for (std::size_t i = 0; i < count; i += 1)
+            {
+                result = callback_traits_t::template reduceCallbackHandler<Accumulator_t>(callback, result, this->elements()[i], i, *this);
+            }
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief method executes a provided callback function once for each array element.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/forEach#parameters
+     */
+    template<typename F>
+    inline void forEach(F&& callback)
+    {
+        this->streamSequentially([&]
+        {
+            for (std::size_t i = 0; i < count; i += 1)
+            {
+                callback_traits_t::standardCallbackHandler(callback, this->elements()[i], i, *this);
+            }
+        });
+    }
+
+    /**
+     * @brief creates a new array with just the elements from the calling array that pass the test implemented by the provided function.
+     *
+     * @tparam ResultAllocTemplate allocator template of the result, JSMmapAllocator keeps a big result out of RAM too
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return JSArray<T, ResultAllocTemplate>
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/filter#parameters
+     */
+    template<template<typename> class ResultAllocTemplate = std::allocator, typename F>
+    inline JSArray<element_t, ResultAllocTemplate> filter(F&& callback) const
+    {
+        static_assert(
+            std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
+            "callback return type must be bool!!!"
+        );
+
+        // the kept elements are counted first so the result is sized once: growing it by push_back would
+        // allocate (with JSMmapAllocator, create a file) and copy at every doubling
+        JSBasicBitMask<ResultAllocTemplate<std::uint64_t>> keep(count);
+        this->streamSequentially([&]
+        {
+            for (std::size_t i = 0; i < count; i += 1)
+            {
+                keep.set(i, callback_traits_t::standardCallbackHandler(callback, this->elements()[i], i, *this));
+            }
+        });
+
+        JSArray<element_t, ResultAllocTemplate> result;
+        result.reserve(keep.popcount());
+        keep.forEachSetBit([&](std::size_t i){result.push_back(this->elements()[i]);});
+        return result;
+    }
+
+    /**
+     * @brief tests whether all elements in the array pass the test implemented by the provided function.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return bool
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/every#parameters
+     */
+    template<typename F>
+    inline bool every(F&& callback) const
+    {
+        static_assert(
+            std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
+            "callback return type must be bool!!!"
+        );
+
+        bool result = true;
+        this->streamSequentially([&]
+        {
+            for (std::size_t i = 0; i < count && result; i += 1)
+            {
+                result = callback_traits_t::standardCallbackHandler(callback, this->elements()[i], i, *this);
+            }
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief tests whether at least one element in the array passes the test implemented by the provided function.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return bool
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/some#parameters
+     */
+    template<typename F>
+    inline bool some(F&& callback) const
+    {
+        static_assert(
+            std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
+            "callback return type must be bool!!!"
+        );
+
+        bool result = false;
+        this->streamSequentially([&]
+        {
+            for (std::size_t i = 0; i < count && !result; i += 1)
+            {
+                result = callback_traits_t::standardCallbackHandler(callback, this->elements()[i], i, *this);
+            }
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief sort all the elements inplace (in the file) in ascending order
+     *
+     * @return MappedJSArray<T>&
+     */
+    inline MappedJSArray<element_t>& sort() noexcept
+    {
+        std::sort(this->begin(), this->end(), [](const element_t& a, const element_t& b){return a < b;});
+        return *this;
+    }
+
+    /**
+     * @brief sort all the elements inplace (in the file) according to the callback function
+     *
+     * @tparam F callback type
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments
+     * @return MappedJSArray<T>&
+     */
+    template<typename F>
+    inline MappedJSArray<element_t>& sort(F compareFunc)
+    {
+        std::sort(this->begin(), this->end(), compareFunc);
+        return *this;
+    }
+
+    /**
+     * @brief sorted copy of the array in a new file at outputPath, in ascending order. The array doesn't have to
+     * fit in memory: see toSorted(outputPath, compareFunc, memoryBudget).
+     *
+     * @param outputPath file to create for the result, must not be this array's file
+     * @return MappedJSArray<T>
+     */
+    inline MappedJSArray<element_t> toSorted(const std::string& outputPath) const
+    {
+        return this->toSorted(outputPath, [](const element_t& a, const element_t& b){return a < b;});
+    }
+
+    /**
+     * @brief sorted copy of the array in a new file at outputPath, according to the callback function.
+     * External sort: runs of memoryBudget bytes are sorted in memory (by all hardware threads), spilled to
+     * temporary files in JSMmapAllocator::directory() and k way merged into the output. Only about
+     * memoryBudget bytes of elements are held in memory at any time (the output's pages are the page cache's).
+     *
+     * @tparam F callback type
+     * @param outputPath file to create for the result, must not be this array's file
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments,
+     * must be safe to call from several threads at once
+     * @param memoryBudget bytes of elements to sort in memory at once
+     * @return MappedJSArray<T>
+     */
+    template<typename F>
+    inline MappedJSArray<element_t> toSorted(const std::string& outputPath, F compareFunc, std::size_t memoryBudget = defaultSortMemoryBudget) const
+    {
+        MappedJSArray<element_t> result = MappedJSArray<element_t>::create(outputPath);
+        result.reserve(count);
+        this->streamSequentially([&]
+        {
+            jsDetail::externalSort(this->elements(), count, compareFunc, memoryBudget, JSMmapAllocator<element_t>::directory(), [&result](const element_t* sorted, std::size_t n)
+            {
+                std::memcpy(static_cast<void*>(result.elements() + result.count), sorted, n * sizeof(element_t));
+                result.count += n;
+            });
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief calls the callback on every element in ascending order, without writing the sorted array anywhere.
+     * See forEachSorted(callback, compareFunc, memoryBudget).
+     *
+     * @tparam G callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, sorted index, self)
+     */
+    template<typename G>
+    inline void forEachSorted(G callback) const
+    {
+        this->forEachSorted(callback, [](const element_t& a, const element_t& b){return a < b;});
+    }
+
+    /**
+     * @brief calls the callback on every element in the order given by the callback function, streaming the
+     * output of the same external sort as toSorted instead of writing it to a file.
+     *
+     * @tparam G callback type
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments
+     * (value, sorted index, self), self being the unsorted array
+     * @param compareFunc a lambda, a function ptr, or a functor (an object with operator() overloaded) with two arguments,
+     * must be safe to call from several threads at once
+     * @param memoryBudget bytes of elements to sort in memory at once
+     */
+    template<typename G, typename F>
+    inline void forEachSorted(G callback, F compareFunc, std::size_t memoryBudget = defaultSortMemoryBudget) const
+    {
+        std::size_t sortedIndex = 0;
+        this->streamSequentially([&]
+        {
+            jsDetail::externalSort(this->elements(), count, compareFunc, memoryBudget, JSMmapAllocator<element_t>::directory(), [&](const element_t* sorted, std::size_t n)
+            {
+                for (std::size_t i = 0; i < n; i += 1)
+                {
+                    callback_traits_t::standardCallbackHandler(callback, sorted[i], sortedIndex, *this);
+                    sortedIndex += 1;
+                }
+            });
+        });
+    }
+};
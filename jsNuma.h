@@ -0,0 +1,110 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "jsParallel.h"
+#include "jsThreadPool.h"
+
+// page placement helpers for JSNumaAllocator. Not meant to be used directly.
+namespace jsDetail
+{
+    inline std::size_t pageBytes() noexcept
+    {
+        const long bytes = ::sysconf(_SC_PAGESIZE);
+        return bytes > 0 ? static_cast<std::size_t>(bytes) : 4096;
+    }
+
+    /**
+     * @brief writes to every page of [address, address + count * elementSize) from the current executor, split
+     * in one part per thread with taskRange, like the parallel methods split their elements. The parts go
+     * through parallelFor as one index each, so a JSThreadPool with Affinity::NodeLocal hands part w to worker w
+     * whole, and with first touch placement (the linux default) part w ends up on the node of worker w.
+     * address must be page aligned.
+     */
+    inline void firstTouch(void* address, std::size_t count, std::size_t elementSize) noexcept
+    {
+        const std::size_t parts = std::max<std::size_t>(1, std::min(JSExecutor::current().concurrency(), count));
+        const std::size_t page = pageBytes();
+        unsigned char* const bytes = static_cast<unsigned char*>(address);
+        parallelFor(parts, [&](std::size_t w)
+        {
+            // the pages that start inside the part
+            const auto [begin, end] = taskRange(count, parts, w);
+            const std::size_t last = end * elementSize;
+            for (std::size_t offset = (begin * elementSize + page - 1) / page * page; offset < last; offset += page)
+                *static_cast<volatile unsigned char*>(bytes + offset) = 0;
+        });
+    }
+}
+
+/**
+ * @brief allocator for huge arrays on multi socket machines. Memory is placed on the NUMA node of the thread
+ * that first writes to it, so an array filled by one thread lives on one node and every other node's
+ * threads go through the interconnect for it. Big allocations of this allocator are mapped untouched and
+ * first touched in parallel by the current executor with the same split the parallel methods use, so each
+ * part lands on the node of the worker that will later process it.
+ * Use it together with a JSThreadPool built with Affinity::NodeLocal, installed with JSExecutor::setCurrent:
+ *
+ *     JSThreadPool pool(jsDetail::hardwareThreads(), JSThreadPool::Affinity::NodeLocal);
+ *     JSExecutor::setCurrent(&pool);
+ *     JSArray<double, JSNumaAllocator> values(1 << 30);
+ *     auto scaled = values.mapParallel([](double v){return v * 2;}); // also a JSNumaAllocator array
+ *
+ * The adaptive methods run their first few microseconds of elements on the calling thread before splitting the
+ * rest, which shifts the split by that much, a negligible amount for arrays big enough to care.
+ * Allocations under smallAllocationBytes come from std::allocator. POSIX only, the placement needs linux.
+ *
+ * Has a single template parameter so it can be used as JSArray's AllocTemplate.
+ *
+ * @tparam T element type
+ */
+template<typename T>
+class JSNumaAllocator
+{
+public:
+    using value_type = T;
+
+    static constexpr std::size_t smallAllocationBytes = std::size_t{1} << 20;
+
+    template<typename U>
+    struct rebind {using other = JSNumaAllocator<U>;};
+
+    JSNumaAllocator() noexcept = default;
+
+    template<typename U>
+    JSNumaAllocator(const JSNumaAllocator<U>&) noexcept {}
+
+    inline T* allocate(std::size_t n)
+    {
+        const std::size_t bytes = n * sizeof(T);
+        if (bytes < smallAllocationBytes)
+            return std::allocator<T>().allocate(n);
+
+        void* address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED)
+            throw std::bad_alloc();
+
+        jsDetail::firstTouch(address, n, sizeof(T));
+        return static_cast<T*>(address);
+    }
+
+    inline void deallocate(T* pointer, std::size_t n) noexcept
+    {
+        if (n * sizeof(T) < smallAllocationBytes)
+            std::allocator<T>().deallocate(pointer, n);
+        else
+            ::munmap(static_cast<void*>(pointer), n * sizeof(T));
+    }
+
+    template<typename U>
+    inline bool operator==(const JSNumaAllocator<U>&) const noexcept { return true; }
+
+    template<typename U>
+    inline bool operator!=(const JSNumaAllocator<U>&) const noexcept { return false; }
+};
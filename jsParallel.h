@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "jsExecutor.h"
+
+// helpers for the ...Parallel methods of JSArray. Not meant to be used directly.
+namespace jsDetail
+{
+    // below this many elements per thread the ...Parallel methods don't bother going parallel
+    inline constexpr std::size_t parallelGrain = std::size_t{1} << 14;
+
+    /**
+     * @brief how many tasks to split n elements into so that every task gets at least minGrain elements
+     * (never more tasks than the current executor runs at once, never less than 1)
+     */
+    inline std::size_t parallelTaskCount(std::size_t n, std::size_t minGrain) noexcept
+    {
+        const std::size_t byGrain = n / std::max<std::size_t>(minGrain, 1);
+        return std::max<std::size_t>(1, std::min(JSExecutor::current().concurrency(), byGrain));
+    }
+
+    /**
+     * @brief [begin, end) of task t when n elements are split evenly into taskCount tasks
+     */
+    inline std::pair<std::size_t, std::size_t> taskRange(std::size_t n, std::size_t taskCount, std::size_t t) noexcept
+    {
+        return {n * t / taskCount, n * (t + 1) / taskCount};
+    }
+
+    /**
+     * @brief runs task(t) for every t in [0, taskCount) on the current executor (the shared work stealing
+     * pool unless replaced, see JSExecutor) and returns once all of them are done.
+     */
+    template<typename G>
+    inline void parallelFor(std::size_t taskCount, G&& task) noexcept
+    {
+        if (taskCount <= 1)
+        {
+            if (taskCount == 1)
+                task(std::size_t{0});
+            return;
+        }
+
+        auto body = [&task](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t t = begin; t < end; t += 1)
+                task(t);
+        };
+        JSExecutor::current().parallelFor(taskCount, 1, JSRangeFunction(body));
+    }
+
+    /**
+     * @brief calls body(begin, end) over ranges covering [0, n), at least grain long, on the current executor,
+     * which splits them further only as threads run out of work. Returns once all of them are done.
+     */
+    template<typename G>
+    inline void parallelRanges(std::size_t n, std::size_t grain, G&& body) noexcept
+    {
+        JSExecutor::current().parallelFor(n, grain, JSRangeFunction(body));
+    }
+
+    // the adaptive methods (mapParallel, filterParallel, reduceParallel) run their first elements on the calling thread for at least this long
+    inline constexpr std::uint64_t adaptiveProbeNanos = 20000;
+
+    // what is estimated to take less than this once the probe is done is finished on the calling thread, waking the pool isn't worth it
+    inline constexpr std::uint64_t adaptiveSerialNanos = 100000;
+
+    // the ranges handed to the executor are sized to take about this long
+    inline constexpr std::uint64_t adaptiveChunkNanos = 50000;
+
+    // one per call site: the decayed callback type (unique per lambda, the same whether it was passed as an
+    // lvalue, const or a temporary) and the array type
+    template<typename... Keys>
+    struct CallSite {};
+
+    // per element cost last measured at a call site in picoseconds, 0 until the first call
+    template<typename Site>
+    inline std::atomic<std::uint64_t> elementCostPicos{0};
+
+    struct AdaptivePlan
+    {
+        std::size_t probed;  // [0, probed) is already done
+        std::size_t grain;   // range size for the executor
+        bool parallel;       // false: finish [probed, n) on the calling thread
+    };
+
+    /**
+     * @brief times body(begin, end) on a growing prefix of [0, n), on the calling thread, until it has run for
+     * adaptiveProbeNanos (in one go if Site was measured before, doubling from 1 element otherwise). The per
+     * element cost is remembered for Site and decides whether the rest is worth running in parallel and in which ranges.
+     * Small inputs are entirely done by the probe, so they cost no more than a serial loop.
+     */
+    template<typename Site, typename G>
+    inline AdaptivePlan adaptiveProbe(std::size_t n, G&& body) noexcept
+    {
+        const std::size_t concurrency = JSExecutor::current().concurrency();
+        if (concurrency == 1 || n < 2)
+            return {0, 1, false};
+
+        const std::uint64_t cachedPicos = elementCostPicos<Site>.load(std::memory_order_relaxed);
+        std::size_t chunk = cachedPicos == 0 ? 1 : static_cast<std::size_t>(std::max<std::uint64_t>(1, adaptiveProbeNanos * 1000 / cachedPicos));
+        std::size_t probed = 0;
+        std::uint64_t elapsed = 0;
+        while (probed < n && elapsed < adaptiveProbeNanos)
+        {
+            const std::size_t stop = probed + std::min(chunk, n - probed);
+            const auto start = std::chrono::steady_clock::now();
+            body(probed, stop);
+            elapsed += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            probed = stop;
+            chunk *= 2;
+        }
+
+        const double nanosPerElement = static_cast<double>(elapsed) / static_cast<double>(probed);
+        elementCostPicos<Site>.store(std::max<std::uint64_t>(1, static_cast<std::uint64_t>(nanosPerElement * 1000)), std::memory_order_relaxed);
+
+        const std::size_t rest = n - probed;
+        if (rest == 0 || static_cast<double>(rest) * nanosPerElement < static_cast<double>(adaptiveSerialNanos))
+            return {probed, 1, false};
+
+        // ranges of about adaptiveChunkNanos, but enough of them that every thread gets a few
+        const double byCost = static_cast<double>(adaptiveChunkNanos) / std::max(nanosPerElement, 0.001);
+        const std::size_t byThreads = std::max<std::size_t>(1, rest / (concurrency * 4));
+        const std::size_t grain = byCost >= static_cast<double>(byThreads) ? byThreads : std::max<std::size_t>(1, static_cast<std::size_t>(byCost));
+        return {probed, grain, true};
+    }
+
+    /**
+     * @brief body(begin, end) over [0, n): adaptiveProbe, then the rest either on the calling thread
+     * or on the current executor in ranges of the chosen grain
+     */
+    template<typename Site, typename G>
+    inline void adaptiveFor(std::size_t n, G&& body) noexcept
+    {
+        const AdaptivePlan plan = adaptiveProbe<Site>(n, body);
+        if (!plan.parallel)
+        {
+            if (plan.probed < n)
+                body(plan.probed, n);
+            return;
+        }
+
+        const std::size_t offset = plan.probed;
+        parallelRanges(n - offset, plan.grain, [&](std::size_t begin, std::size_t end){body(offset + begin, offset + end);});
+    }
+}
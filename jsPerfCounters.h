@@ -0,0 +1,292 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/**
+ * @brief hardware counters read around one measured call, see JSPerfCounters. A counter is empty when the
+ * kernel or the CPU doesn't provide it (containers, most VMs, perf_event_paranoid > 2).
+ * Counts are scaled up when the kernel had to multiplex the counters.
+ */
+struct JSPerfSample
+{
+    std::optional<std::uint64_t> cycles;
+    std::optional<std::uint64_t> instructions;
+    std::optional<std::uint64_t> l1dReadMisses;
+    std::optional<std::uint64_t> llcMisses;
+    std::optional<std::uint64_t> branchMisses;
+    std::uint64_t nanos = 0;
+    std::size_t elements = 0;
+
+    // instructions per cycle, high for compute bound kernels, well under 1 for memory bound ones
+    inline std::optional<double> ipc() const noexcept
+    {
+        if (!cycles || !instructions || *cycles == 0)
+            return std::nullopt;
+        return static_cast<double>(*instructions) / static_cast<double>(*cycles);
+    }
+
+    // ex. perElement(sample.branchMisses): mispredicts per element
+    inline std::optional<double> perElement(const std::optional<std::uint64_t>& counter) const noexcept
+    {
+        if (!counter || elements == 0)
+            return std::nullopt;
+        return static_cast<double>(*counter) / static_cast<double>(elements);
+    }
+
+    /**
+     * @brief one line summary, ex. "n=1000000 ns/elem=0.84 ipc=2.91 cycles/elem=2.6 l1d-miss/elem=0.06 llc-miss/elem=0.00 branch-miss/elem=0.49"
+     * (counters that aren't available are left out)
+     */
+    inline std::string report() const
+    {
+        std::string out = "n=" + std::to_string(elements);
+        auto add = [&out](const char* name, const std::optional<double>& value)
+        {
+            if (!value)
+                return;
+
+            char formatted[64];
+            std::snprintf(formatted, sizeof(formatted), " %s=%.2f", name, *value);
+            out += formatted;
+        };
+
+        add("ns/elem", elements == 0 ? std::nullopt : std::optional<double>(static_cast<double>(nanos) / static_cast<double>(elements)));
+        add("ipc", this->ipc());
+        add("cycles/elem", this->perElement(cycles));
+        add("l1d-miss/elem", this->perElement(l1dReadMisses));
+        add("llc-miss/elem", this->perElement(llcMisses));
+        add("branch-miss/elem", this->perElement(branchMisses));
+        return out;
+    }
+};
+
+/**
+ * @brief Linux perf_event counters for cycles, instructions, L1D read misses, LLC misses and branch misses of
+ * the calling thread (user space only), to tell whether a kernel is compute, cache or branch bound:
+ *
+ *     JSPerfCounters counters;
+ *     JSPerfSample branchy = counters.measure(values.size(), [&]{values.filter(isOdd);});
+ *     JSPerfSample branchless = counters.measure(values.size(), [&]{values.mask(isOdd);});
+ *     std::puts(branchy.report().c_str());
+ *
+ * Work the ...Parallel methods hand to pool threads isn't counted: install a JSInlineExecutor while measuring them.
+ * The counters are opened as one group led by cycles, so the kernel schedules them together and a multiplexed
+ * ipc still divides counts of the same window. A counter that can't join the group (the PMU is out of slots,
+ * or cycles isn't available) is opened on its own instead, so the ones the machine supports still work.
+ * Elsewhere than linux nothing is available and samples only carry the wall time.
+ */
+class JSPerfCounters
+{
+private:
+    enum Counter : std::size_t { Cycles, Instructions, L1dReadMisses, LlcMisses, BranchMisses, CounterCount };
+
+    std::array<int, CounterCount> fds;
+    std::array<bool, CounterCount> grouped{};       // read through the group of fds[Cycles]
+    std::array<Counter, CounterCount> groupOrder{}; // members in the order the group read returns them
+    std::size_t groupSize = 0;
+    std::chrono::steady_clock::time_point start;
+
+#if defined(__linux__)
+    // groupFd: -1 to open a counter on its own, -1 with leader to start a group, else the leader to join
+    static inline int open(std::uint32_t type, std::uint64_t config, int groupFd = -1, bool leader = false) noexcept
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = type;
+        attributes.config = config;
+        // members follow their leader, only the leader and lone counters are enabled by hand
+        attributes.disabled = groupFd < 0 ? 1 : 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        if (leader)
+            attributes.read_format |= PERF_FORMAT_GROUP;
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, groupFd, 0));
+    }
+
+    // count scaled up by time enabled / time running when the counter was multiplexed
+    static inline std::optional<std::uint64_t> scaled(std::uint64_t value, std::uint64_t enabled, std::uint64_t running) noexcept
+    {
+        if (running == 0)
+            return std::nullopt;
+
+        if (running == enabled)
+            return value;
+        return static_cast<std::uint64_t>(static_cast<double>(value) * static_cast<double>(enabled) / static_cast<double>(running));
+    }
+
+    static inline std::optional<std::uint64_t> read(int fd) noexcept
+    {
+        if (fd < 0)
+            return std::nullopt;
+
+        // value, time enabled, time running
+        std::uint64_t values[3] = {};
+        if (::read(fd, values, sizeof(values)) != static_cast<::ssize_t>(sizeof(values)))
+            return std::nullopt;
+
+        return scaled(values[0], values[1], values[2]);
+    }
+
+    // every member of the group from one read of the leader, all scaled by the same window
+    inline void readGroup(std::array<std::optional<std::uint64_t>, CounterCount>& counts) const noexcept
+    {
+        // number of members, time enabled, time running, then one value per member
+        std::uint64_t values[3 + CounterCount] = {};
+        const ::ssize_t expected = static_cast<::ssize_t>((3 + groupSize) * sizeof(std::uint64_t));
+        if (::read(fds[Cycles], values, sizeof(values)) != expected || values[0] != groupSize)
+            return;
+
+        for (std::size_t member = 0; member < groupSize; member += 1)
+            counts[groupOrder[member]] = scaled(values[3 + member], values[1], values[2]);
+    }
+
+    // opens counter as a member of the cycles group, or on its own if it can't join
+    inline void openCounter(Counter counter, std::uint32_t type, std::uint64_t config) noexcept
+    {
+        if (groupSize != 0)
+        {
+            fds[counter] = open(type, config, fds[Cycles]);
+            if (fds[counter] >= 0)
+            {
+                grouped[counter] = true;
+                groupOrder[groupSize] = counter;
+                groupSize += 1;
+                return;
+            }
+        }
+
+        fds[counter] = open(type, config);
+    }
+
+    // ioctl on every counter, a whole group at once through its leader
+    inline void control(unsigned long request) noexcept
+    {
+        if (groupSize != 0)
+            ::ioctl(fds[Cycles], request, PERF_IOC_FLAG_GROUP);
+
+        for (std::size_t counter = 0; counter < CounterCount; counter += 1)
+        {
+            if (fds[counter] >= 0 && !grouped[counter])
+                ::ioctl(fds[counter], request, 0);
+        }
+    }
+#endif
+
+public:
+    JSPerfCounters() noexcept
+    {
+        fds.fill(-1);
+#if defined(__linux__)
+        constexpr std::uint64_t l1dReadMiss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        fds[Cycles] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1, true);
+        if (fds[Cycles] >= 0)
+        {
+            grouped[Cycles] = true;
+            groupOrder[0] = Cycles;
+            groupSize = 1;
+        }
+
+        this->openCounter(Instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        this->openCounter(L1dReadMisses, PERF_TYPE_HW_CACHE, l1dReadMiss);
+        this->openCounter(LlcMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        this->openCounter(BranchMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    }
+
+    JSPerfCounters(const JSPerfCounters&) = delete;
+    JSPerfCounters& operator=(const JSPerfCounters&) = delete;
+
+    ~JSPerfCounters() noexcept
+    {
+#if defined(__linux__)
+        for (int fd : fds)
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+#endif
+    }
+
+    /**
+     * @brief true if at least one hardware counter could be opened
+     */
+    inline bool available() const noexcept
+    {
+        for (int fd : fds)
+        {
+            if (fd >= 0)
+                return true;
+        }
+        return false;
+    }
+
+    // resets and starts every counter
+    inline void begin() noexcept
+    {
+#if defined(__linux__)
+        this->control(PERF_EVENT_IOC_RESET);
+        this->control(PERF_EVENT_IOC_ENABLE);
+#endif
+        start = std::chrono::steady_clock::now();
+    }
+
+    // stops the counters, elements is what per element figures are divided by
+    inline JSPerfSample end(std::size_t elements) noexcept
+    {
+        const auto stop = std::chrono::steady_clock::now();
+        JSPerfSample sample;
+#if defined(__linux__)
+        this->control(PERF_EVENT_IOC_DISABLE);
+
+        std::array<std::optional<std::uint64_t>, CounterCount> counts;
+        if (groupSize != 0)
+            this->readGroup(counts);
+        for (std::size_t counter = 0; counter < CounterCount; counter += 1)
+        {
+            if (!grouped[counter])
+                counts[counter] = read(fds[counter]);
+        }
+
+        sample.cycles = counts[Cycles];
+        sample.instructions = counts[Instructions];
+        sample.l1dReadMisses = counts[L1dReadMisses];
+        sample.llcMisses = counts[LlcMisses];
+        sample.branchMisses = counts[BranchMisses];
+#endif
+        sample.nanos = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        sample.elements = elements;
+        return sample;
+    }
+
+    /**
+     * @brief counts what fn() costs
+     *
+     * @tparam G callable type
+     * @param elements number of elements fn processes, for the per element figures
+     * @param fn the measured work
+     * @return JSPerfSample
+     */
+    template<typename G>
+    inline JSPerfSample measure(std::size_t elements, G&& fn)
+    {
+        this->begin();
+        fn();
+        return this->end(elements);
+    }
+};
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+template<typename T, template<typename> class AllocTemplate>
+class JSArray;
+
+/*
+ * Binary format written by JSArray::serialize and read by JSArray::deserialize / JSArrayView::fromBuffer.
+ * Every array is:
+ *   - a 32 byte header (SerialHeader below, native byte order: a reader with the other byte order fails the magic check)
+ *   - zero padding up to the payload offset, the header size rounded up to the element alignment
+ *   - the payload:
+ *       numbers and other trivially copyable elements: the raw elements (bool as one byte each)
+ *       std::string: per element a uint64 length followed by its bytes
+ *       JSArray: per element a complete nested array in this same format
+ *   - zero padding up to a multiple of 8 bytes, so nested arrays stay 8 byte aligned
+ */
+namespace jsDetail
+{
+    inline constexpr std::uint32_t serialMagic = 0x5241534a; // "JSAR" in little endian
+    inline constexpr std::uint16_t serialVersion = 1;
+
+    enum class SerialType : std::uint16_t
+    {
+        Raw,    // any other trivially copyable type, only elementSize is checked
+        Bool,
+        Char,
+        Int8,
+        Uint8,
+        Int16,
+        Uint16,
+        Int32,
+        Uint32,
+        Int64,
+        Uint64,
+        Float32,
+        Float64,
+        String,
+        Array
+    };
+
+    struct SerialHeader
+    {
+        std::uint32_t magic;
+        std::uint16_t version;
+        std::uint16_t type;         // SerialType
+        std::uint32_t elementSize;  // 0 for strings and nested arrays
+        std::uint32_t alignment;    // alignment of the payload
+        std::uint64_t count;        // number of elements
+        std::uint64_t payloadBytes; // without the paddings
+    };
+    static_assert(sizeof(SerialHeader) == 32, "SerialHeader must not have padding");
+
+    template<typename T>
+    struct IsJSArray : std::false_type {};
+    template<typename T, template<typename> class AllocTemplate>
+    struct IsJSArray<JSArray<T, AllocTemplate>> : std::true_type {};
+
+    // trivially copyable elements are stored as is and can be viewed without a copy
+    template<typename T>
+    inline constexpr bool isSerializedRaw = std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>;
+
+    template<typename T>
+    inline constexpr bool isSerializable = isSerializedRaw<T> || std::is_same_v<T, std::string> || IsJSArray<T>::value;
+
+    template<typename T>
+    inline constexpr SerialType serialTypeOf() noexcept
+    {
+        if constexpr (std::is_same_v<T, std::string>)
+            return SerialType::String;
+        else if constexpr (IsJSArray<T>::value)
+            return SerialType::Array;
+        else if constexpr (std::is_same_v<T, bool>)
+            return SerialType::Bool;
+        else if constexpr (std::is_same_v<T, char>)
+            return SerialType::Char;
+        else if constexpr (std::is_integral_v<T>)
+        {
+            constexpr SerialType signedTypes[] = {SerialType::Int8, SerialType::Int16, SerialType::Int32, SerialType::Int64};
+            constexpr SerialType unsignedTypes[] = {SerialType::Uint8, SerialType::Uint16, SerialType::Uint32, SerialType::Uint64};
+            constexpr std::size_t sizeIndex = sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : 3;
+            return std::is_signed_v<T> ? signedTypes[sizeIndex] : unsignedTypes[sizeIndex];
+        }
+        else if constexpr (std::is_floating_point_v<T> && sizeof(T) == 4)
+            return SerialType::Float32;
+        else if constexpr (std::is_floating_point_v<T> && sizeof(T) == 8)
+            return SerialType::Float64;
+        else
+            return SerialType::Raw;
+    }
+
+    template<typename T>
+    inline constexpr std::uint32_t serialElementSize = isSerializedRaw<T> ? static_cast<std::uint32_t>(sizeof(T)) : 0;
+
+    template<typename T>
+    inline constexpr std::uint32_t serialAlignment = isSerializedRaw<T> ? static_cast<std::uint32_t>(alignof(T)) : 8;
+
+    inline constexpr std::size_t alignUp(std::size_t n, std::size_t alignment) noexcept
+    {
+        return (n + alignment - 1) / alignment * alignment;
+    }
+
+    inline constexpr std::size_t serialPayloadOffset(std::size_t alignment) noexcept
+    {
+        return alignUp(sizeof(SerialHeader), alignment);
+    }
+
+    template<typename Writer>
+    inline void writeSerialPadding(Writer& writer, std::size_t bytes)
+    {
+        static constexpr unsigned char zeros[64] = {};
+        while (bytes != 0)
+        {
+            const std::size_t chunk = bytes < sizeof(zeros) ? bytes : sizeof(zeros);
+            writer(static_cast<const void*>(zeros), chunk);
+            bytes -= chunk;
+        }
+    }
+
+    // bounds checked cursor over a serialized buffer
+    struct SerialReader
+    {
+        const unsigned char* data;
+        std::size_t size;
+        std::size_t position = 0;
+
+        inline std::size_t remaining() const noexcept { return size - position; }
+        inline const unsigned char* current() const noexcept { return data + position; }
+
+        inline bool skip(std::size_t bytes) noexcept
+        {
+            if (bytes > this->remaining())
+                return false;
+            position += bytes;
+            return true;
+        }
+
+        inline bool read(void* out, std::size_t bytes) noexcept
+        {
+            if (bytes > this->remaining())
+                return false;
+            std::memcpy(out, this->current(), bytes);
+            position += bytes;
+            return true;
+        }
+    };
+
+    /**
+     * @brief reads and checks the header of an array of T, then skips to its payload.
+     * Fails when the header is for another element type or the payload doesn't fit in the buffer.
+     */
+    template<typename T>
+    inline bool readSerialHeader(SerialReader& reader, SerialHeader& header) noexcept
+    {
+        const std::size_t start = reader.position;
+        if (!reader.read(&header, sizeof(header)))
+            return false;
+
+        if (header.magic != serialMagic || header.version != serialVersion
+            || header.type != static_cast<std::uint16_t>(serialTypeOf<T>()) || header.elementSize != serialElementSize<T>
+            || header.alignment == 0 || (header.alignment & (header.alignment - 1)) != 0)
+            return false;
+
+        if (!reader.skip(serialPayloadOffset(header.alignment) - (reader.position - start)) || header.payloadBytes > reader.remaining())
+            return false;
+
+        return !isSerializedRaw<T> || (header.count == header.payloadBytes / sizeof(T) && header.payloadBytes % sizeof(T) == 0);
+    }
+}
+
+/**
+ * @brief read only, non owning view of an array of trivially copyable elements that lives in someone else's
+ * memory, usually a buffer received from another process or a mapped file written by JSArray::serialize.
+ *
+ * @tparam T element type, must be trivially copyable
+ */
+template<typename T>
+class JSArrayView
+{
+private:
+    static_assert(jsDetail::isSerializedRaw<T>, "JSArrayView needs trivially copyable elements");
+
+    const T* first = nullptr;
+    std::size_t count = 0;
+
+public:
+    using element_t = T;
+
+    JSArrayView() noexcept = default;
+    JSArrayView(const T* data, std::size_t size) noexcept : first(data), count(size) {}
+
+    /**
+     * @brief views the elements of a buffer written by JSArray<T>::serialize in place, without copying them.
+     *
+     * @param buffer start of the serialized array, must stay alive as long as the view is used
+     * @param size size of buffer in bytes
+     * @return std::optional<JSArrayView<T>> empty if the buffer isn't a serialized array of T, is truncated,
+     * or the elements aren't aligned for T in memory
+     */
+    static inline std::optional<JSArrayView<T>> fromBuffer(const void* buffer, std::size_t size) noexcept
+    {
+        jsDetail::SerialReader reader{static_cast<const unsigned char*>(buffer), size};
+        jsDetail::SerialHeader header;
+        if (!jsDetail::readSerialHeader<T>(reader, header))
+            return std::nullopt;
+
+        if (reinterpret_cast<std::uintptr_t>(reader.current()) % alignof(T) != 0)
+            return std::nullopt;
+
+        return JSArrayView<T>(reinterpret_cast<const T*>(reader.current()), static_cast<std::size_t>(header.count));
+    }
+
+    inline const T* data() const noexcept { return first; }
+    inline std::size_t size() const noexcept { return count; }
+    inline bool empty() const noexcept { return count == 0; }
+    inline const T& operator[](std::size_t i) const noexcept { return first[i]; }
+    inline const T* begin() const noexcept { return first; }
+    inline const T* end() const noexcept { return first + count; }
+
+    /**
+     * @brief copy of the viewed elements into a JSArray that owns them
+     */
+    template<template<typename> class AllocTemplate = std::allocator>
+    inline JSArray<T, AllocTemplate> toArray() const noexcept
+    {
+        return JSArray<T, AllocTemplate>(this->begin(), this->end());
+    }
+};
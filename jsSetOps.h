@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// merge based kernels for JSArray's set operations on sorted input. Not meant to be used directly.
+// Every kernel appends distinct values in ascending order to "out" (anything with push_back/back/empty).
+namespace jsDetail
+{
+    // above this size ratio intersect/difference gallop through the big array instead of merging
+    inline constexpr std::size_t gallopRatio = 32;
+
+    template<typename T, typename Out, typename Less>
+    inline void appendIfNew(Out& out, const T& value, const Less& less) noexcept
+    {
+        if (out.empty() || less(out.back(), value))
+            out.push_back(value);
+    }
+
+    /**
+     * @brief first position in [from, n) whose value is not less than value. Probes from, from + 1, from + 3, from + 7...
+     * then binary searches the last gap, so it costs O(log distance) instead of O(log n).
+     */
+    template<typename T, typename Less>
+    inline std::size_t gallopLowerBound(const T* values, std::size_t from, std::size_t n, const T& value, const Less& less) noexcept
+    {
+        std::size_t step = 1;
+        std::size_t low = from;
+        std::size_t high = from;
+        while (high < n && less(values[high], value))
+        {
+            low = high + 1;
+            high = from + step;
+            step *= 2;
+        }
+
+        return static_cast<std::size_t>(std::lower_bound(values + low, values + std::min(high, n), value, less) - values);
+    }
+
+    // a is the small side: every value of a is looked up in b by galloping forward
+    template<typename T, typename Out, typename Less>
+    inline void gallopIntersect(const T* a, std::size_t na, const T* b, std::size_t nb, const Less& less, Out& out) noexcept
+    {
+        std::size_t j = 0;
+        for (std::size_t i = 0; i < na && j < nb; i += 1)
+        {
+            j = gallopLowerBound(b, j, nb, a[i], less);
+            if (j < nb && !less(a[i], b[j]))
+                appendIfNew(out, a[i], less);
+        }
+    }
+
+    template<typename T, typename Out, typename Less>
+    inline void mergeIntersect(const T* a, std::size_t na, const T* b, std::size_t nb, std::size_t i, std::size_t j, const Less& less, Out& out) noexcept
+    {
+        while (i < na && j < nb)
+        {
+            if (less(a[i], b[j]))
+                i += 1;
+            else if (less(b[j], a[i]))
+                j += 1;
+            else
+            {
+                appendIfNew(out, a[i], less);
+                i += 1;
+                j += 1;
+            }
+        }
+    }
+
+#if defined(__SSE2__)
+    /**
+     * @brief intersection of two sorted arrays of 32 bit integers, 4 x 4 elements per step: a block of a is compared
+     * against a block of b and its three rotations, which finds every equal pair among the 16 combinations with
+     * 4 vector compares. Whichever block has the smaller last element can't match anything further and is skipped.
+     */
+    template<typename T, typename Out, typename Less>
+    inline void simdIntersect(const T* a, std::size_t na, const T* b, std::size_t nb, const Less& less, Out& out) noexcept
+    {
+        static_assert(std::is_integral_v<T> && sizeof(T) == 4, "simdIntersect is for 32 bit integers only");
+
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i + 4 <= na && j + 4 <= nb)
+        {
+            const __m128i blockA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            const __m128i blockB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+            const __m128i rotated1 = _mm_shuffle_epi32(blockB, _MM_SHUFFLE(0, 3, 2, 1));
+            const __m128i rotated2 = _mm_shuffle_epi32(blockB, _MM_SHUFFLE(1, 0, 3, 2));
+            const __m128i rotated3 = _mm_shuffle_epi32(blockB, _MM_SHUFFLE(2, 1, 0, 3));
+            const __m128i matches = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi32(blockA, blockB), _mm_cmpeq_epi32(blockA, rotated1)),
+                _mm_or_si128(_mm_cmpeq_epi32(blockA, rotated2), _mm_cmpeq_epi32(blockA, rotated3))
+            );
+
+            // one bit per lane of a
+            for (int mask = _mm_movemask_ps(_mm_castsi128_ps(matches)); mask != 0; mask &= mask - 1)
+            {
+                int lane = 0;
+                while (((mask >> lane) & 1) == 0)
+                    lane += 1;
+                appendIfNew(out, a[i + static_cast<std::size_t>(lane)], less);
+            }
+
+            const T lastA = a[i + 3];
+            const T lastB = b[j + 3];
+            if (!less(lastB, lastA))
+                i += 4;
+            if (!less(lastA, lastB))
+                j += 4;
+        }
+
+        mergeIntersect(a, na, b, nb, i, j, less, out);
+    }
+#endif
+
+    template<typename T, typename Out, typename Less>
+    inline void sortedIntersect(const T* a, std::size_t na, const T* b, std::size_t nb, const Less& less, Out& out) noexcept
+    {
+        if (na * gallopRatio < nb)
+            return gallopIntersect(a, na, b, nb, less, out);
+        if (nb * gallopRatio < na)
+            return gallopIntersect(b, nb, a, na, less, out);
+
+#if defined(__SSE2__)
+        if constexpr (std::is_integral_v<T> && sizeof(T) == 4)
+            return simdIntersect(a, na, b, nb, less, out);
+#endif
+
+        mergeIntersect(a, na, b, nb, std::size_t{0}, std::size_t{0}, less, out);
+    }
+
+    // values of a not in b
+    template<typename T, typename Out, typename Less>
+    inline void sortedDifference(const T* a, std::size_t na, const T* b, std::size_t nb, const Less& less, Out& out) noexcept
+    {
+        const bool gallop = na * gallopRatio < nb;
+        std::size_t j = 0;
+        for (std::size_t i = 0; i < na; i += 1)
+        {
+            if (gallop)
+                j = gallopLowerBound(b, j, nb, a[i], less);
+            else
+                while (j < nb && less(b[j], a[i]))
+                    j += 1;
+
+            if (j == nb || less(a[i], b[j]))
+                appendIfNew(out, a[i], less);
+        }
+    }
+
+    template<typename T, typename Out, typename Less>
+    inline void sortedUnion(const T* a, std::size_t na, const T* b, std::size_t nb, const Less& less, Out& out) noexcept
+    {
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < na || j < nb)
+        {
+            if (j == nb || (i < na && !less(b[j], a[i])))
+                appendIfNew(out, a[i++], less);
+            else
+                appendIfNew(out, b[j++], less);
+        }
+    }
+
+    template<typename T, typename Out, typename Less>
+    inline void sortedSymmetricDifference(const T* a, std::size_t na, const T* b, std::size_t nb, const Less& less, Out& out) noexcept
+    {
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < na || j < nb)
+        {
+            if (j == nb || (i < na && less(a[i], b[j])))
+                appendIfNew(out, a[i++], less);
+            else if (i == na || less(b[j], a[i]))
+                appendIfNew(out, b[j++], less);
+            else
+            {
+                // equal: skip every copy of this value on both sides
+                const T value = a[i];
+                while (i < na && !less(value, a[i]))
+                    i += 1;
+                while (j < nb && !less(value, b[j]))
+                    j += 1;
+            }
+        }
+    }
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+// sorting and merging kernels for sortBy, mergeSorted and friends. Not meant to be used directly.
+namespace jsDetail
+{
+    // below this many elements a comparison sort beats the radix passes
+    inline constexpr std::size_t radixSortThreshold = 256;
+
+    /**
+     * @brief maps an integral key to an unsigned 64 bit integer with the same order
+     * (signed keys get their sign bit flipped so negative numbers come first)
+     */
+    template<typename Key>
+    inline std::uint64_t radixKey(Key key) noexcept
+    {
+        static_assert(std::is_integral_v<Key>, "radixKey needs an integral key");
+        if constexpr (std::is_signed_v<Key>)
+        {
+            using unsigned_t = std::make_unsigned_t<Key>;
+            constexpr unsigned_t signBit = unsigned_t{1} << (sizeof(Key) * 8 - 1);
+            return static_cast<std::uint64_t>(static_cast<unsigned_t>(key) ^ signBit);
+        }
+        else
+            return static_cast<std::uint64_t>(key);
+    }
+
+    /**
+     * @brief stable LSD radix sort of (key, index) pairs by key, one byte per pass. Passes where every
+     * key has the same byte are skipped, so small key ranges only cost a histogram pass.
+     *
+     * @param pairs (key, index) pairs, sorted in place
+     * @param keyBytes how many low bytes of the keys can be non zero
+     */
+    inline void radixSortPairs(std::vector<std::pair<std::uint64_t, std::size_t>>& pairs, std::size_t keyBytes) noexcept
+    {
+        if (pairs.empty())
+            return;
+
+        std::vector<std::pair<std::uint64_t, std::size_t>> buffer(pairs.size());
+        for (std::size_t byte = 0; byte < keyBytes; byte += 1)
+        {
+            const std::size_t shift = byte * 8;
+            std::size_t counts[256] = {};
+            for (const auto& pair : pairs)
+                counts[(pair.first >> shift) & 0xff] += 1;
+
+            if (counts[(pairs.front().first >> shift) & 0xff] == pairs.size())
+                continue;
+
+            std::size_t running = 0;
+            for (std::size_t& count : counts)
+            {
+                const std::size_t digitCount = count;
+                count = running;
+                running += digitCount;
+            }
+
+            for (const auto& pair : pairs)
+                buffer[counts[(pair.first >> shift) & 0xff]++] = pair;
+
+            pairs.swap(buffer);
+        }
+    }
+
+    /**
+     * @brief rearranges values inplace so that values[k] becomes the old values[order[k]], following the cycles
+     * of the permutation so every element is moved exactly once. order is used as scratch space and left undefined.
+     */
+    template<typename Container_t>
+    inline void applyPermutation(Container_t& values, std::vector<std::size_t>& order) noexcept
+    {
+        constexpr std::size_t done = static_cast<std::size_t>(-1);
+        for (std::size_t start = 0; start < order.size(); start += 1)
+        {
+            if (order[start] == done || order[start] == start)
+                continue;
+
+            typename Container_t::value_type carried = std::move(values[start]);
+            std::size_t position = start;
+            while (order[position] != start)
+            {
+                const std::size_t next = order[position];
+                values[position] = std::move(values[next]);
+                order[position] = done;
+                position = next;
+            }
+
+            values[position] = std::move(carried);
+            order[position] = done;
+        }
+    }
+
+    // a sorted input of a K way merge, [begin, end)
+    template<typename T>
+    struct MergeRun
+    {
+        const T* begin;
+        const T* end;
+    };
+
+    // at most this many runs are merged by scanning every head, more go through a loser tree
+    inline constexpr std::size_t headScanMaxRuns = 4;
+
+    /**
+     * @brief merges the runs into out by comparing the heads of all of them for every element.
+     * Ties go to the run with the lower index, so the merge is stable. Runs are consumed.
+     */
+    template<typename T, typename Compare, typename Out>
+    inline void headScanMerge(std::vector<MergeRun<T>>& runs, const Compare& compareFunc, Out out)
+    {
+        if (runs.size() == 2)
+        {
+            std::merge(runs[0].begin, runs[0].end, runs[1].begin, runs[1].end, out, compareFunc);
+            return;
+        }
+
+        while (true)
+        {
+            std::size_t best = runs.size();
+            for (std::size_t r = 0; r < runs.size(); r += 1)
+            {
+                if (runs[r].begin != runs[r].end && (best == runs.size() || compareFunc(*runs[r].begin, *runs[best].begin)))
+                    best = r;
+            }
+
+            if (best == runs.size())
+                return;
+
+            *out = *runs[best].begin;
+            ++out;
+            runs[best].begin += 1;
+        }
+    }
+
+    /**
+     * @brief merges the runs into out with a tournament (loser) tree: every internal node remembers the run that lost
+     * there, so after taking the winner's head only the path from its leaf to the root is replayed,
+     * log2(K) comparisons per element. Ties go to the run with the lower index (stable). Runs are consumed.
+     */
+    template<typename T, typename Compare, typename Out>
+    inline void loserTreeMerge(std::vector<MergeRun<T>>& runs, const Compare& compareFunc, Out out)
+    {
+        std::size_t leaves = 1;
+        while (leaves < runs.size())
+            leaves *= 2;
+
+        // runs past runs.size() are padding and always exhausted
+        const auto beats = [&](std::size_t a, std::size_t b)
+        {
+            const bool aDone = a >= runs.size() || runs[a].begin == runs[a].end;
+            const bool bDone = b >= runs.size() || runs[b].begin == runs[b].end;
+            if (aDone || bDone)
+                return !aDone;
+            if (compareFunc(*runs[b].begin, *runs[a].begin))
+                return false;
+            return compareFunc(*runs[a].begin, *runs[b].begin) || a < b;
+        };
+
+        // losers[0] holds the overall winner
+        std::vector<std::size_t> losers(leaves);
+        std::vector<std::size_t> winners(leaves * 2);
+        for (std::size_t leaf = 0; leaf < leaves; leaf += 1)
+            winners[leaves + leaf] = leaf;
+        for (std::size_t node = leaves - 1; node >= 1; node -= 1)
+        {
+            const std::size_t left = winners[node * 2];
+            const std::size_t right = winners[node * 2 + 1];
+            const bool leftWins = beats(left, right);
+            winners[node] = leftWins ? left : right;
+            losers[node] = leftWins ? right : left;
+        }
+        losers[0] = winners[1];
+
+        while (true)
+        {
+            std::size_t winner = losers[0];
+            if (winner >= runs.size() || runs[winner].begin == runs[winner].end)
+                return;
+
+            *out = *runs[winner].begin;
+            ++out;
+            runs[winner].begin += 1;
+
+            for (std::size_t node = (leaves + winner) / 2; node >= 1; node /= 2)
+            {
+                if (beats(losers[node], winner))
+                    std::swap(losers[node], winner);
+            }
+            losers[0] = winner;
+        }
+    }
+
+    /**
+     * @brief merges the runs into out, picking the kernel by the number of runs. Not noexcept: out may be a sink
+     * writing to disk (see jsExternalSort.h) and whatever it throws is passed on to the caller.
+     */
+    template<typename T, typename Compare, typename Out>
+    inline void multiwayMerge(std::vector<MergeRun<T>>& runs, const Compare& compareFunc, Out out)
+    {
+        if (runs.empty())
+            return;
+
+        if (runs.size() == 1)
+            std::copy(runs[0].begin, runs[0].end, out);
+        else if (runs.size() <= headScanMaxRuns)
+            headScanMerge(runs, compareFunc, out);
+        else
+            loserTreeMerge(runs, compareFunc, out);
+    }
+
+    /**
+     * @brief multiway merge path: where every run has to be cut so that the first rank elements of the stable merge
+     * are exactly the elements before the cuts. The element of that rank is searched run by run (its rank is
+     * monotone in its position), then every other run is cut right before/after its equal elements
+     * depending on whether it comes after/before the pivot's run.
+     */
+    template<typename T, typename Compare>
+    inline std::vector<std::size_t> mergeCuts(const std::vector<MergeRun<T>>& runs, std::size_t rank, const Compare& compareFunc) noexcept
+    {
+        std::vector<std::size_t> cuts(runs.size());
+        const auto cutsAround = [&](std::size_t pivotRun, std::size_t position)
+        {
+            const T& pivot = runs[pivotRun].begin[position];
+            std::size_t total = 0;
+            for (std::size_t r = 0; r < runs.size(); r += 1)
+            {
+                if (r == pivotRun)
+                    cuts[r] = position;
+                else if (r < pivotRun)
+                    cuts[r] = static_cast<std::size_t>(std::upper_bound(runs[r].begin, runs[r].end, pivot, compareFunc) - runs[r].begin);
+                else
+                    cuts[r] = static_cast<std::size_t>(std::lower_bound(runs[r].begin, runs[r].end, pivot, compareFunc) - runs[r].begin);
+                total += cuts[r];
+            }
+
+            return total;
+        };
+
+        for (std::size_t r = 0; r < runs.size(); r += 1)
+        {
+            std::size_t low = 0;
+            std::size_t high = static_cast<std::size_t>(runs[r].end - runs[r].begin);
+            while (low < high)
+            {
+                const std::size_t middle = low + (high - low) / 2;
+                const std::size_t middleRank = cutsAround(r, middle);
+                if (middleRank == rank)
+                    return cuts;
+                if (middleRank < rank)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+        }
+
+        // rank is the total size: cut every run at its end
+        for (std::size_t r = 0; r < runs.size(); r += 1)
+            cuts[r] = static_cast<std::size_t>(runs[r].end - runs[r].begin);
+        return cuts;
+    }
+}
@@ -0,0 +1,498 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <istream>
+#include <fstream>
+#include <optional>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <system_error>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "jsArray.h"
+
+/**
+ * @brief A single pass sequence of elements processed block by block, for inputs too big (or too endless)
+ * to materialize: log files, pipes, sockets, generators. map and filter are lazy and return new streams,
+ * reduce, forEach, some, every and toArray pull the blocks through. Only one block per stage is in memory
+ * at any time, so memory is O(blockSize) however long the stream is.
+ *
+ * Callbacks work like JSArray's: (value), (value, index) or (value, index, self), where index counts from
+ * the start of the stream and self is the block (a JSArray<T>) the value is in.
+ *
+ * A stream can be consumed only once. Copies share the same source.
+ *
+ * @tparam T element type
+ */
+template<typename T>
+class JSStream
+{
+private:
+    using element_t = T;
+    using index_t = std::size_t;
+    using block_t = JSArray<element_t>;
+
+    using callback_traits_t = JSCallbackTraits<element_t, block_t>;
+
+    template<typename F>
+    using StandardCallbackTraits = typename callback_traits_t::template StandardCallbackTraits<std::remove_reference_t<F>>;
+
+    template<typename F, typename Accumulator_t>
+    using ReduceCallbackTraits = typename callback_traits_t::template ReduceCallbackTraits<std::remove_reference_t<F>, Accumulator_t>;
+
+    template<typename U>
+    using makeVectorEligibleType = std::remove_reference_t<U>;
+
+    template<typename U>
+    using makeMutableType = std::remove_const_t<U>;
+
+    template<typename U>
+    friend class JSStream;
+
+public:
+    /**
+     * @brief appends up to maxElements next elements to block, returns false once the source is exhausted
+     * (it may still have appended its last elements in that call) and keeps returning false after that
+     */
+    using source_t = std::function<bool(block_t& block, std::size_t maxElements)>;
+
+    static constexpr std::size_t defaultBlockSize = 4096;
+
+private:
+    source_t source;
+    std::size_t blockSize;
+
+    // clears block and fills it with the next non empty block, false at the end of the stream
+    inline bool nextBlock(block_t& block)
+    {
+        while (true)
+        {
+            block.clear();
+            const bool more = source(block, blockSize);
+            if (!block.empty())
+                return true;
+            if (!more)
+                return false;
+        }
+    }
+
+    template<typename Range>
+    struct RangeState
+    {
+        Range range;
+        decltype(std::begin(std::declval<Range&>())) current;
+        decltype(std::end(std::declval<Range&>())) last;
+
+        explicit RangeState(Range&& values) : range(std::forward<Range>(values)), current(std::begin(range)), last(std::end(range)) {}
+    };
+
+    struct DescriptorState
+    {
+        int fd;
+        bool ownsDescriptor;
+        bool done = false;
+        std::vector<unsigned char> pending; // bytes of an element split between two reads
+
+        DescriptorState(int descriptor, bool owns) noexcept : fd(descriptor), ownsDescriptor(owns) {}
+
+        ~DescriptorState() noexcept
+        {
+            if (ownsDescriptor && fd >= 0)
+                ::close(fd);
+        }
+    };
+
+public:
+    /**
+     * @brief stream over any source, see source_t
+     *
+     * @param blockSource appends the next elements to the block it's given
+     * @param elementsPerBlock most elements processed at once by every stage
+     */
+    explicit JSStream(source_t blockSource, std::size_t elementsPerBlock = defaultBlockSize) noexcept
+        : source(std::move(blockSource)), blockSize(std::max<std::size_t>(elementsPerBlock, 1)) {}
+
+    /**
+     * @brief stream over a range: containers, views, coroutine generators... A range passed as an lvalue
+     * is referenced and must outlive the stream, an rvalue is moved into the stream.
+     *
+     * @tparam Range range type
+     * @param range the elements, converted to T
+     * @param elementsPerBlock most elements processed at once by every stage
+     * @return JSStream<T>
+     */
+    template<typename Range>
+    static inline JSStream<element_t> fromRange(Range&& range, std::size_t elementsPerBlock = defaultBlockSize)
+    {
+        auto state = std::make_shared<RangeState<Range>>(std::forward<Range>(range));
+        return JSStream<element_t>([state](block_t& block, std::size_t maxElements)
+        {
+            for (; state->current != state->last && block.size() < maxElements; ++state->current)
+            {
+                block.push_back(*state->current);
+            }
+
+            return state->current != state->last;
+        }, elementsPerBlock);
+    }
+
+    /**
+     * @brief stream over a generator function, called until it returns an empty std::optional
+     *
+     * @tparam G callable type
+     * @param generator returns std::optional<T> (or anything convertible to bool and dereferenceable to T), empty at the end
+     * @param elementsPerBlock most elements processed at once by every stage
+     * @return JSStream<T>
+     */
+    template<typename G>
+    static inline JSStream<element_t> fromGenerator(G generator, std::size_t elementsPerBlock = defaultBlockSize)
+    {
+        auto state = std::make_shared<std::pair<G, bool>>(std::move(generator), false);
+        return JSStream<element_t>([state](block_t& block, std::size_t maxElements)
+        {
+            auto& [next, done] = *state;
+            while (!done && block.size() < maxElements)
+            {
+                auto value = next();
+                if (!value)
+                    done = true;
+                else
+                    block.push_back(std::move(*value));
+            }
+
+            return !done;
+        }, elementsPerBlock);
+    }
+
+    /**
+     * @brief stream of the raw trivially copyable elements read from a file descriptor (file, pipe, socket).
+     * A block is handed down as soon as a read returns at least one whole element, so a pipe is processed
+     * as data arrives. Read errors throw std::system_error, so does an input whose size isn't a multiple
+     * of sizeof(T) (errc::bad_message) once the bytes of the last, partial element are reached.
+     *
+     * @param fd descriptor to read from
+     * @param ownsDescriptor close fd once the stream is gone
+     * @param elementsPerBlock most elements read at once
+     * @return JSStream<T>
+     */
+    static inline JSStream<element_t> fromDescriptor(int fd, bool ownsDescriptor = false, std::size_t elementsPerBlock = defaultBlockSize)
+    {
+        static_assert(std::is_trivially_copyable_v<element_t>, "fromDescriptor needs trivially copyable elements");
+
+        auto state = std::make_shared<DescriptorState>(fd, ownsDescriptor);
+        return JSStream<element_t>([state](block_t& block, std::size_t maxElements)
+        {
+            std::vector<unsigned char>& bytes = state->pending;
+            while (!state->done)
+            {
+                const std::size_t have = bytes.size();
+                bytes.resize(maxElements * sizeof(element_t));
+                const ::ssize_t got = ::read(state->fd, bytes.data() + have, bytes.size() - have);
+                if (got < 0 && errno == EINTR)
+                {
+                    bytes.resize(have);
+                    continue;
+                }
+                if (got < 0)
+                    throw std::system_error(errno, std::generic_category(), "read");
+
+                bytes.resize(have + static_cast<std::size_t>(got));
+                state->done = got == 0;
+                if (state->done && !bytes.empty())
+                    throw std::system_error(std::make_error_code(std::errc::bad_message), "read: input ends inside an element");
+
+                const std::size_t whole = bytes.size() / sizeof(element_t);
+                for (std::size_t i = 0; i < whole; i += 1)
+                {
+                    element_t value;
+                    std::memcpy(static_cast<void*>(&value), bytes.data() + i * sizeof(element_t), sizeof(element_t));
+                    block.push_back(value);
+                }
+
+                bytes.erase(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(whole * sizeof(element_t)));
+                if (whole != 0)
+                    break;
+            }
+
+            return !state->done;
+        }, elementsPerBlock);
+    }
+
+    /**
+     * @brief fromDescriptor over the file at path
+     *
+     * @param path file to read, throws std::system_error if it can't be opened
+     * @param elementsPerBlock most elements read at once
+     * @return JSStream<T>
+     */
+    static inline JSStream<element_t> fromFile(const std::string& path, std::size_t elementsPerBlock = defaultBlockSize)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "open");
+
+        return fromDescriptor(fd, true, elementsPerBlock);
+    }
+
+    /**
+     * @brief stream of the lines of a text stream (std::cin, a std::ifstream, a std::istringstream...),
+     * without their line ending. in must outlive the stream.
+     *
+     * @param in text to split
+     * @param elementsPerBlock most lines processed at once by every stage
+     * @return JSStream<std::string>
+     */
+    static inline JSStream<element_t> lines(std::istream& in, std::size_t elementsPerBlock = defaultBlockSize)
+    {
+        static_assert(std::is_same_v<element_t, std::string>, "lines makes a JSStream<std::string>");
+
+        return JSStream<element_t>([&in](block_t& block, std::size_t maxElements)
+        {
+            std::string line;
+            while (block.size() < maxElements && std::getline(in, line))
+            {
+                block.push_back(std::move(line));
+            }
+
+            return static_cast<bool>(in);
+        }, elementsPerBlock);
+    }
+
+    /**
+     * @brief lines over the text file at path
+     *
+     * @param path file to read, throws std::system_error if it can't be opened
+     * @param elementsPerBlock most lines processed at once by every stage
+     * @return JSStream<std::string>
+     */
+    static inline JSStream<element_t> linesOfFile(const std::string& path, std::size_t elementsPerBlock = defaultBlockSize)
+    {
+        static_assert(std::is_same_v<element_t, std::string>, "linesOfFile makes a JSStream<std::string>");
+
+        auto file = std::make_shared<std::ifstream>(path);
+        if (!file->is_open())
+            throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), "open");
+
+        JSStream<element_t> result = lines(*file, elementsPerBlock);
+        // the stream owns the file from now on
+        result.source = [file, lineSource = std::move(result.source)](block_t& block, std::size_t maxElements)
+        {
+            return lineSource(block, maxElements);
+        };
+        return result;
+    }
+
+    inline std::size_t elementsPerBlock() const noexcept { return blockSize; }
+
+    /**
+     * @brief lazily maps every element, block by block
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, block)
+     * @return JSStream<makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>>
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/map#parameters
+     */
+    template<typename F>
+    inline JSStream<makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>> map(F&& callback) const
+    {
+        using result_element_t = makeVectorEligibleType<typename StandardCallbackTraits<F>::return_t>;
+
+        auto input = std::make_shared<std::pair<block_t, std::size_t>>();
+        return JSStream<result_element_t>([input, callback = std::forward<F>(callback), inputSource = source](JSArray<result_element_t>& block, std::size_t maxElements) mutable
+        {
+            auto& [values, index] = *input;
+            values.clear();
+            const bool more = inputSource(values, maxElements);
+            block.reserve(values.size());
+            for (std::size_t i = 0; i < values.size(); i += 1)
+            {
+                block.push_back(callback_traits_t::standardCallbackHandler(callback, values[i], index, values));
+                index += 1;
+            }
+
+            return more;
+        }, blockSize);
+    }
+
+    /**
+     * @brief lazily keeps the elements that pass the test implemented by the provided function
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, block)
+     * @return JSStream<T>
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/filter#parameters
+     */
+    template<typename F>
+    inline JSStream<element_t> filter(F&& callback) const
+    {
+        static_assert(
+            std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
+            "callback return type must be bool!!!"
+        );
+
+        auto input = std::make_shared<std::pair<block_t, std::size_t>>();
+        return JSStream<element_t>([input, callback = std::forward<F>(callback), inputSource = source](block_t& block, std::size_t maxElements) mutable
+        {
+            auto& [values, index] = *input;
+            values.clear();
+            const bool more = inputSource(values, maxElements);
+            for (std::size_t i = 0; i < values.size(); i += 1)
+            {
+                if (callback_traits_t::standardCallbackHandler(callback, values[i], index, values))
+                    block.push_back(std::move(values[i]));
+                index += 1;
+            }
+
+            return more;
+        }, blockSize);
+    }
+
+    /**
+     * @brief pulls the whole stream through the reducer, one block at a time
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 2, 3, or 4 arguments (accumulator, value, index, block)
+     * @param initValue initial value for the accumulator param (0th paramater)
+     * @return Accumulator_t
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/reduce#parameters
+     */
+    template<typename Accumulator_t, typename F>
+    inline Accumulator_t reduce(F&& callback, const Accumulator_t& initValue)
+    {
+        makeMutableType<Accumulator_t> result = initValue;
+        block_t block;
+        std::size_t index = 0;
+        while (this->nextBlock(block))
+        {
+            for (std::size_t i = 0; i < block.size(); i += 1)
+            {
+                result = callback_traits_t::template reduceCallbackHandler<Accumulator_t>(callback, result, block[i], index, block);
+                index += 1;
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief pulls the whole stream, calling the callback on every element
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, block)
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/forEach#parameters
+     */
+    template<typename F>
+    inline void forEach(F&& callback)
+    {
+        block_t block;
+        std::size_t index = 0;
+        while (this->nextBlock(block))
+        {
+            for (std::size_t i = 0; i < block.size(); i += 1)
+            {
+                callback_traits_t::standardCallbackHandler(callback, block[i], index, block);
+                index += 1;
+            }
+        }
+    }
+
+    /**
+     * @brief whether every element passes the test, stops reading at the first one that doesn't
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, block)
+     * @return bool
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/every#parameters
+     */
+    template<typename F>
+    inline bool every(F&& callback)
+    {
+        static_assert(
+            std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
+            "callback return type must be bool!!!"
+        );
+
+        block_t block;
+        std::size_t index = 0;
+        while (this->nextBlock(block))
+        {
+            for (std::size_t i = 0; i < block.size(); i += 1)
+            {
+                if (!callback_traits_t::standardCallbackHandler(callback, block[i], index, block))
+                    return false;
+                index += 1;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief whether at least one element passes the test, stops reading at the first one that does
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, block)
+     * @return bool
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Array/some#parameters
+     */
+    template<typename F>
+    inline bool some(F&& callback)
+    {
+        static_assert(
+            std::is_same_v<std::remove_cv_t<typename StandardCallbackTraits<F>::return_t>, bool>,
+            "callback return type must be bool!!!"
+        );
+
+        block_t block;
+        std::size_t index = 0;
+        while (this->nextBlock(block))
+        {
+            for (std::size_t i = 0; i < block.size(); i += 1)
+            {
+                if (callback_traits_t::standardCallbackHandler(callback, block[i], index, block))
+                    return true;
+                index += 1;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief pulls the whole stream into one array, only for streams known to fit in memory
+     *
+     * @return JSArray<T>
+     */
+    inline JSArray<element_t> toArray()
+    {
+        JSArray<element_t> result;
+        block_t block;
+        while (this->nextBlock(block))
+        {
+            result.insert(result.end(), std::make_move_iterator(block.begin()), std::make_move_iterator(block.end()));
+        }
+
+        return result;
+    }
+};
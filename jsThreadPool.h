@@ -0,0 +1,628 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include <type_traits>
+#include <condition_variable>
+
+#include "jsExecutor.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+namespace jsDetail
+{
+    /**
+     * @brief number of hardware threads, at least 1
+     */
+    inline std::size_t hardwareThreads() noexcept
+    {
+        const unsigned int threads = std::thread::hardware_concurrency();
+        return threads == 0 ? 1 : threads;
+    }
+
+    /**
+     * @brief parses a sysfs cpu list like "0-3,8-11"
+     */
+    inline std::vector<int> parseCpuList(const std::string& list)
+    {
+        std::vector<int> cpus;
+        std::size_t position = 0;
+        while (position < list.size())
+        {
+            std::size_t next = list.find(',', position);
+            if (next == std::string::npos)
+                next = list.size();
+
+            const std::string item = list.substr(position, next - position);
+            const std::size_t dash = item.find('-');
+            try
+            {
+                const int first = std::stoi(item.substr(0, dash));
+                const int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+                for (int cpu = first; cpu <= last; cpu += 1)
+                    cpus.push_back(cpu);
+            }
+            catch (...)
+            {
+                // blank or garbled item
+            }
+
+            position = next + 1;
+        }
+
+        return cpus;
+    }
+
+    /**
+     * @brief the CPUs this process may run on, those of NUMA node 0 first, then node 1... so that consecutive
+     * workers pinned in this order share a node. Falls back to the allowed CPUs in number order without
+     * /sys/devices/system/node, and is empty where threads can't be pinned (not linux).
+     */
+    inline std::vector<int> cpusByNode()
+    {
+        std::vector<int> ordered;
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (::sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+            return ordered;
+
+        std::vector<bool> taken(CPU_SETSIZE, false);
+        for (int node = 0; ; node += 1)
+        {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            std::string list;
+            if (!file || !std::getline(file, list))
+                break;
+
+            for (int cpu : parseCpuList(list))
+            {
+                if (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed) && !taken[cpu])
+                {
+                    taken[cpu] = true;
+                    ordered.push_back(cpu);
+                }
+            }
+        }
+
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu += 1)
+        {
+            if (CPU_ISSET(cpu, &allowed) && !taken[cpu])
+                ordered.push_back(cpu);
+        }
+#endif
+        return ordered;
+    }
+
+    // only a hint, failures are ignored
+    inline void pinCurrentThread(int cpu) noexcept
+    {
+#if defined(__linux__)
+        cpu_set_t only;
+        CPU_ZERO(&only);
+        CPU_SET(cpu, &only);
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(only), &only);
+#else
+        (void)cpu;
+#endif
+    }
+
+    /**
+     * @brief Chase-Lev work stealing deque of T pointers ("Dynamic Circular Work-Stealing Deque", with the C11
+     * memory orderings of Lê et al.). The owning thread pushes and pops at the bottom, any other thread steals
+     * from the top. The ring doubles when full, retired rings are kept until the deque is destroyed because a
+     * thief may still be reading one.
+     */
+    template<typename T>
+    class ChaseLevDeque
+    {
+    private:
+        struct Ring
+        {
+            std::int64_t capacity; // power of 2
+            std::unique_ptr<std::atomic<T*>[]> slots;
+
+            explicit Ring(std::int64_t size) : capacity(size), slots(new std::atomic<T*>[static_cast<std::size_t>(size)]()) {}
+
+            inline T* get(std::int64_t i) const noexcept { return slots[static_cast<std::size_t>(i & (capacity - 1))].load(std::memory_order_relaxed); }
+            inline void put(std::int64_t i, T* item) noexcept { slots[static_cast<std::size_t>(i & (capacity - 1))].store(item, std::memory_order_relaxed); }
+        };
+
+        alignas(64) std::atomic<std::int64_t> top{0};
+        alignas(64) std::atomic<std::int64_t> bottom{0};
+        std::atomic<Ring*> ring{nullptr};
+        std::vector<std::unique_ptr<Ring>> rings; // only touched by the owner
+
+        inline Ring* grow(Ring* current, std::int64_t first, std::int64_t last) noexcept
+        {
+            rings.push_back(std::make_unique<Ring>(current->capacity * 2));
+            Ring* bigger = rings.back().get();
+            for (std::int64_t i = first; i < last; i += 1)
+                bigger->put(i, current->get(i));
+
+            ring.store(bigger, std::memory_order_release);
+            return bigger;
+        }
+
+    public:
+        explicit ChaseLevDeque(std::int64_t capacity = 64)
+        {
+            rings.push_back(std::make_unique<Ring>(capacity));
+            ring.store(rings.back().get(), std::memory_order_relaxed);
+        }
+
+        ChaseLevDeque(const ChaseLevDeque&) = delete;
+        ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+        // owner only
+        inline void push(T* item) noexcept
+        {
+            const std::int64_t b = bottom.load(std::memory_order_relaxed);
+            const std::int64_t t = top.load(std::memory_order_acquire);
+            Ring* current = ring.load(std::memory_order_relaxed);
+            if (b - t >= current->capacity)
+                current = this->grow(current, t, b);
+
+            current->put(b, item);
+            bottom.store(b + 1, std::memory_order_release);
+        }
+
+        // owner only, nullptr when empty
+        inline T* pop() noexcept
+        {
+            const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            Ring* current = ring.load(std::memory_order_relaxed);
+            bottom.store(b, std::memory_order_seq_cst);
+            std::int64_t t = top.load(std::memory_order_seq_cst);
+            if (t > b)
+            {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T* item = current->get(b);
+            if (t == b)
+            {
+                // last item: race the thieves for it
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    item = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+
+            return item;
+        }
+
+        // any thread, nullptr when empty or when another thread got the item first
+        inline T* steal() noexcept
+        {
+            std::int64_t t = top.load(std::memory_order_seq_cst);
+            const std::int64_t b = bottom.load(std::memory_order_seq_cst);
+            if (t >= b)
+                return nullptr;
+
+            T* item = ring.load(std::memory_order_acquire)->get(t);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+
+            return item;
+        }
+
+        inline bool empty() const noexcept
+        {
+            return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+        }
+    };
+}
+
+/**
+ * @brief work stealing thread pool, the default JSExecutor. Every worker owns a Chase-Lev deque.
+ * parallelFor splits its range lazily: the thread working on a range processes it grain by grain, and whenever
+ * its deque is empty (nobody is left with work to steal) it pushes the second half of what remains for an
+ * idle worker to steal. So a range is split about log2(threads) times when the work is even and further only
+ * where some parts turn out slower.
+ * Called from a worker (nested parallelism), parallelFor pushes onto that worker's deque and, while waiting
+ * for stolen halves, runs other work: no thread ever blocks or gets added. Called from any other thread, the
+ * range is handed to the workers and the caller sleeps until it's done.
+ *
+ * With Affinity::NodeLocal every worker is pinned to a CPU, in NUMA node order (see jsDetail::cpusByNode),
+ * and a range submitted from outside is cut into one even part per worker, only ever started by worker w.
+ * The same range always lands on the same node, so memory first touched that way (JSNumaAllocator) is read
+ * and written by the node it lives on. Workers done with their part still steal the halves split off the
+ * others' parts, so an uneven range only gives up locality where it has to.
+ */
+class JSThreadPool final : public JSExecutor
+{
+public:
+    enum class Affinity
+    {
+        Shared,     // workers run anywhere, ranges go to whichever worker is free
+        NodeLocal   // workers pinned in NUMA node order, part w of every range goes to worker w
+    };
+
+private:
+    struct CallerWait
+    {
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    struct RangeJob
+    {
+        const JSRangeFunction* body = nullptr;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        std::size_t grain = 1;
+        CallerWait* caller = nullptr; // set for ranges submitted by non worker threads
+        std::atomic<bool> done{false};
+    };
+
+    struct Worker
+    {
+        jsDetail::ChaseLevDeque<RangeJob> deque;
+        std::uint64_t victimSeed = 0; // only touched by the worker itself
+        std::thread thread;
+
+        // parts of submitted ranges meant for this worker (Affinity::NodeLocal)
+        std::mutex inboxMutex;
+        std::deque<RangeJob*> inbox;
+        std::atomic<std::size_t> inboxCount{0};
+
+        inline RangeJob* takeInbox() noexcept
+        {
+            if (inboxCount.load(std::memory_order_seq_cst) == 0)
+                return nullptr;
+
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            if (inbox.empty())
+                return nullptr;
+
+            RangeJob* job = inbox.front();
+            inbox.pop_front();
+            inboxCount.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    };
+
+    struct WorkerIdentity
+    {
+        const JSThreadPool* pool;
+        std::size_t index;
+    };
+
+    // a frame never has more outstanding halves than this, one per halving of a size_t range
+    static constexpr std::size_t maxSplitsPerRange = 64;
+    // rounds of stealing attempts before an idle worker goes to sleep
+    static constexpr int idleSpins = 64;
+
+    inline static thread_local WorkerIdentity self{nullptr, 0};
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    Affinity affinity;
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::deque<RangeJob*> submitted;                // ranges from non worker threads, guarded by mutex
+    std::atomic<std::size_t> submittedCount{0};
+    std::atomic<std::size_t> sleeping{0};
+    std::atomic<std::uint64_t> epoch{0};            // bumped to wake sleepers up
+    bool stopping = false;                          // guarded by mutex
+
+    // everyone: work addressed to one worker must wake that one
+    inline void notifyWork(bool everyone = false) noexcept
+    {
+        // ChaseLevDeque::push publishes with a release store of bottom, which the load of sleeping could
+        // otherwise pass (StoreLoad). Pairs with the fence after the worker's fetch_add in work()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_seq_cst) == 0)
+            return;
+
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+        }
+        if (everyone)
+            wakeUp.notify_all();
+        else
+            wakeUp.notify_one();
+    }
+
+    inline RangeJob* takeSubmitted() noexcept
+    {
+        if (submittedCount.load(std::memory_order_seq_cst) == 0)
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (submitted.empty())
+            return nullptr;
+
+        RangeJob* job = submitted.front();
+        submitted.pop_front();
+        submittedCount.fetch_sub(1, std::memory_order_relaxed);
+        return job;
+    }
+
+    // the worker's own inbox, then the other workers starting at a random one, then submitted ranges
+    inline RangeJob* steal(std::size_t thief) noexcept
+    {
+        Worker& me = *workers[thief];
+        if (RangeJob* job = me.takeInbox())
+            return job;
+
+        me.victimSeed ^= me.victimSeed << 13;
+        me.victimSeed ^= me.victimSeed >> 7;
+        me.victimSeed ^= me.victimSeed << 17;
+
+        const std::size_t count = workers.size();
+        const std::size_t start = static_cast<std::size_t>(me.victimSeed % count);
+        for (std::size_t k = 0; k < count; k += 1)
+        {
+            const std::size_t victim = (start + k) % count;
+            if (victim == thief)
+                continue;
+
+            if (RangeJob* job = workers[victim]->deque.steal())
+                return job;
+        }
+
+        return this->takeSubmitted();
+    }
+
+    inline void execute(RangeJob& job, std::size_t worker) noexcept
+    {
+        this->runRange(worker, job.begin, job.end, job.grain, *job.body);
+        if (job.caller == nullptr)
+        {
+            job.done.store(true, std::memory_order_release);
+            return;
+        }
+
+        // notify while holding the lock: the caller may destroy job as soon as it's released
+        std::lock_guard<std::mutex> lock(job.caller->mutex);
+        job.done.store(true, std::memory_order_release);
+        job.caller->done.notify_one();
+    }
+
+    // lazy binary splitting of [begin, end) on worker's deque, see the class comment
+    inline void runRange(std::size_t worker, std::size_t begin, std::size_t end, std::size_t grain, const JSRangeFunction& body) noexcept
+    {
+        jsDetail::ChaseLevDeque<RangeJob>& deque = workers[worker]->deque;
+        RangeJob halves[maxSplitsPerRange];
+        std::size_t splits = 0;
+        while (begin < end)
+        {
+            if (end - begin > grain && splits < maxSplitsPerRange && deque.empty())
+            {
+                const std::size_t middle = begin + (end - begin) / 2;
+                RangeJob& half = halves[splits];
+                half.body = &body;
+                half.begin = middle;
+                half.end = end;
+                half.grain = grain;
+                splits += 1;
+
+                deque.push(&half);
+                this->notifyWork();
+                end = middle;
+                continue;
+            }
+
+            const std::size_t stop = std::min(end, begin + grain);
+            body(begin, stop);
+            begin = stop;
+        }
+
+        // halves are joined newest first: that is the order they come back off the bottom of the deque
+        while (splits != 0)
+        {
+            splits -= 1;
+            this->join(worker, halves[splits]);
+        }
+    }
+
+    inline void join(std::size_t worker, RangeJob& half) noexcept
+    {
+        jsDetail::ChaseLevDeque<RangeJob>& deque = workers[worker]->deque;
+        RangeJob* popped = deque.pop();
+        if (popped == &half)
+        {
+            this->execute(half, worker);
+            return;
+        }
+
+        // half was stolen (and everything pushed before it with it): popped belongs to an enclosing range
+        if (popped != nullptr)
+            deque.push(popped);
+
+        while (!half.done.load(std::memory_order_acquire))
+        {
+            if (RangeJob* job = this->steal(worker))
+                this->execute(*job, worker);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    inline void work(std::size_t index, int cpu) noexcept
+    {
+        self = {this, index};
+        if (cpu >= 0)
+            jsDetail::pinCurrentThread(cpu);
+
+        while (true)
+        {
+            RangeJob* job = nullptr;
+            for (int spin = 0; spin < idleSpins && job == nullptr; spin += 1)
+            {
+                job = this->steal(index);
+                if (job == nullptr)
+                    std::this_thread::yield();
+            }
+
+            if (job == nullptr)
+            {
+                // announce the nap before the last look, so a producer either sees a sleeper or we see its work
+                sleeping.fetch_add(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                const std::uint64_t seen = epoch.load(std::memory_order_seq_cst);
+                job = this->steal(index);
+                if (job == nullptr)
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wakeUp.wait(lock, [&]{return stopping || epoch.load(std::memory_order_seq_cst) != seen;});
+                }
+                sleeping.fetch_sub(1, std::memory_order_seq_cst);
+
+                if (job == nullptr)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (stopping)
+                        return;
+                    continue;
+                }
+            }
+
+            this->execute(*job, index);
+        }
+    }
+
+public:
+    /**
+     * @param threadCount number of worker threads
+     * @param placement Affinity::NodeLocal to pin the workers and hand every worker the same part of every range
+     */
+    explicit JSThreadPool(std::size_t threadCount = jsDetail::hardwareThreads(), Affinity placement = Affinity::Shared) : affinity(placement)
+    {
+        threadCount = std::max<std::size_t>(threadCount, 1);
+        workers.reserve(threadCount);
+        for (std::size_t w = 0; w < threadCount; w += 1)
+        {
+            workers.push_back(std::make_unique<Worker>());
+            workers.back()->victimSeed = 0x9e3779b97f4a7c15ull * (w + 1);
+        }
+
+        const std::vector<int> cpus = placement == Affinity::NodeLocal ? jsDetail::cpusByNode() : std::vector<int>();
+
+        // every deque exists before any worker starts stealing
+        for (std::size_t w = 0; w < threadCount; w += 1)
+        {
+            const int cpu = cpus.empty() ? -1 : cpus[w % cpus.size()];
+            workers[w]->thread = std::thread([this, w, cpu]{this->work(w, cpu);});
+        }
+    }
+
+    JSThreadPool(const JSThreadPool&) = delete;
+    JSThreadPool& operator=(const JSThreadPool&) = delete;
+
+    // parallelFor calls must have returned
+    ~JSThreadPool() noexcept override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (std::unique_ptr<Worker>& worker : workers)
+            worker->thread.join();
+    }
+
+    inline std::size_t concurrency() const noexcept override { return workers.size(); }
+
+    inline Affinity placement() const noexcept { return affinity; }
+
+    inline void parallelFor(std::size_t n, std::size_t grain, JSRangeFunction body) noexcept override
+    {
+        grain = std::max<std::size_t>(grain, 1);
+        if (n <= grain)
+        {
+            if (n != 0)
+                body(0, n);
+            return;
+        }
+
+        if (self.pool == this)
+        {
+            this->runRange(self.index, 0, n, grain, body);
+            return;
+        }
+
+        CallerWait caller;
+        if (affinity == Affinity::NodeLocal)
+        {
+            // part w of an even split to worker w, parts no shorter than grain
+            const std::size_t parts = std::min(workers.size(), (n + grain - 1) / grain);
+            std::unique_ptr<RangeJob[]> jobs(new RangeJob[parts]);
+            for (std::size_t w = 0; w < parts; w += 1)
+            {
+                RangeJob& job = jobs[w];
+                job.body = &body;
+                job.begin = n * w / parts;
+                job.end = n * (w + 1) / parts;
+                job.grain = grain;
+                job.caller = &caller;
+
+                std::lock_guard<std::mutex> lock(workers[w]->inboxMutex);
+                workers[w]->inbox.push_back(&job);
+                workers[w]->inboxCount.fetch_add(1, std::memory_order_seq_cst);
+            }
+            this->notifyWork(true);
+
+            std::unique_lock<std::mutex> lock(caller.mutex);
+            caller.done.wait(lock, [&]
+            {
+                for (std::size_t w = 0; w < parts; w += 1)
+                {
+                    if (!jobs[w].done.load(std::memory_order_acquire))
+                        return false;
+                }
+                return true;
+            });
+            return;
+        }
+
+        RangeJob job;
+        job.body = &body;
+        job.end = n;
+        job.grain = grain;
+        job.caller = &caller;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            submitted.push_back(&job);
+            submittedCount.fetch_add(1, std::memory_order_seq_cst);
+        }
+        this->notifyWork();
+
+        std::unique_lock<std::mutex> lock(caller.mutex);
+        caller.done.wait(lock, [&]{return job.done.load(std::memory_order_acquire);});
+    }
+};
+
+namespace jsDetail
+{
+    // started on first use
+    inline JSThreadPool& defaultThreadPool() noexcept
+    {
+        static JSThreadPool pool;
+        return pool;
+    }
+
+    inline JSExecutor& defaultThreadPoolExecutor() noexcept
+    {
+        return defaultThreadPool();
+    }
+
+    // a program that includes this header anywhere gets the shared pool as its default executor, set while
+    // statics are initialized (the pool's threads still only start on first use)
+    inline const bool threadPoolIsDefault = (defaultExecutor().store(&defaultThreadPoolExecutor, std::memory_order_release), true);
+}
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+
+#include "jsArray.h"
+
+/**
+ * @brief allocator handing out 64 byte (cache line / AVX-512 register) aligned memory whose size is
+ * rounded up to a multiple of 64 bytes. So a kernel can always read whole 64 byte blocks starting at
+ * data() without ever touching memory it doesn't own, even for the last partial block.
+ * The padding bytes are allocated but never constructed, don't rely on their value.
+ *
+ * Has a single template parameter so it can be used as JSArray's AllocTemplate.
+ *
+ * @tparam T element type
+ */
+template<typename T>
+class JSAlignedAllocator
+{
+public:
+    using value_type = T;
+
+    static constexpr std::size_t alignment = 64;
+
+    template<typename U>
+    struct rebind {using other = JSAlignedAllocator<U>;};
+
+    JSAlignedAllocator() noexcept = default;
+
+    template<typename U>
+    JSAlignedAllocator(const JSAlignedAllocator<U>&) noexcept {}
+
+    /**
+     * @brief number of bytes actually reserved for n elements
+     */
+    static constexpr std::size_t paddedBytes(std::size_t n) noexcept
+    {
+        return (n * sizeof(T) + alignment - 1) / alignment * alignment;
+    }
+
+    inline T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(::operator new(paddedBytes(n), std::align_val_t{alignment}));
+    }
+
+    inline void deallocate(T* pointer, std::size_t) noexcept
+    {
+        ::operator delete(pointer, std::align_val_t{alignment});
+    }
+
+    template<typename U>
+    inline bool operator==(const JSAlignedAllocator<U>&) const noexcept { return true; }
+
+    template<typename U>
+    inline bool operator!=(const JSAlignedAllocator<U>&) const noexcept { return false; }
+};
+
+/**
+ * @brief A JSArray of numbers, modeled after javascript's TypedArray (Float64Array, Int32Array, ...).
+ * Storage is always 64 byte aligned and padded to a whole number of 64 byte blocks
+ * (see JSAlignedAllocator). The kernels here tell the compiler the data is aligned, so the whole blocks
+ * are vectorized without a peeling loop at the start; the last partial block is finished by a scalar loop,
+ * as the padding isn't initialized. The padding is for code that reads whole blocks itself (intrinsics,
+ * a GPU copy...) without going past the allocation. map and filter keep returning typed arrays so
+ * chained calls keep those guarantees.
+ *
+ * @tparam T arithmetic element type
+ */
+template<typename T>
+class JSTypedArray : public JSArray<T, JSAlignedAllocator>
+{
+private:
+    // bool would make the storage a std::vector<bool>, which has no data()
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<std::remove_cv_t<T>, bool>, "JSTypedArray element type must be an arithmetic type other than bool");
+
+    using element_t = T;
+    using base_t = JSArray<T, JSAlignedAllocator>;
+    using self_t = JSTypedArray<T>;
+    using callback_traits_t = JSCallbackTraits<element_t, self_t>;
+
+    // how many elements one 64 byte block holds
+    static constexpr std::size_t lanes = JSAlignedAllocator<T>::alignment / sizeof(T);
+
+    // integers are summed in 64 bits so Uint8Array etc. don't overflow right away
+    using sum_t = std::conditional_t<
+        std::is_floating_point_v<T>, T,
+        std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>
+    >;
+
+    inline const element_t* alignedData() const noexcept
+    {
+#if defined(__GNUC__)
+        return static_cast<const element_t*>(__builtin_assume_aligned(this->data(), JSAlignedAllocator<T>::alignment));
+#else
+        return this->data();
+#endif
+    }
+
+    // one pass over whole blocks with "lanes" independent accumulators (the compiler turns the
+    // inner loop into vector instructions), then a scalar pass over the remainder.
+    template<typename Accumulator_t, typename Combine_t>
+    inline Accumulator_t blockReduce(Accumulator_t identity, Combine_t combine) const noexcept
+    {
+        const element_t* values = this->alignedData();
+        const std::size_t blockEnd = this->size() / lanes * lanes;
+
+        Accumulator_t laneResults[lanes];
+        for (std::size_t lane = 0; lane < lanes; lane += 1)
+            laneResults[lane] = identity;
+
+        for (std::size_t i = 0; i < blockEnd; i += lanes)
+        {
+            for (std::size_t lane = 0; lane < lanes; lane += 1)
+                laneResults[lane] = combine(laneResults[lane], static_cast<Accumulator_t>(values[i + lane]));
+        }
+
+        Accumulator_t result = identity;
+        for (std::size_t lane = 0; lane < lanes; lane += 1)
+            result = combine(result, laneResults[lane]);
+        for (std::size_t i = blockEnd; i < this->size(); i += 1)
+            result = combine(result, static_cast<Accumulator_t>(values[i]));
+
+        return result;
+    }
+
+public:
+    using base_t::base_t; // inherit all constructors from JSArray (and so std::vector)
+
+    JSTypedArray(base_t&& other) noexcept : base_t(std::move(other)) {}
+    JSTypedArray(const base_t& other) noexcept : base_t(other) {}
+
+    /**
+     * @brief number of bytes that can be read starting at data(). Always a multiple of 64.
+     */
+    inline std::size_t paddedByteLength() const noexcept
+    {
+        return JSAlignedAllocator<T>::paddedBytes(this->capacity());
+    }
+
+    /**
+     * @brief sum of all elements. Integers are summed as 64 bit integers, floating point in their own type.
+     * The summation order is per block lane, so floating point results can differ slightly from a left to right reduce.
+     *
+     * @return sum_t
+     */
+    inline sum_t sum() const noexcept
+    {
+        return this->blockReduce(sum_t{0}, [](sum_t a, sum_t b){return a + b;});
+    }
+
+    /**
+     * @brief smallest element, or std::numeric_limits<T>::max() if the array is empty
+     *
+     * @return T
+     */
+    inline element_t min() const noexcept
+    {
+        return this->blockReduce(std::numeric_limits<element_t>::max(), [](element_t a, element_t b){return b < a ? b : a;});
+    }
+
+    /**
+     * @brief largest element, or std::numeric_limits<T>::lowest() if the array is empty
+     *
+     * @return T
+     */
+    inline element_t max() const noexcept
+    {
+        return this->blockReduce(std::numeric_limits<element_t>::lowest(), [](element_t a, element_t b){return a < b ? b : a;});
+    }
+
+    /**
+     * @brief same as JSArray::map, but when the callback returns a number the result is a typed array again
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/TypedArray/map#parameters
+     */
+    template<typename F>
+    inline auto map(F&& callback) const noexcept
+    {
+        using result_element_t = std::remove_reference_t<typename callback_traits_t::template StandardCallbackTraits<std::remove_reference_t<F>>::return_t>;
+        if constexpr (std::is_arithmetic_v<result_element_t>)
+        {
+            JSTypedArray<result_element_t> result(this->size());
+            const element_t* values = this->alignedData();
+            for (std::size_t i = 0; i < this->size(); i += 1)
+            {
+                result[i] = callback_traits_t::standardCallbackHandler(callback, values[i], i, *this);
+            }
+
+            return result;
+        }
+        else
+        {
+            return base_t::map(callback);
+        }
+    }
+
+    /**
+     * @brief same as JSArray::filter but branchless: the callback results are packed into a bit mask first,
+     * 64 per word, so with a simple comparison as callback (ex. [](double x){return x > 0.5;}) there is no
+     * unpredictable branch in the loop. The result is then allocated once for the popcount of the mask and
+     * the kept elements are copied word by word.
+     *
+     * @tparam F callback type
+     * @param callback a lambda, a function ptr, or a functor (an object with operator() overloaded). Can be 1, 2, or 3 arguments (value, index, self)
+     * @return JSTypedArray<T>
+     *
+     * @note
+     * Look here for more information on callback parameters: @ref https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/TypedArray/filter#parameters
+     */
+    template<typename F>
+    inline self_t filter(F&& callback) const noexcept
+    {
+        static_assert(
+            std::is_same_v<std::remove_cv_t<typename callback_traits_t::template StandardCallbackTraits<std::remove_reference_t<F>>::return_t>, bool>,
+            "callback return type must be bool!!!"
+        );
+
+        const element_t* values = this->alignedData();
+        JSBasicBitMask<JSAlignedAllocator<std::uint64_t>> keep(this->size());
+        std::uint64_t* words = keep.words();
+        for (std::size_t w = 0; w < keep.wordCount(); w += 1)
+        {
+            const std::size_t blockEnd = std::min(this->size(), (w + 1) * 64);
+            std::uint64_t word = 0;
+            for (std::size_t i = w * 64; i < blockEnd; i += 1)
+            {
+                word |= static_cast<std::uint64_t>(callback_traits_t::standardCallbackHandler(callback, values[i], i, *this)) << (i % 64);
+            }
+
+            words[w] = word;
+        }
+
+        self_t result;
+        result.reserve(keep.popcount());
+        keep.forEachSetBit([&](std::size_t i){result.push_back(values[i]);});
+        return result;
+    }
+
+    /**
+     * @brief make a copy of the current array and sort in ascending order.
+     */
+    inline self_t toSorted() const noexcept
+    {
+        return self_t(base_t::toSorted());
+    }
+
+    /**
+     * @brief make a copy of the current array and sort according to the callback function
+     */
+    template<typename F>
+    inline self_t toSorted(F compareFunc) const noexcept
+    {
+        return self_t(base_t::toSorted(compareFunc));
+    }
+};
+
+// javascript names
+using Int8Array = JSTypedArray<std::int8_t>;
+using Uint8Array = JSTypedArray<std::uint8_t>;
+using Int16Array = JSTypedArray<std::int16_t>;
+using Uint16Array = JSTypedArray<std::uint16_t>;
+using Int32Array = JSTypedArray<std::int32_t>;
+using Uint32Array = JSTypedArray<std::uint32_t>;
+using BigInt64Array = JSTypedArray<std::int64_t>;
+using BigUint64Array = JSTypedArray<std::uint64_t>;
+using Float32Array = JSTypedArray<float>;
+using Float64Array = JSTypedArray<double>;
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// assert that doesn't go away with NDEBUG, so the tests check the same thing in every build type
+#define CHECK(condition)                                                                    \
+    do                                                                                      \
+    {                                                                                       \
+        if (!(condition))                                                                   \
+        {                                                                                   \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            std::exit(1);                                                                   \
+        }                                                                                   \
+    } while (false)
+
+// checks that statement throws an Exception_t
+#define CHECK_THROWS(Exception_t, statement)                                                \
+    do                                                                                      \
+    {                                                                                       \
+        bool thrown = false;                                                                \
+        try { statement; } catch (const Exception_t&) { thrown = true; }                    \
+        CHECK(thrown && #statement " throws " #Exception_t);                                \
+    } while (false)
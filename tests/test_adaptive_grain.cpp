@@ -0,0 +1,148 @@
+#include "check.h"
+#include "jsArrayParallel.h"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace
+{
+    // one per test, so the remembered costs don't leak between them
+    struct CheapSite {};
+    struct SlowSite {};
+    struct InlineSite {};
+    struct CoverSite {};
+
+    void spin(std::chrono::nanoseconds duration)
+    {
+        const auto stop = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < stop) {}
+    }
+
+    void everyIndexRunsOnce()
+    {
+        JSThreadPool pool(4);
+        JSExecutor::setCurrent(&pool);
+        for (const std::size_t n : {0, 1, 2, 100, 5000})
+        {
+            std::vector<std::atomic<int>> visits(n);
+            jsDetail::adaptiveFor<CoverSite>(n, [&](std::size_t begin, std::size_t end)
+            {
+                CHECK(begin < end && end <= n);
+                for (std::size_t i = begin; i < end; i += 1)
+                {
+                    visits[i] += 1;
+                    spin(std::chrono::nanoseconds(200));
+                }
+            });
+            for (std::atomic<int>& count : visits)
+            {
+                CHECK(count.load() == 1);
+            }
+        }
+        JSExecutor::setCurrent(nullptr);
+    }
+
+    void cheapWorkStaysOnTheCallingThread()
+    {
+        JSThreadPool pool(4);
+        JSExecutor::setCurrent(&pool);
+        // a few hundred additions cost far less than adaptiveSerialNanos
+        // (a preemption in the middle of the probe can make one measurement look slow, hence a few tries)
+        std::vector<int> values(300, 1);
+        bool serial = false;
+        for (int attempt = 0; attempt < 5 && !serial; attempt += 1)
+        {
+            long sum = 0;
+            const jsDetail::AdaptivePlan plan = jsDetail::adaptiveProbe<CheapSite>(values.size(), [&](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i += 1)
+                {
+                    sum += values[i];
+                }
+            });
+            CHECK(plan.probed <= values.size() && sum == static_cast<long>(plan.probed));
+            serial = !plan.parallel;
+        }
+        CHECK(serial);
+        CHECK(jsDetail::elementCostPicos<CheapSite>.load() > 0);
+        JSExecutor::setCurrent(nullptr);
+    }
+
+    void slowWorkIsSplitIntoRanges()
+    {
+        JSThreadPool pool(4);
+        JSExecutor::setCurrent(&pool);
+        const std::size_t n = 4000;
+        // ~5us per element: the probe stops long before the end, and the rest is worth splitting
+        std::vector<std::atomic<int>> visits(n);
+        const auto body = [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; i += 1)
+            {
+                visits[i] += 1;
+                spin(std::chrono::microseconds(5));
+            }
+        };
+
+        const jsDetail::AdaptivePlan plan = jsDetail::adaptiveProbe<SlowSite>(n, body);
+        CHECK(plan.parallel);
+        CHECK(plan.probed > 0 && plan.probed < n);
+        // enough ranges for every thread to get a few
+        CHECK(plan.grain >= 1 && plan.grain <= (n - plan.probed) / (4 * 4));
+
+        // the second call starts from the remembered cost and still covers everything once
+        for (std::atomic<int>& count : visits)
+        {
+            count = 0;
+        }
+        jsDetail::adaptiveFor<SlowSite>(n, body);
+        for (std::atomic<int>& count : visits)
+        {
+            CHECK(count.load() == 1);
+        }
+        JSExecutor::setCurrent(nullptr);
+    }
+
+    void oneThreadNeverProbes()
+    {
+        JSInlineExecutor inlineExecutor;
+        JSExecutor::setCurrent(&inlineExecutor);
+        const jsDetail::AdaptivePlan plan = jsDetail::adaptiveProbe<InlineSite>(1000, [](std::size_t, std::size_t){});
+        CHECK(!plan.parallel && plan.probed == 0);
+        CHECK(jsDetail::elementCostPicos<InlineSite>.load() == 0);
+        JSExecutor::setCurrent(nullptr);
+    }
+
+    void parallelMethodsMatchTheSerialOnes()
+    {
+        JSThreadPool pool(4);
+        JSExecutor::setCurrent(&pool);
+        JSArray<int> values;
+        for (int i = 0; i < 20000; i += 1)
+        {
+            values.push_back(i % 1000);
+        }
+
+        // cheap callbacks (mostly serial) and slow ones (split)
+        CHECK(values.mapParallel([](int x){return x * 3;}) == values.map([](int x){return x * 3;}));
+        CHECK(values.filterParallel([](int x){return x % 7 == 0;}) == values.filter([](int x){return x % 7 == 0;}));
+        CHECK(values.reduceParallel([](long sum, int x){return sum + x;}, 0L) == values.reduce([](long sum, int x){return sum + x;}, 0L));
+
+        const auto slowSquare = [](int x, std::size_t i){spin(std::chrono::nanoseconds(500)); return static_cast<long>(x) * x + static_cast<long>(i);};
+        CHECK(values.mapParallel(slowSquare) == values.map(slowSquare));
+        const auto slowKeep = [](int x){spin(std::chrono::nanoseconds(500)); return x > 500;};
+        CHECK(values.filterParallel(slowKeep) == values.filter(slowKeep));
+        JSExecutor::setCurrent(nullptr);
+    }
+}
+
+int main()
+{
+    everyIndexRunsOnce();
+    cheapWorkStaysOnTheCallingThread();
+    slowWorkIsSplitIntoRanges();
+    oneThreadNeverProbes();
+    parallelMethodsMatchTheSerialOnes();
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "check.h"
+#include "jsArray.h"
+#include "jsCountingAllocator.h"
+
+#include <string>
+
+// exact allocation counts of the methods with JSCountingAllocator arrays: a method that starts growing its result
+// element by element, or copies where it didn't, fails here
+
+using counted_t = JSArray<int, JSCountingAllocator>;
+
+namespace
+{
+    counted_t values()
+    {
+        counted_t result;
+        result.reserve(10000);
+        for (int i = 0; i < 10000; i += 1)
+            result.push_back((i * 7919) % 1000);
+        return result;
+    }
+
+    // same values as strings, for the hash table path of unique
+    JSArray<std::string, JSCountingAllocator> strings()
+    {
+        JSArray<std::string, JSCountingAllocator> result;
+        result.reserve(10000);
+        for (int i = 0; i < 10000; i += 1)
+            result.push_back(std::to_string((i * 7919) % 1000));
+        return result;
+    }
+
+    // allocations made by call(array), not counting the copy of the input
+    template<typename G>
+    std::size_t allocationsOf(G&& call)
+    {
+        counted_t array = values();
+        JSAllocationScope scope;
+        call(array);
+        return scope.counted().allocations;
+    }
+}
+
+int main()
+{
+    CHECK(allocationsOf([](counted_t& a){a.map([](int v){return v * 2;});}) == 1);
+    // the bit mask and the result, each allocated once at its final size. One allocation would mean either
+    // guessing the result size (regrowing or wasting memory) or running the callback twice per element
+    CHECK(allocationsOf([](counted_t& a){a.filter([](int v){return v % 2 == 0;});}) == 2);
+    CHECK(allocationsOf([](counted_t& a){a.mask([](int v){return v % 2 == 0;});}) == 1);
+    CHECK(allocationsOf([](counted_t& a){a.reduce([](long sum, int v){return sum + v;}, 0L);}) == 0);
+    CHECK(allocationsOf([](counted_t& a){a.forEach([](const int&){});}) == 0);
+    CHECK(allocationsOf([](counted_t& a){a.every([](int v){return v >= 0;});}) == 0);
+    CHECK(allocationsOf([](counted_t& a){a.some([](int v){return v < 0;});}) == 0);
+    CHECK(allocationsOf([](counted_t& a){a.sort();}) == 0);
+    CHECK(allocationsOf([](counted_t& a){a.sort([](int x, int y){return x > y;});}) == 0);
+    CHECK(allocationsOf([](counted_t& a){a.toSorted();}) == 1);
+    // ints dedupe by sorting (value, index) pairs: the mask, the pairs and the result
+    CHECK(allocationsOf([](counted_t& a){a.toUnique();}) == 3);
+    CHECK(allocationsOf([](counted_t& a){a.unique();}) == 2);
+    {
+        // strings go through the hash table: 1000 distinct keys grow its slots 16 -> 2048 (8 allocations) and its
+        // dense key array 1 -> 1024 (11 allocations), plus the mask and the result
+        JSArray<std::string, JSCountingAllocator> array = strings();
+        JSAllocationScope scope;
+        const JSArray<std::string, JSCountingAllocator> unique = array.toUnique();
+        CHECK(unique.size() == 1000);
+        CHECK(scope.counted().allocations == 21);
+    }
+    CHECK(allocationsOf([](counted_t& a){a.topK(10);}) == 1);
+    CHECK(allocationsOf([](counted_t& a){a.partialSort(10);}) == 0);
+    CHECK(allocationsOf([](counted_t& a){a.nthElement(10);}) == 0);
+    return 0;
+}
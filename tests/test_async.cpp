@@ -0,0 +1,115 @@
+#include "check.h"
+#include "jsArrayAsync.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+    // counts how many callbacks are between their start and their end at the same time
+    struct InFlight
+    {
+        std::atomic<int> now{0};
+        std::atomic<int> most{0};
+
+        void enter()
+        {
+            const int current = now.fetch_add(1) + 1;
+            int seen = most.load();
+            while (current > seen && !most.compare_exchange_weak(seen, current)) {}
+        }
+
+        void leave() { now.fetch_sub(1); }
+    };
+
+    void mapAsyncKeepsTheOrder()
+    {
+        JSAsyncPool pool(4);
+        JSArray<int> keys;
+        for (int i = 0; i < 200; i += 1)
+        {
+            keys.push_back(i);
+        }
+
+        for (const std::size_t maxConcurrency : {1, 3, 64})
+        {
+            InFlight inFlight;
+            const JSArray<std::string> values = keys.mapAsync([&](const int& key) -> JSTask<std::string>
+            {
+                inFlight.enter();
+                // the "lookup" runs on a pool thread, later keys often finish first
+                std::string value = co_await pool.run([key]
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds((key * 37) % 200));
+                    return "v" + std::to_string(key);
+                });
+                inFlight.leave();
+                co_return value;
+            }, maxConcurrency);
+
+            CHECK(values.size() == keys.size());
+            for (int i = 0; i < 200; i += 1)
+            {
+                CHECK(values[static_cast<std::size_t>(i)] == "v" + std::to_string(i));
+            }
+            CHECK(inFlight.most.load() >= 1 && static_cast<std::size_t>(inFlight.most.load()) <= maxConcurrency);
+        }
+
+        CHECK(JSArray<int>().mapAsync([](const int& key) -> JSTask<int> { co_return key; }).empty());
+
+        // callbacks that finish without suspending, with the index
+        const JSArray<long> doubled = keys.mapAsync([](const int& key, std::size_t i) -> JSTask<long> { co_return key * 2L + static_cast<long>(i); });
+        CHECK(doubled[10] == 30 && doubled[199] == 597);
+    }
+
+    void forEachAsyncVisitsEveryElementOnce()
+    {
+        JSAsyncPool pool(3);
+        const JSArray<int> values(1000, 1);
+        std::atomic<int> sum{0};
+        std::atomic<std::size_t> indexSum{0};
+        values.forEachAsync([&](const int& value, std::size_t i) -> JSTask<void>
+        {
+            co_await pool.schedule();
+            sum += value;
+            indexSum += i;
+        }, 16);
+        CHECK(sum.load() == 1000);
+        CHECK(indexSum.load() == 999u * 1000u / 2);
+    }
+
+    void theFirstExceptionIsRethrown()
+    {
+        JSAsyncPool pool(2);
+        const JSArray<int> values(500, 7);
+        std::atomic<int> started{0};
+        CHECK_THROWS(std::runtime_error, values.mapAsync([&](const int& value, std::size_t i) -> JSTask<int>
+        {
+            started += 1;
+            co_await pool.schedule();
+            if (i == 20)
+                throw std::runtime_error("lookup failed");
+            co_return value;
+        }, 4));
+        // no new work starts after the failure, only what was already in flight
+        CHECK(started.load() < 500);
+
+        CHECK_THROWS(std::logic_error, values.forEachAsync([](const int&) -> JSTask<void>
+        {
+            throw std::logic_error("bad value");
+            co_return;
+        }));
+    }
+}
+
+int main()
+{
+    mapAsyncKeepsTheOrder();
+    forEachAsyncVisitsEveryElementOnce();
+    theFirstExceptionIsRethrown();
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "check.h"
+#include "jsArray.h"
+
+namespace
+{
+    // 130 elements: two full words and a partial third one
+    JSArray<int> numbers()
+    {
+        JSArray<int> result;
+        for (int i = 0; i < 130; i += 1)
+            result.push_back(i);
+        return result;
+    }
+
+    void bitsAndCounts()
+    {
+        JSBitMask mask(130);
+        CHECK(mask.size() == 130 && mask.wordCount() == 3);
+        CHECK(mask.none() && !mask.any() && !mask.all() && mask.popcount() == 0);
+
+        mask.set(0);
+        mask.set(64);
+        mask.set(129);
+        CHECK(mask[0] && mask[64] && mask[129] && !mask[1] && !mask[128]);
+        CHECK(mask.popcount() == 3 && mask.any());
+        mask.set(64, false);
+        CHECK(!mask[64] && mask.popcount() == 2);
+
+        // bits past size() stay clear, so a full mask is all() and counts exactly size()
+        const JSBitMask full(130, true);
+        CHECK(full.all() && full.popcount() == 130);
+        CHECK((full.words()[2] >> 2) == 0);
+        CHECK(JSBitMask().all() && JSBitMask().none());
+
+        std::size_t visited = 0;
+        std::size_t last = 0;
+        mask.forEachSetBit([&](std::size_t i)
+        {
+            CHECK(visited == 0 ? i == 0 : i == 129);
+            last = i;
+            visited += 1;
+        });
+        CHECK(visited == 2 && last == 129);
+    }
+
+    void combiningMasks()
+    {
+        const JSArray<int> values = numbers();
+        const JSBitMask even = values.mask([](int v){return v % 2 == 0;});
+        const JSBitMask small = values.mask([](int v){return v < 70;});
+        CHECK(even.popcount() == 65 && small.popcount() == 70);
+
+        CHECK((even & small).popcount() == 35);
+        CHECK((even | small).popcount() == 100);
+        CHECK((even ^ small).popcount() == 65);
+        const JSBitMask odd = ~even;
+        CHECK(odd.popcount() == 65 && (odd | even).all() && (odd & even).none());
+        CHECK(odd == values.mask([](int v){return v % 2 != 0;}) && odd != even);
+
+        JSBitMask both = even;
+        both &= small;
+        CHECK(both == (even & small));
+        both |= odd;
+        both ^= odd;
+        CHECK(both == (even & small));
+    }
+
+    void selectEverySome()
+    {
+        const JSArray<int> values = numbers();
+        const JSBitMask pick = values.mask([](int v, std::size_t i){return v % 40 == 0 || i == 129;});
+        const JSArray<int> picked = values.select(pick);
+        CHECK(picked.size() == 5 && picked[0] == 0 && picked[3] == 120 && picked[4] == 129);
+        CHECK(picked.capacity() == 5);
+        CHECK(values.filter([](int v){return v % 40 == 0;}).size() == 4);
+
+        CHECK(values.every(values.mask([](int v){return v >= 0;})));
+        CHECK(!values.every(pick) && values.some(pick));
+        CHECK(!values.some(values.mask([](int v){return v > 1000;})));
+    }
+}
+
+int main()
+{
+    bitsAndCounts();
+    combiningMasks();
+    selectEverySome();
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "check.h"
+#include "jsDeque.h"
+
+#include <string>
+
+namespace
+{
+    // head in the middle of the buffer so the elements wrap around its end: capacity 8, logical [-3, 5)
+    JSDeque<int> wrapped()
+    {
+        JSDeque<int> deque;
+        for (int i = 0; i < 5; i += 1)
+            deque.push(i);
+        for (int i = 1; i <= 3; i += 1)
+            deque.unshift(-i);
+        return deque;
+    }
+
+    void shiftAndUnshiftAreQueueOperations()
+    {
+        JSDeque<int> deque;
+        CHECK(deque.empty());
+        CHECK(deque.push(1) == 1 && deque.push(2) == 2 && deque.unshift(0) == 3);
+        CHECK(deque.front() == 0 && deque.back() == 2);
+        CHECK(deque.shift() == 0 && deque.pop() == 2 && deque.shift() == 1);
+        CHECK(deque.empty());
+
+        // a queue that never holds more than 3 elements never grows, its head just walks around the ring
+        for (int i = 0; i < 1000; i += 1)
+        {
+            deque.push(i);
+            if (deque.size() == 3)
+                CHECK(deque.shift() == i - 2);
+        }
+        CHECK(deque.capacity() == 8);
+    }
+
+    void wrappedElementsKeepTheirOrder()
+    {
+        const JSDeque<int> deque = wrapped();
+        CHECK(deque.size() == 8 && deque.capacity() == 8);
+        for (std::size_t i = 0; i < deque.size(); i += 1)
+            CHECK(deque[i] == static_cast<int>(i) - 3);
+        CHECK(deque.front() == -3 && deque.back() == 4);
+    }
+
+    // every method walks the two spans of a wrapped deque with the right logical indices
+    void methodsIterateBothSpans()
+    {
+        JSDeque<int> deque = wrapped();
+
+        const JSDeque<int> mapped = deque.map([](int value, std::size_t i){return value * 10 + static_cast<int>(i);});
+        for (std::size_t i = 0; i < mapped.size(); i += 1)
+            CHECK(mapped[i] == (static_cast<int>(i) - 3) * 10 + static_cast<int>(i));
+
+        CHECK(deque.reduce([](int sum, int value){return sum + value;}, 0) == 4);
+        std::string order = deque.reduce([](std::string text, int value){return text + std::to_string(value);}, std::string());
+        CHECK(order == "-3-2-101234");
+        order = deque.reduceRight([](std::string text, int value, std::size_t i){return text + std::to_string(value) + ":" + std::to_string(i) + " ";}, std::string());
+        CHECK(order == "4:7 3:6 2:5 1:4 0:3 -1:2 -2:1 -3:0 ");
+
+        std::size_t visited = 0;
+        deque.forEach([&](const int& value, std::size_t i, const JSDeque<int>& self)
+        {
+            CHECK(&self == &deque && value == self[i] && i == visited);
+            visited += 1;
+        });
+        CHECK(visited == 8);
+
+        const JSDeque<int> odd = deque.filter([](int value){return value % 2 != 0;});
+        CHECK(odd.size() == 4 && odd[0] == -3 && odd[1] == -1 && odd[2] == 1 && odd[3] == 3);
+        CHECK(deque.every([](int value, std::size_t i){return value == static_cast<int>(i) - 3;}));
+        CHECK(deque.some([](int value){return value == 4;}));
+        CHECK(!deque.some([](int value){return value == 5;}));
+    }
+
+    // growing a wrapped deque unrolls it into the new buffer
+    void growthKeepsOrder()
+    {
+        JSDeque<int> deque = wrapped();
+        deque.push(5);
+        deque.unshift(-4);
+        CHECK(deque.size() == 10 && deque.capacity() == 16);
+        for (std::size_t i = 0; i < deque.size(); i += 1)
+            CHECK(deque[i] == static_cast<int>(i) - 4);
+
+        deque.reserve(100);
+        CHECK(deque.capacity() == 128 && deque[0] == -4 && deque[9] == 5);
+
+        const JSDeque<int> copy = wrapped();
+        JSDeque<int> assigned;
+        assigned = copy;
+        CHECK(assigned.size() == 8 && assigned[0] == -3 && assigned[7] == 4);
+    }
+
+    void sortLinearizesTheRing()
+    {
+        JSDeque<int> deque = wrapped();
+        deque.sort([](int a, int b){return a > b;});
+        for (std::size_t i = 0; i < deque.size(); i += 1)
+            CHECK(deque[i] == 4 - static_cast<int>(i));
+
+        const JSDeque<int> ascending = deque.toSorted();
+        CHECK(ascending[0] == -3 && ascending[7] == 4 && deque[0] == 4);
+    }
+
+    // the pushed value is an element of the full deque itself, it must be copied before the buffer is reallocated
+    void pushingOwnElementWhileFull()
+    {
+        JSDeque<std::string> deque;
+        for (int i = 0; i < 8; i += 1)
+            deque.push(std::string(32, static_cast<char>('a' + i)));
+        CHECK(deque.size() == deque.capacity());
+
+        deque.push(deque[0]);
+        CHECK(deque.size() == 9 && deque[8] == std::string(32, 'a') && deque[0] == std::string(32, 'a'));
+
+        while (deque.size() != deque.capacity())
+            deque.push(std::string(32, 'z'));
+        deque.unshift(deque.back());
+        CHECK(deque[0] == std::string(32, 'z') && deque.back() == std::string(32, 'z'));
+        CHECK(deque[1] == std::string(32, 'a') && deque[2] == std::string(32, 'b'));
+
+        while (deque.size() != deque.capacity())
+            deque.push(std::string(32, 'y'));
+        deque.push(std::move(deque[1]));
+        CHECK(deque.back() == std::string(32, 'a'));
+    }
+}
+
+int main()
+{
+    shiftAndUnshiftAreQueueOperations();
+    wrappedElementsKeepTheirOrder();
+    methodsIterateBothSpans();
+    growthKeepsOrder();
+    sortLinearizesTheRing();
+    pushingOwnElementWhileFull();
+    return 0;
+}
@@ -0,0 +1,33 @@
+#include "check.h"
+#include "jsArray.h"
+
+// a program that only includes jsArray.h: no thread pool compiled in, and the plain methods that can go
+// parallel (toUnique on huge inputs) run on the calling thread
+
+#if defined(__GLIBCXX__) && (defined(_GLIBCXX_THREAD) || defined(_GLIBCXX_CONDITION_VARIABLE) || defined(_GLIBCXX_FSTREAM))
+#error "jsArray.h pulled in the thread pool, see jsArrayParallel.h"
+#endif
+
+int main()
+{
+    CHECK(dynamic_cast<JSInlineExecutor*>(&JSExecutor::current()) != nullptr);
+
+    {
+        JSArray<int> values(std::size_t{1} << 22);
+        for (std::size_t i = 0; i < values.size(); i += 1)
+            values[i] = static_cast<int>(i % 1000);
+
+        const JSArray<int> distinct = values.toUnique();
+        CHECK(distinct.size() == 1000);
+        for (std::size_t i = 0; i < distinct.size(); i += 1)
+            CHECK(distinct[i] == static_cast<int>(i));
+    }
+
+    // an installed executor still wins, nullptr goes back to the calling thread
+    JSInlineExecutor executor;
+    JSExecutor::setCurrent(&executor);
+    CHECK(&JSExecutor::current() == &executor);
+    JSExecutor::setCurrent(nullptr);
+    CHECK(dynamic_cast<JSInlineExecutor*>(&JSExecutor::current()) != nullptr);
+    return 0;
+}
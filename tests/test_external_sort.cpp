@@ -0,0 +1,77 @@
+#include "check.h"
+#include "jsMappedArray.h"
+
+#include <csignal>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <sys/resource.h>
+
+namespace
+{
+    const std::size_t elementCount = 600000;
+    const std::size_t memoryBudget = std::size_t(1) << 20;
+
+    // sorts fine, the runs are spilled and merged back
+    void sortsThroughSpills(const MappedJSArray<int>& input)
+    {
+        std::size_t seen = 0;
+        int previous = -1;
+        input.forEachSorted([&](const int& value, std::size_t i)
+        {
+            CHECK(i == seen && value >= previous);
+            previous = value;
+            seen += 1;
+        }, [](const int& a, const int& b){return a < b;}, memoryBudget);
+        CHECK(seen == elementCount);
+    }
+
+    // a spill write past RLIMIT_FSIZE fails with EFBIG, which has to come out of forEachSorted as a system_error
+    void failedSpillWriteThrows(const MappedJSArray<int>& input)
+    {
+        std::signal(SIGXFSZ, SIG_IGN);
+        rlimit previous{};
+        CHECK(::getrlimit(RLIMIT_FSIZE, &previous) == 0);
+        rlimit capped = previous;
+        capped.rlim_cur = 64 * 1024;
+        CHECK(::setrlimit(RLIMIT_FSIZE, &capped) == 0);
+
+        CHECK_THROWS(std::system_error, input.forEachSorted([](const int&){}, [](const int& a, const int& b){return a < b;}, memoryBudget));
+
+        CHECK(::setrlimit(RLIMIT_FSIZE, &previous) == 0);
+    }
+
+    // the callback runs inside the merge, what it throws reaches the caller, whether or not the runs were spilled
+    void throwingCallbackPropagates(const MappedJSArray<int>& input)
+    {
+        for (const std::size_t budget : {memoryBudget, elementCount * sizeof(int) * 2})
+        {
+            std::size_t calls = 0;
+            CHECK_THROWS(std::runtime_error, input.forEachSorted([&](const int&)
+            {
+                calls += 1;
+                if (calls == 1000)
+                    throw std::runtime_error("stop");
+            }, [](const int& a, const int& b){return a < b;}, budget));
+            CHECK(calls == 1000);
+        }
+    }
+}
+
+int main()
+{
+    const std::string path = JSMmapAllocator<int>::directory() + "/jsarray-test-external-sort.bin";
+    {
+        auto input = MappedJSArray<int>::create(path);
+        for (std::size_t i = 0; i < elementCount; i += 1)
+            input.push(static_cast<int>((i * 7919) % 100003));
+
+        sortsThroughSpills(input);
+        failedSpillWriteThrows(input);
+        throwingCallbackPropagates(input);
+    }
+
+    std::remove(path.c_str());
+    return 0;
+}
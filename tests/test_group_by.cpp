@@ -0,0 +1,133 @@
+#include "check.h"
+#include "jsArrayParallel.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // what Object.groupBy does, keys in order of first appearance
+    template<typename Key, typename KeyOf>
+    void referenceGroups(const JSArray<int>& values, KeyOf keyOf, std::vector<Key>& keys, std::vector<std::vector<int>>& groups)
+    {
+        std::map<Key, std::size_t> ids;
+        for (const int value : values)
+        {
+            const Key key = keyOf(value);
+            const auto [it, inserted] = ids.emplace(key, keys.size());
+            if (inserted)
+            {
+                keys.push_back(key);
+                groups.emplace_back();
+            }
+            groups[it->second].push_back(value);
+        }
+    }
+
+    template<typename Key, typename Groups>
+    void checkGroups(const Groups& result, const std::vector<Key>& keys, const std::vector<std::vector<int>>& groups)
+    {
+        CHECK(result.size() == keys.size() && result.offsets.size() == keys.size() + 1);
+        for (std::size_t g = 0; g < keys.size(); g += 1)
+        {
+            CHECK(result.keys[g] == keys[g] && result.groupSize(g) == groups[g].size());
+            CHECK(std::vector<int>(result.groupBegin(g), result.groupEnd(g)) == groups[g]);
+        }
+    }
+
+    template<typename Key, typename Counts>
+    void checkCounts(const Counts& result, const std::vector<Key>& keys, const std::vector<std::vector<int>>& groups)
+    {
+        CHECK(result.size() == keys.size());
+        for (std::size_t g = 0; g < keys.size(); g += 1)
+            CHECK(result.keys[g] == keys[g] && result.counts[g] == groups[g].size());
+    }
+
+    JSArray<int> values(std::size_t n)
+    {
+        JSArray<int> result;
+        for (std::size_t i = 0; i < n; i += 1)
+            result.push_back(static_cast<int>((i * 7919 + i / 3) % 100003));
+        return result;
+    }
+
+    void smallGroups()
+    {
+        const JSArray<int> numbers{5, 3, 8, 3, 1, 5, 5};
+        const auto groups = numbers.groupBy([](int v){return v % 2 == 0 ? std::string("even") : std::string("odd");});
+        CHECK(groups.size() == 2 && groups.keys[0] == "odd" && groups.keys[1] == "even");
+        CHECK(groups.group(0) == (JSArray<int>{5, 3, 3, 1, 5, 5}) && groups.group(1) == JSArray<int>{8});
+
+        const auto counts = numbers.countBy([](int v, std::size_t i){return v + static_cast<int>(i) * 0;});
+        CHECK(counts.size() == 4 && counts.keys[0] == 5 && counts.counts[0] == 3 && counts.keys[3] == 1 && counts.counts[3] == 1);
+
+        const auto empty = JSArray<int>().groupBy([](int v){return v;});
+        CHECK(empty.size() == 0 && empty.offsets.size() == 1);
+    }
+
+    // many keys, few keys and bool keys, serial and parallel give the same first appearance order
+    void parallelMatchesSerial()
+    {
+        const JSArray<int> numbers = values(200000);
+
+        auto manyKeys = [](int v){return v % 5003;};
+        std::vector<int> keys;
+        std::vector<std::vector<int>> groups;
+        referenceGroups<int>(numbers, manyKeys, keys, groups);
+        checkGroups(numbers.groupBy(manyKeys), keys, groups);
+        checkGroups(numbers.groupByParallel(manyKeys), keys, groups);
+        checkCounts(numbers.countBy(manyKeys), keys, groups);
+        checkCounts(numbers.countByParallel(manyKeys), keys, groups);
+
+        auto textKeys = [](int v){return std::to_string(v % 7);};
+        std::vector<std::string> textKeyOrder;
+        std::vector<std::vector<int>> textGroups;
+        referenceGroups<std::string>(numbers, textKeys, textKeyOrder, textGroups);
+        checkGroups(numbers.groupByParallel(textKeys), textKeyOrder, textGroups);
+
+        auto boolKeys = [](int v){return v % 3 == 0;};
+        std::vector<bool> boolKeyOrder;
+        std::vector<std::vector<int>> boolGroups;
+        referenceGroups<bool>(numbers, boolKeys, boolKeyOrder, boolGroups);
+        checkCounts(numbers.countByParallel(boolKeys), boolKeyOrder, boolGroups);
+    }
+
+    // group ids are dense and numbered by first appearance whatever partition a key hashed to
+    void groupInParallelNumbersByFirstAppearance()
+    {
+        for (const std::size_t n : {0u, 3u, 1000u, 50000u})
+        {
+            const JSArray<int> numbers = values(n);
+            const auto groups = jsDetail::groupInParallel<int>(n, 4, [&](std::size_t i){return numbers[i] % 97;});
+
+            std::map<int, std::size_t> firstId;
+            for (std::size_t i = 0; i < n; i += 1)
+            {
+                const auto [it, inserted] = firstId.emplace(numbers[i] % 97, firstId.size());
+                CHECK(groups.groupOf[i] == it->second && groups.keys[it->second] == numbers[i] % 97);
+                (void)inserted;
+            }
+
+            CHECK(groups.keys.size() == firstId.size());
+            std::size_t total = 0;
+            for (const std::size_t count : groups.counts)
+                total += count;
+            CHECK(total == n);
+        }
+    }
+}
+
+int main()
+{
+    // this machine may have a single core, the parallel paths need more than one thread to be taken
+    JSThreadPool pool(4);
+    JSExecutor::setCurrent(&pool);
+
+    smallGroups();
+    parallelMatchesSerial();
+    groupInParallelNumbersByFirstAppearance();
+
+    JSExecutor::setCurrent(nullptr);
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "check.h"
+#include "jsArrayParallel.h"
+
+#include <string>
+#include <vector>
+
+#if !defined(JSARRAY_INSTRUMENTATION)
+#error "test_instrumentation must be built with JSARRAY_INSTRUMENTATION"
+#endif
+
+namespace
+{
+    const JSMethodStats* find(const std::vector<JSMethodStats>& stats, const std::string& method, const std::string& site = "")
+    {
+        for (const JSMethodStats& entry : stats)
+        {
+            if (entry.method == method && entry.site == site)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    void callsElementsAndResults()
+    {
+        JSInstrumentation::registry().reset();
+        const JSArray<int> values{1, 2, 3};
+        const JSArray<int> doubled = values.map([](int x){return x * 2;});
+        const JSArray<int> again = values.map([](int x){return x * 2;});
+        const JSArray<int> kept = values.filter([](int x){return x > 1;});
+        CHECK(doubled == again && kept.size() == 2);
+
+        const std::vector<JSMethodStats> stats = JSInstrumentation::registry().snapshot();
+        const JSMethodStats* map = find(stats, "map");
+        CHECK(map != nullptr && map->calls == 2 && map->elements == 6);
+        // each map allocates its 3 ints in one go
+        CHECK(map->bytesAllocated == 2 * 3 * sizeof(int) && map->reallocations == 0);
+        const JSMethodStats* filter = find(stats, "filter");
+        CHECK(filter != nullptr && filter->calls == 1 && filter->elements == 3);
+        CHECK(filter->bytesAllocated == 2 * sizeof(int) && filter->reallocations == 0);
+        CHECK(find(stats, "reduce") == nullptr);
+    }
+
+    void growthInsideACallIsCounted()
+    {
+        JSInstrumentation::registry().reset();
+        JSArray<int> values{1, 2, 3};
+        JSArray<int> out;
+        // 300 push_backs: capacities 1, 2, 4 ... 512, ten allocations and nine of them reallocations
+        values.forEach([&](int x)
+        {
+            for (int i = 0; i < 100; i += 1)
+            {
+                out.push_back(x);
+            }
+        });
+
+        // growth outside any instrumented method isn't recorded
+        out.push_back(0);
+        const std::vector<JSMethodStats> stats = JSInstrumentation::registry().snapshot();
+        const JSMethodStats* forEach = find(stats, "forEach");
+        CHECK(forEach != nullptr && forEach->calls == 1);
+        CHECK(forEach->bytesAllocated == (1 + 2 + 4 + 8 + 16 + 32 + 64 + 128 + 256 + 512) * sizeof(int));
+        CHECK(forEach->reallocations == 9);
+        CHECK(stats.size() == 1);
+    }
+
+    void nestedCallsCountAsTheOuterOne()
+    {
+        JSInstrumentation::registry().reset();
+        JSArray<int> values{3, 1, 2};
+        // small arrays: sortParallel falls back to sort, which isn't recorded on its own
+        values.sortParallel();
+        values.forEach([&](int){ values.toSorted(); });
+        const std::vector<JSMethodStats> stats = JSInstrumentation::registry().snapshot();
+        CHECK(stats.size() == 2);
+        CHECK(find(stats, "sortParallel") != nullptr && find(stats, "sort") == nullptr);
+        CHECK(find(stats, "forEach") != nullptr && find(stats, "toSorted") == nullptr);
+    }
+
+    void tagsKeepCallSitesApart()
+    {
+        JSInstrumentation::registry().reset();
+        const JSArray<int> values{1, 2};
+        values.map([](int x){return x;});
+        {
+            JSCallSiteTag outer("ingest");
+            values.map([](int x){return x;});
+            {
+                JSCallSiteTag inner("ingest \"hot\" loop");
+                values.map([](int x){return x;});
+            }
+            values.map([](int x){return x;});
+        }
+        values.map([](int x){return x;});
+
+        const std::vector<JSMethodStats> stats = JSInstrumentation::registry().snapshot();
+        CHECK(stats.size() == 3);
+        CHECK(find(stats, "map")->calls == 2);
+        CHECK(find(stats, "map", "ingest")->calls == 2);
+        CHECK(find(stats, "map", "ingest \"hot\" loop")->calls == 1);
+
+        const std::string json = JSInstrumentation::registry().toJSON();
+        CHECK(json.rfind("{\"methods\":[{\"method\":\"map\",\"site\":\"\",\"calls\":2,\"elements\":4,\"nanos\":", 0) == 0);
+        CHECK(json.find("\"site\":\"ingest \\\"hot\\\" loop\",\"calls\":1,\"elements\":2,") != std::string::npos);
+
+        const std::string prometheus = JSInstrumentation::registry().toPrometheus();
+        CHECK(prometheus.find("# TYPE jsarray_calls_total counter\n") == 0);
+        CHECK(prometheus.find("jsarray_calls_total{method=\"map\",site=\"ingest\"} 2\n") != std::string::npos);
+        CHECK(prometheus.find("jsarray_elements_total{method=\"map\",site=\"ingest \\\"hot\\\" loop\"} 2\n") != std::string::npos);
+        CHECK(prometheus.find("jsarray_reallocations_total{method=\"map\",site=\"\"} 0\n") != std::string::npos);
+
+        JSInstrumentation::registry().reset();
+        CHECK(JSInstrumentation::registry().snapshot().empty());
+        CHECK(JSInstrumentation::registry().toJSON() == "{\"methods\":[]}");
+    }
+}
+
+int main()
+{
+    callsElementsAndResults();
+    growthInsideACallIsCounted();
+    nestedCallsCountAsTheOuterOne();
+    tagsKeepCallSitesApart();
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "check.h"
+#include "jsArray.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    void stringLikeElements()
+    {
+        CHECK((JSArray<std::string>{"a", "bc", "", "d"}).join() == "a,bc,,d");
+        CHECK((JSArray<std::string>{"a", "bc", "d"}).join(" - ") == "a - bc - d");
+        CHECK((JSArray<std::string>{"only"}).join(", ") == "only");
+        CHECK((JSArray<std::string>{"x", "y"}).join("") == "xy");
+        CHECK(JSArray<std::string>().join() == "");
+
+        CHECK((JSArray<std::string_view>{"left", "right"}).join("|") == "left|right");
+        CHECK((JSArray<const char*>{"c", "str"}).join() == "c,str");
+        CHECK((JSArray<char>{'a', 'b', 'c'}).join("") == "abc");
+        CHECK((JSArray<bool>{true, false, true}).join() == "true,false,true");
+    }
+
+    void integers()
+    {
+        CHECK((JSArray<int>{1, -20, 300, 0}).join() == "1,-20,300,0");
+        CHECK((JSArray<std::int64_t>{std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max()}).join(" ")
+              == "-9223372036854775808 9223372036854775807");
+        CHECK((JSArray<std::uint64_t>{std::numeric_limits<std::uint64_t>::max()}).join() == "18446744073709551615");
+        CHECK((JSArray<unsigned char>{7, 255}).join() == "7,255");
+    }
+
+    void doublesPrintLikeJavascript()
+    {
+        // expected strings from node: [...].join(",")
+        const double inf = std::numeric_limits<double>::infinity();
+        const JSArray<double> values{
+            0.1, 1e21, 1e-7, 123456789012, 1.5e300, 0.000001, -0.0, std::numeric_limits<double>::quiet_NaN(), inf, -inf,
+            100, 1e20, 9007199254740992.0, -2.5e-8, 5e-324, 1.7976931348623157e308, 123.456, 1.0 / 3
+        };
+        CHECK(values.join() ==
+              "0.1,1e+21,1e-7,123456789012,1.5e+300,0.000001,0,NaN,Infinity,-Infinity,100,100000000000000000000,"
+              "9007199254740992,-2.5e-8,5e-324,1.7976931348623157e+308,123.456,0.3333333333333333");
+        CHECK((JSArray<float>{0.5f, 2.0f}).join(";") == "0.5;2");
+    }
+}
+
+int main()
+{
+    stringLikeElements();
+    integers();
+    doublesPrintLikeJavascript();
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "check.h"
+#include "jsMappedArray.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+    const std::string directory = JSMmapAllocator<int>::directory();
+
+    std::vector<char> fileBytes(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void methodsSeeTheFileElements(const std::string& path)
+    {
+        auto values = MappedJSArray<int>::create(path);
+        CHECK(values.empty());
+        for (int i = 0; i < 5000; i += 1)
+        {
+            CHECK(values.push(i % 100) == static_cast<std::size_t>(i) + 1);
+        }
+
+        CHECK(values.size() == 5000 && values.capacity() >= 5000);
+        CHECK(values.map([](int x){return x * 2;}) == JSArray<int>::from(values).map([](int x){return x * 2;}));
+        CHECK(values.reduce([](long sum, int x){return sum + x;}, 0L) == 50L * 99 * 50);
+        CHECK(values.every([](int x){return x < 100;}) && !values.every([](int x){return x < 99;}));
+        CHECK(values.some([](int x, std::size_t i){return x == 42 && i == 42;}) && !values.some([](int x){return x < 0;}));
+
+        // the result is sized from the count of kept elements, never regrown
+        const JSArray<int> kept = values.filter([](int x){return x % 10 == 0;});
+        CHECK(kept.size() == 500 && kept.capacity() == kept.size());
+        CHECK(kept.every([](int x){return x % 10 == 0;}));
+        const JSArray<int, JSMmapAllocator> keptInFile = values.filter<JSMmapAllocator>([](int x){return x < 50;});
+        CHECK(keptInFile.size() == 2500 && keptInFile.capacity() == keptInFile.size());
+
+        // the callbacks aren't noexcept: what they throw reaches the caller
+        CHECK_THROWS(std::runtime_error, values.map([](int x){if (x == 99) throw std::runtime_error("stop"); return x;}));
+        CHECK_THROWS(std::runtime_error, values.filter([](int x){if (x == 99) throw std::runtime_error("stop"); return true;}));
+
+        values.sort([](int a, int b){return a > b;});
+        CHECK(values[0] == 99 && values[4999] == 0);
+        CHECK(values.pop() == 0 && values.size() == 4999);
+        values.resize(6000);
+        CHECK(values[5999] == 0 && values[4998] == 0 && values[0] == 99);
+        values.resize(3);
+    }
+
+    void reopenSeesWhatWasWritten(const std::string& path)
+    {
+        {
+            auto values = MappedJSArray<int>::open(path);
+            CHECK(values.size() == 3 && values[0] == 99 && values[1] == 99 && values[2] == 99);
+            values[1] = 7;
+            values.push(8);
+        }
+
+        auto values = MappedJSArray<int>::open(path);
+        CHECK(values.size() == 4 && values[1] == 7 && values[3] == 8);
+
+        // once closed the file is exactly a serialized array
+        values = MappedJSArray<int>::create(path + ".other");
+        const std::vector<char> bytes = fileBytes(path);
+        CHECK(JSArray<int>::deserialize(bytes.data(), bytes.size()) == (JSArray<int>{99, 7, 99, 8}));
+        std::remove((path + ".other").c_str());
+    }
+
+    void brokenFilesAreRejected(const std::string& path)
+    {
+        {
+            auto values = MappedJSArray<double>::create(path);
+            for (int i = 0; i < 100; i += 1)
+            {
+                values.push(i * 0.5);
+            }
+        }
+
+        // right file, wrong element type
+        CHECK_THROWS(std::system_error, MappedJSArray<std::int64_t>::open(path));
+        CHECK_THROWS(std::system_error, MappedJSArray<float>::open(path));
+
+        // the header claims more elements than the file holds
+        const std::vector<char> bytes = fileBytes(path);
+        {
+            std::ofstream truncated(path, std::ios::binary | std::ios::trunc);
+            truncated.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 16));
+        }
+        CHECK_THROWS(std::system_error, MappedJSArray<double>::open(path));
+
+        // shorter than a header
+        {
+            std::ofstream tiny(path, std::ios::binary | std::ios::trunc);
+            tiny.write(bytes.data(), 10);
+        }
+        CHECK_THROWS(std::system_error, MappedJSArray<double>::open(path));
+
+        // a rejected file is left as it was
+        CHECK(fileBytes(path).size() == 10);
+        CHECK_THROWS(std::system_error, MappedJSArray<double>::open(path + ".missing"));
+    }
+}
+
+int main()
+{
+    const std::string path = directory + "/jsarray-test-mapped-array.bin";
+    methodsSeeTheFileElements(path);
+    reopenSeesWhatWasWritten(path);
+    brokenFilesAreRejected(path);
+    std::remove(path.c_str());
+    return 0;
+}
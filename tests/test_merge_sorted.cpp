@@ -0,0 +1,94 @@
+#include "check.h"
+#include "jsArrayParallel.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // key compared, origin only there to check stability
+    struct Item
+    {
+        int key;
+        int origin;
+        bool operator==(const Item& other) const noexcept { return key == other.key && origin == other.origin; }
+    };
+
+    const auto byKey = [](const Item& a, const Item& b){return a.key < b.key;};
+
+    std::vector<JSArray<Item>> randomRuns(std::size_t runCount, std::size_t maxLength, std::mt19937& random)
+    {
+        std::uniform_int_distribution<std::size_t> length(0, maxLength);
+        std::uniform_int_distribution<int> key(0, 50);
+        std::vector<JSArray<Item>> runs(runCount);
+        for (std::size_t r = 0; r < runCount; r += 1)
+        {
+            const std::size_t n = length(random);
+            for (std::size_t i = 0; i < n; i += 1)
+            {
+                runs[r].push_back({key(random), static_cast<int>(r)});
+            }
+            std::stable_sort(runs[r].begin(), runs[r].end(), byKey);
+        }
+        return runs;
+    }
+
+    // concatenating and stable sorting gives the one stable merge
+    JSArray<Item> expectedMerge(const std::vector<JSArray<Item>>& runs)
+    {
+        JSArray<Item> all;
+        for (const JSArray<Item>& run : runs)
+        {
+            all.insert(all.end(), run.begin(), run.end());
+        }
+        std::stable_sort(all.begin(), all.end(), byKey);
+        return all;
+    }
+
+    void mergeIsStableForAnyNumberOfArrays()
+    {
+        std::mt19937 random(31);
+        // direct head comparison up to 4 arrays, loser tree above
+        for (const std::size_t runCount : {1, 2, 3, 4, 5, 8, 17})
+        {
+            const std::vector<JSArray<Item>> runs = randomRuns(runCount, 200, random);
+            CHECK(JSArray<Item>::mergeSorted(runs, byKey) == expectedMerge(runs));
+        }
+
+        const std::array<JSArray<int>, 3> numbers{JSArray<int>{5, 6}, JSArray<int>{}, JSArray<int>{1, 7}};
+        CHECK(JSArray<int>::mergeSorted(numbers) == (JSArray<int>{1, 5, 6, 7}));
+    }
+
+    void parallelMergeMatchesTheSequentialOne()
+    {
+        JSThreadPool pool(4);
+        JSExecutor::setCurrent(&pool);
+        std::mt19937 random(32);
+        for (const std::size_t runCount : {1, 2, 3, 6, 17})
+        {
+            const std::vector<JSArray<Item>> runs = randomRuns(runCount, 200000 / runCount, random);
+            CHECK(JSArray<Item>::mergeSortedParallel(runs, byKey) == expectedMerge(runs));
+        }
+
+        std::vector<JSArray<int>> numbers(5);
+        for (std::size_t i = 0; i < 100000; i += 1)
+        {
+            numbers[i % 5].push_back(static_cast<int>(i));
+        }
+        const JSArray<int> merged = JSArray<int>::mergeSortedParallel(numbers);
+        CHECK(merged.size() == 100000 && merged.isSorted());
+        CHECK(std::is_sorted(std::as_const(merged).begin(), std::as_const(merged).end()) && merged.front() == 0 && merged.back() == 99999);
+        CHECK(JSArray<int>::mergeSortedParallel(std::vector<JSArray<int>>(3)).empty());
+        JSExecutor::setCurrent(nullptr);
+    }
+}
+
+int main()
+{
+    mergeIsStableForAnyNumberOfArrays();
+    parallelMergeMatchesTheSequentialOne();
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "check.h"
+#include "jsArrayParallel.h"
+#include "jsNuma.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    /**
+     * hands out ranges the way a JSThreadPool with Affinity::NodeLocal does (part w of an even split, no
+     * shorter than grain, to worker w) but only runs the part of one worker, so a test can see what it did
+     */
+    class OneWorkerExecutor final : public JSExecutor
+    {
+    public:
+        std::size_t workers;
+        std::size_t worker;
+
+        OneWorkerExecutor(std::size_t workerCount, std::size_t selected) noexcept : workers(workerCount), worker(selected) {}
+
+        inline std::size_t concurrency() const noexcept override { return workers; }
+
+        inline void parallelFor(std::size_t n, std::size_t grain, JSRangeFunction body) noexcept override
+        {
+            grain = std::max<std::size_t>(grain, 1);
+            const std::size_t parts = std::min(workers, (n + grain - 1) / grain);
+            if (worker < parts && n * worker / parts < n * (worker + 1) / parts)
+                body(n * worker / parts, n * (worker + 1) / parts);
+        }
+    };
+
+    // worker w first touches exactly the pages that start inside the elements the parallel methods give it
+    void pagesFollowTheParallelSplit()
+    {
+        const std::size_t page = jsDetail::pageBytes();
+        // element sizes of a page, half a page and two pages, counts that don't divide evenly
+        for (const std::size_t elementSize : {page, page / 2, page * 2})
+        {
+            // (a single element is touched on the calling thread, there's nothing to split)
+            for (const std::size_t count : {2, 3, 9, 10, 37})
+            {
+                const std::size_t bytes = count * elementSize;
+                const std::size_t pageCount = (bytes + page - 1) / page;
+                void* memory = std::aligned_alloc(page, pageCount * page);
+                const std::size_t workers = 4;
+                std::vector<std::size_t> owners(pageCount, workers);
+                for (std::size_t w = 0; w < workers; w += 1)
+                {
+                    std::memset(memory, 0xff, pageCount * page);
+                    OneWorkerExecutor executor(workers, w);
+                    JSExecutor::setCurrent(&executor);
+                    jsDetail::firstTouch(memory, count, elementSize);
+                    JSExecutor::setCurrent(nullptr);
+
+                    const std::size_t tasks = std::min(workers, count);
+                    const auto [begin, end] = jsDetail::taskRange(count, tasks, w);
+                    for (std::size_t p = 0; p < pageCount; p += 1)
+                    {
+                        const bool touched = static_cast<const unsigned char*>(memory)[p * page] == 0;
+                        const bool expected = w < tasks && p * page >= begin * elementSize && p * page < end * elementSize;
+                        CHECK(touched == expected);
+                        if (touched)
+                        {
+                            CHECK(owners[p] == workers);
+                            owners[p] = w;
+                        }
+                    }
+                }
+
+                // and every page is touched by someone
+                for (const std::size_t owner : owners)
+                {
+                    CHECK(owner < workers);
+                }
+                std::free(memory);
+            }
+        }
+    }
+
+    void arraysWorkOnTheAllocator()
+    {
+        JSThreadPool pool(3);
+        JSExecutor::setCurrent(&pool);
+        // above smallAllocationBytes: mapped and first touched in parallel
+        JSArray<double, JSNumaAllocator> values(std::size_t{1} << 18, 1.5);
+        CHECK(values.reduce([](double sum, double x){return sum + x;}, 0.0) == 1.5 * (1 << 18));
+        const JSArray<double, JSNumaAllocator> doubled = values.mapParallel([](double x){return x * 2;});
+        CHECK(doubled.size() == values.size() && doubled[12345] == 3.0);
+        JSArray<int, JSNumaAllocator> small{1, 2, 3};
+        CHECK(small.map([](int x){return x + 1;}) == (JSArray<int, JSNumaAllocator>{2, 3, 4}));
+        JSExecutor::setCurrent(nullptr);
+    }
+}
+
+int main()
+{
+    pagesFollowTheParallelSplit();
+    arraysWorkOnTheAllocator();
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include "check.h"
+#include "jsArraySerialize.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Point
+    {
+        float x;
+        float y;
+        std::int32_t id;
+        bool operator==(const Point& other) const noexcept { return x == other.x && y == other.y && id == other.id; }
+    };
+
+    template<typename T>
+    std::vector<unsigned char> bytesOf(const JSArray<T>& array)
+    {
+        std::vector<unsigned char> bytes;
+        array.serialize([&](const void* data, std::size_t size)
+        {
+            const unsigned char* first = static_cast<const unsigned char*>(data);
+            bytes.insert(bytes.end(), first, first + size);
+        });
+        CHECK(bytes.size() == array.serializedSize());
+        CHECK(bytes.size() % 8 == 0);
+        return bytes;
+    }
+
+    template<typename T>
+    void checkRoundTrip(const JSArray<T>& array)
+    {
+        const std::vector<unsigned char> bytes = bytesOf(array);
+        const std::optional<JSArray<T>> copy = JSArray<T>::deserialize(bytes.data(), bytes.size());
+        CHECK(copy.has_value() && *copy == array);
+
+        // every shorter prefix is a truncated buffer
+        for (std::size_t size = 0; size < bytes.size(); size += 1)
+        {
+            CHECK(!JSArray<T>::deserialize(bytes.data(), size).has_value());
+        }
+    }
+
+    void roundTrips()
+    {
+        checkRoundTrip(JSArray<int>{});
+        checkRoundTrip(JSArray<int>{1, -2, 3});
+        checkRoundTrip(JSArray<double>{0.5, -1e300, 3.25});
+        checkRoundTrip(JSArray<char>{'a', 'b', 'c'});
+        checkRoundTrip(JSArray<bool>{true, false, false, true, true});
+        checkRoundTrip(JSArray<std::uint16_t>{1, 65535});
+        checkRoundTrip(JSArray<Point>{{1.0f, 2.0f, 7}, {-3.5f, 0.0f, 8}});
+        checkRoundTrip(JSArray<std::string>{"", "hello", std::string(1000, 'x'), std::string("nul\0inside", 10)});
+        checkRoundTrip(JSArray<JSArray<std::string>>{{"a", "b"}, {}, {"c"}});
+        checkRoundTrip(JSArray<JSArray<double>>{{1.5}, {}, {2.5, 3.5}});
+
+        // large enough to write the bools in several chunks
+        JSArray<bool> flags;
+        for (std::size_t i = 0; i < 1000; i += 1)
+        {
+            flags.push_back(i % 3 == 0);
+        }
+        const std::vector<unsigned char> bytes = bytesOf(flags);
+        CHECK(JSArray<bool>::deserialize(bytes.data(), bytes.size()) == flags);
+    }
+
+    void corruptHeadersAreRejected()
+    {
+        const JSArray<std::int32_t> numbers{10, 20, 30, 40};
+        const std::vector<unsigned char> bytes = bytesOf(numbers);
+        jsDetail::SerialHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        const auto withHeader = [&](auto change)
+        {
+            jsDetail::SerialHeader changed = header;
+            change(changed);
+            std::vector<unsigned char> corrupt = bytes;
+            std::memcpy(corrupt.data(), &changed, sizeof(changed));
+            return corrupt;
+        };
+        const auto rejected = [](const std::vector<unsigned char>& corrupt)
+        {
+            return !JSArray<std::int32_t>::deserialize(corrupt.data(), corrupt.size()).has_value()
+                && !JSArrayView<std::int32_t>::fromBuffer(corrupt.data(), corrupt.size()).has_value();
+        };
+
+        CHECK(rejected(withHeader([](jsDetail::SerialHeader& h){h.magic ^= 1;})));
+        CHECK(rejected(withHeader([](jsDetail::SerialHeader& h){h.version += 1;})));
+        CHECK(rejected(withHeader([](jsDetail::SerialHeader& h){h.type = static_cast<std::uint16_t>(jsDetail::SerialType::Float32);})));
+        CHECK(rejected(withHeader([](jsDetail::SerialHeader& h){h.elementSize = 8;})));
+        CHECK(rejected(withHeader([](jsDetail::SerialHeader& h){h.alignment = 3;})));
+        CHECK(rejected(withHeader([](jsDetail::SerialHeader& h){h.alignment = 0;})));
+        CHECK(rejected(withHeader([](jsDetail::SerialHeader& h){h.count += 1;})));
+        CHECK(rejected(withHeader([](jsDetail::SerialHeader& h){h.payloadBytes += 4; h.count += 1;})));
+        CHECK(rejected(withHeader([](jsDetail::SerialHeader& h){h.payloadBytes = ~std::uint64_t{0};})));
+
+        // same size, other type
+        CHECK(!JSArray<std::uint32_t>::deserialize(bytes.data(), bytes.size()).has_value());
+        CHECK(!JSArray<float>::deserialize(bytes.data(), bytes.size()).has_value());
+        CHECK(!JSArray<std::string>::deserialize(bytes.data(), bytes.size()).has_value());
+
+        // a string length running past the payload
+        const JSArray<std::string> words{"abc", "de"};
+        std::vector<unsigned char> wordBytes = bytesOf(words);
+        const std::uint64_t hugeLength = 1u << 20;
+        std::memcpy(wordBytes.data() + sizeof(jsDetail::SerialHeader), &hugeLength, sizeof(hugeLength));
+        CHECK(!JSArray<std::string>::deserialize(wordBytes.data(), wordBytes.size()).has_value());
+    }
+
+    void viewsReadInPlace()
+    {
+        const JSArray<double> values{1.5, 2.5, 3.5};
+        const std::vector<unsigned char> bytes = bytesOf(values);
+        const std::optional<JSArrayView<double>> view = JSArrayView<double>::fromBuffer(bytes.data(), bytes.size());
+        CHECK(view.has_value() && view->size() == 3 && (*view)[1] == 2.5);
+        CHECK(reinterpret_cast<const unsigned char*>(view->data()) == bytes.data() + sizeof(jsDetail::SerialHeader));
+        CHECK(view->toArray() == values);
+        CHECK(!JSArrayView<double>::fromBuffer(bytes.data(), bytes.size() - 9).has_value());
+        CHECK(!JSArrayView<float>::fromBuffer(bytes.data(), bytes.size()).has_value());
+
+        // the same bytes one byte off: the doubles aren't aligned, no view
+        std::vector<unsigned char> shifted(bytes.size() + 1);
+        std::memcpy(shifted.data() + 1, bytes.data(), bytes.size());
+        CHECK(!JSArrayView<double>::fromBuffer(shifted.data() + 1, bytes.size()).has_value());
+        CHECK(JSArray<double>::deserialize(shifted.data() + 1, bytes.size()) == values);
+
+        const JSArray<int> empty;
+        const std::vector<unsigned char> emptyBytes = bytesOf(empty);
+        const std::optional<JSArrayView<int>> emptyView = JSArrayView<int>::fromBuffer(emptyBytes.data(), emptyBytes.size());
+        CHECK(emptyView.has_value() && emptyView->empty());
+    }
+}
+
+int main()
+{
+    roundTrips();
+    corruptHeadersAreRejected();
+    viewsReadInPlace();
+    return 0;
+}
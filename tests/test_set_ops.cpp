@@ -0,0 +1,120 @@
+#include "check.h"
+#include "jsArray.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+
+namespace
+{
+    // no std::hash, only operator<: always merged from sorted copies
+    struct Version
+    {
+        int major;
+        int minor;
+        bool operator<(const Version& other) const noexcept { return major != other.major ? major < other.major : minor < other.minor; }
+        bool operator==(const Version& other) const noexcept { return major == other.major && minor == other.minor; }
+    };
+
+    template<typename T>
+    JSArray<T> sortedRandom(std::size_t n, int range, std::mt19937& random)
+    {
+        std::uniform_int_distribution<int> value(0, range);
+        JSArray<T> result;
+        for (std::size_t i = 0; i < n; i += 1)
+        {
+            result.push_back(static_cast<T>(value(random)));
+        }
+        return result.sort();
+    }
+
+    // what every set operation on sorted inputs must return: the distinct values, sorted
+    template<typename T, typename Algorithm>
+    JSArray<T> reference(const JSArray<T>& a, const JSArray<T>& b, Algorithm algorithm)
+    {
+        const std::set<T> setA(a.begin(), a.end());
+        const std::set<T> setB(b.begin(), b.end());
+        JSArray<T> result;
+        algorithm(setA.begin(), setA.end(), setB.begin(), setB.end(), std::back_inserter(result));
+        return result;
+    }
+
+    template<typename T>
+    void checkSortedAgainstReference(const JSArray<T>& a, const JSArray<T>& b)
+    {
+        using It = typename std::set<T>::const_iterator;
+        using Out = std::back_insert_iterator<JSArray<T>>;
+        CHECK(a.intersect(b) == reference(a, b, std::set_intersection<It, It, Out>));
+        CHECK(b.intersect(a) == reference(b, a, std::set_intersection<It, It, Out>));
+        CHECK(a.unionWith(b) == reference(a, b, std::set_union<It, It, Out>));
+        CHECK(a.difference(b) == reference(a, b, std::set_difference<It, It, Out>));
+        CHECK(b.difference(a) == reference(b, a, std::set_difference<It, It, Out>));
+        CHECK(a.symmetricDifference(b) == reference(a, b, std::set_symmetric_difference<It, It, Out>));
+    }
+
+    void sortedInputsAreMerged()
+    {
+        const JSArray<int> a{1, 2, 2, 3, 5, 8};
+        const JSArray<int> b{2, 3, 3, 4, 8, 9};
+        CHECK(a.intersect(b) == (JSArray<int>{2, 3, 8}));
+        CHECK(a.unionWith(b) == (JSArray<int>{1, 2, 3, 4, 5, 8, 9}));
+        CHECK(a.difference(b) == (JSArray<int>{1, 5}));
+        CHECK(a.symmetricDifference(b) == (JSArray<int>{1, 4, 5, 9}));
+
+        CHECK(a.intersect(JSArray<int>()).empty());
+        CHECK(a.unionWith(JSArray<int>()) == (JSArray<int>{1, 2, 3, 5, 8}));
+        CHECK(JSArray<int>().difference(a).empty());
+
+        std::mt19937 random(7);
+        // similar sizes: plain merge, and the 4 x 4 SSE2 blocks for 32 bit integers
+        for (int round = 0; round < 20; round += 1)
+        {
+            checkSortedAgainstReference(sortedRandom<std::int32_t>(300, 400, random), sortedRandom<std::int32_t>(257, 400, random));
+            checkSortedAgainstReference(sortedRandom<std::int64_t>(300, 400, random), sortedRandom<std::int64_t>(257, 400, random));
+        }
+
+        // more than gallopRatio times bigger: the small side gallops through the big one
+        for (int round = 0; round < 20; round += 1)
+        {
+            checkSortedAgainstReference(sortedRandom<std::int32_t>(10, 5000, random), sortedRandom<std::int32_t>(4000, 5000, random));
+            checkSortedAgainstReference(sortedRandom<double>(5, 100000, random), sortedRandom<double>(3000, 100000, random));
+        }
+    }
+
+    void unsortedInputsKeepTheOrderOfThisArray()
+    {
+        const JSArray<int> a{5, 1, 5, 3, 7, 1};
+        const JSArray<int> b{7, 2, 3, 3, 9};
+        CHECK(a.intersect(b) == (JSArray<int>{3, 7}));
+        CHECK(a.unionWith(b) == (JSArray<int>{5, 1, 3, 7, 2, 9}));
+        CHECK(a.difference(b) == (JSArray<int>{5, 1}));
+        CHECK(a.symmetricDifference(b) == (JSArray<int>{5, 1, 2, 9}));
+
+        const JSArray<std::string> words{"pear", "apple", "fig", "apple"};
+        const JSArray<std::string> others{"fig", "kiwi", "pear"};
+        CHECK(words.intersect(others) == (JSArray<std::string>{"pear", "fig"}));
+        CHECK(words.unionWith(others) == (JSArray<std::string>{"pear", "apple", "fig", "kiwi"}));
+        CHECK(words.difference(others) == (JSArray<std::string>{"apple"}));
+    }
+
+    void typesWithoutHashAreMergedFromSortedCopies()
+    {
+        const JSArray<Version> a{{2, 0}, {1, 4}, {1, 4}, {3, 1}};
+        const JSArray<Version> b{{3, 1}, {1, 0}, {2, 0}};
+        CHECK(a.intersect(b) == (JSArray<Version>{{2, 0}, {3, 1}}));
+        CHECK(a.unionWith(b) == (JSArray<Version>{{1, 0}, {1, 4}, {2, 0}, {3, 1}}));
+        CHECK(a.difference(b) == (JSArray<Version>{{1, 4}}));
+        CHECK(a.symmetricDifference(b) == (JSArray<Version>{{1, 0}, {1, 4}}));
+    }
+}
+
+int main()
+{
+    sortedInputsAreMerged();
+    unsortedInputsKeepTheOrderOfThisArray();
+    typesWithoutHashAreMergedFromSortedCopies();
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "check.h"
+#include "jsArraySoA.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    // no default constructor, so sort and filter can't build columns by resizing them
+    struct Label
+    {
+        std::string text;
+        explicit Label(std::string value) : text(std::move(value)) {}
+    };
+
+    // throws when copied while armed
+    struct Fragile
+    {
+        static inline bool armed = false;
+        int value;
+
+        explicit Fragile(int v) : value(v) {}
+        Fragile(const Fragile& other) : value(other.value)
+        {
+            if (armed)
+                throw std::runtime_error("copy");
+        }
+        Fragile(Fragile&&) noexcept = default;
+        Fragile& operator=(const Fragile&) = default;
+        Fragile& operator=(Fragile&&) noexcept = default;
+    };
+
+    using trades_t = JSArraySoA<double, int, Label>;
+
+    trades_t trades()
+    {
+        trades_t result;
+        result.push(3.5, 10, Label("c"));
+        result.push(1.25, 20, Label("a"));
+        result.push(2.0, 30, Label("b"));
+        result.push(5.0, 40, Label("e"));
+        result.push(4.0, 50, Label("d"));
+        return result;
+    }
+
+    void rowsAndColumns()
+    {
+        trades_t table = trades();
+        CHECK(table.size() == 5 && !table.empty());
+        CHECK(table.column<1>()[2] == 30);
+
+        auto [px, qty, label] = table.row(1);
+        CHECK(px == 1.25 && qty == 20 && label.text == "a");
+        qty = 21;
+        CHECK(table.column<1>()[1] == 21);
+
+        CHECK_THROWS(std::invalid_argument, (JSArraySoA<int, int>(JSArray<int>{1, 2}, JSArray<int>{1})));
+        const JSArraySoA<int, int> adopted(JSArray<int>{1, 2}, JSArray<int>{3, 4});
+        CHECK(adopted.size() == 2 && std::get<1>(adopted.row(1)) == 4);
+    }
+
+    void methodsWorkOnTheirColumns()
+    {
+        const trades_t table = trades();
+        const JSArray<double> doubled = table.map<0>([](double px){return px * 2;});
+        CHECK(doubled.size() == 5 && doubled[1] == 2.5);
+        const JSArray<double> notional = table.map<0, 1>([](double px, int qty){return px * qty;});
+        CHECK(notional[0] == 35.0 && notional[4] == 200.0);
+
+        CHECK(table.reduce<1>([](int sum, int qty){return sum + qty;}, 0) == 150);
+        CHECK(table.every<1>([](int qty){return qty % 10 == 0;}));
+        CHECK(table.some<0>([](double px){return px > 4.5;}));
+        CHECK(!table.some<0>([](double px){return px > 5.5;}));
+
+        const trades_t cheap = table.filter<0>([](double px){return px < 3.0;});
+        CHECK(cheap.size() == 2 && std::get<2>(cheap.row(0)).text == "a" && std::get<1>(cheap.row(1)) == 30);
+        const trades_t big = table.filter<0, 1>([](double px, int qty){return px * qty > 100;});
+        CHECK(big.size() == 2 && std::get<2>(big.row(0)).text == "e" && std::get<2>(big.row(1)).text == "d");
+    }
+
+    // every column follows the permutation of the key column
+    void sortMovesWholeRows()
+    {
+        trades_t table = trades();
+        table.sort<0>();
+        const char* labels[] = {"a", "b", "c", "d", "e"};
+        const int quantities[] = {20, 30, 10, 50, 40};
+        for (std::size_t i = 0; i < table.size(); i += 1)
+        {
+            const auto [px, qty, label] = table.row(i);
+            CHECK(label.text == labels[i] && qty == quantities[i]);
+            CHECK(i == 0 || std::get<0>(table.row(i - 1)) < px);
+        }
+
+        table.sort<1>([](int a, int b){return a > b;});
+        CHECK(std::get<1>(table.row(0)) == 50 && std::get<2>(table.row(0)).text == "d");
+        CHECK(std::get<1>(table.row(4)) == 10 && std::get<2>(table.row(4)).text == "c");
+
+        const trades_t byLabel = table.toSorted<2>([](const Label& a, const Label& b){return a.text < b.text;});
+        CHECK(std::get<0>(byLabel.row(0)) == 1.25 && std::get<0>(byLabel.row(4)) == 5.0);
+        CHECK(std::get<2>(table.row(0)).text == "d");
+
+        // a longer permutation with several cycles
+        JSArraySoA<int, int> numbers;
+        for (int i = 0; i < 1000; i += 1)
+            numbers.push((i * 7919) % 1000, i);
+        numbers.sort<0>();
+        for (std::size_t i = 0; i < numbers.size(); i += 1)
+        {
+            const auto [key, original] = numbers.row(i);
+            CHECK(key == static_cast<int>(i) && (original * 7919) % 1000 == key);
+        }
+    }
+
+    // a value that fails to copy into the second column leaves no half pushed row
+    void failedPushKeepsColumnsAligned()
+    {
+        JSArraySoA<int, Fragile> table;
+        const Fragile fragile(7);
+        table.push(1, fragile);
+        Fragile::armed = true;
+        CHECK_THROWS(std::runtime_error, table.push(2, fragile));
+        Fragile::armed = false;
+        CHECK(table.size() == 1 && table.column<0>().size() == 1 && table.column<1>().size() == 1);
+        CHECK(table.push(3, fragile) == 2 && std::get<0>(table.row(1)) == 3);
+    }
+}
+
+int main()
+{
+    rowsAndColumns();
+    methodsWorkOnTheirColumns();
+    sortMovesWholeRows();
+    failedPushKeepsColumnsAligned();
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "check.h"
+#include "jsArray.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace
+{
+    struct Player
+    {
+        std::string name;
+        std::int32_t score;
+        bool operator==(const Player& other) const noexcept { return name == other.name && score == other.score; }
+    };
+
+    JSArray<Player> randomPlayers(std::size_t n, int scoreRange, std::mt19937& random)
+    {
+        std::uniform_int_distribution<int> score(-scoreRange, scoreRange);
+        JSArray<Player> players;
+        for (std::size_t i = 0; i < n; i += 1)
+        {
+            players.push_back({"p" + std::to_string(i), score(random)});
+        }
+        return players;
+    }
+
+    // what sortBy must match: a stable sort comparing the keys
+    template<typename F>
+    JSArray<Player> stableSortedBy(JSArray<Player> players, F keyFn)
+    {
+        std::stable_sort(players.begin(), players.end(), [&](const Player& a, const Player& b){return keyFn(a) < keyFn(b);});
+        return players;
+    }
+
+    void integerKeysAreStable()
+    {
+        std::mt19937 random(21);
+        const auto byScore = [](const Player& p){return p.score;};
+        // below the radix threshold (comparison sort) and above it (radix sort), with lots of ties and negative keys
+        for (const std::size_t n : {0, 1, 50, 255, 256, 3000})
+        {
+            const JSArray<Player> players = randomPlayers(n, 20, random);
+            const JSArray<Player> expected = stableSortedBy(players, byScore);
+            CHECK(players.toSortedBy(byScore) == expected);
+
+            JSArray<Player> inPlace = players;
+            inPlace.sortBy(byScore);
+            CHECK(inPlace == expected);
+        }
+
+        // wide keys exercise every radix pass
+        const JSArray<Player> wide = randomPlayers(2000, 2000000000, random);
+        CHECK(wide.toSortedBy(byScore) == stableSortedBy(wide, byScore));
+        const auto byUnsigned = [](const Player& p){return static_cast<std::uint64_t>(p.score) * 2654435761u;};
+        CHECK(wide.toSortedBy(byUnsigned) == stableSortedBy(wide, byUnsigned));
+    }
+
+    void expensiveKeysAreComputedOnce()
+    {
+        std::mt19937 random(22);
+        JSArray<Player> players = randomPlayers(1000, 100, random);
+        std::size_t calls = 0;
+        const auto byName = [&](const Player& p){calls += 1; return p.name;};
+        const JSArray<Player> sorted = players.toSortedBy(byName);
+        CHECK(calls == players.size());
+        CHECK(std::is_sorted(sorted.begin(), sorted.end(), [](const Player& a, const Player& b){return a.name < b.name;}));
+
+        calls = 0;
+        players.sortBy(byName);
+        CHECK(calls == players.size());
+        CHECK(players == sorted);
+        CHECK(!players.isSorted());
+    }
+
+    void keysCanUseTheIndex()
+    {
+        const JSArray<std::string> words{"c", "a", "b", "d"};
+        // sorting by descending index reverses the array
+        CHECK(words.toSortedBy([](const std::string&, std::size_t i){return -static_cast<long>(i);}) == (JSArray<std::string>{"d", "b", "a", "c"}));
+        CHECK(words.toSortedBy([](const std::string& w, std::size_t, const JSArray<std::string>& self){return self.size() + w.size();}) == words);
+    }
+}
+
+int main()
+{
+    integerKeysAreStable();
+    expensiveKeysAreComputedOnce();
+    keysCanUseTheIndex();
+    return 0;
+}
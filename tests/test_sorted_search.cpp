@@ -0,0 +1,145 @@
+#include "check.h"
+#include "jsArray.h"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <utility>
+
+namespace
+{
+    void boundsMatchTheStandardLibrary()
+    {
+        std::mt19937 random(3);
+        std::uniform_int_distribution<int> value(0, 50);
+        for (std::size_t n = 0; n < 70; n += 1)
+        {
+            JSArray<int> values;
+            for (std::size_t i = 0; i < n; i += 1)
+            {
+                values.push_back(value(random));
+            }
+            values.sort();
+
+            for (int x = -1; x <= 52; x += 1)
+            {
+                const std::size_t lower = static_cast<std::size_t>(std::lower_bound(values.begin(), values.end(), x) - values.begin());
+                const std::size_t upper = static_cast<std::size_t>(std::upper_bound(values.begin(), values.end(), x) - values.begin());
+                CHECK(values.lowerBound(x) == lower);
+                CHECK(values.upperBound(x) == upper);
+                CHECK(values.equalRange(x) == std::make_pair(lower, upper));
+            }
+        }
+
+        // the overloads with a comparator search an array sorted with that comparator
+        const JSArray<int> descending{9, 7, 7, 4, 1};
+        CHECK(descending.lowerBound(7, std::greater<int>()) == 1);
+        CHECK(descending.upperBound(7, std::greater<int>()) == 3);
+        CHECK(descending.lowerBound(0, std::greater<int>()) == 5);
+        CHECK(descending.upperBound(10, std::greater<int>()) == 0);
+    }
+
+    void sortedIndexOfWithAndWithoutThePromise()
+    {
+        JSArray<int> values{8, 3, 5, 3, 1};
+        CHECK(!values.isSorted());
+        CHECK(values.sortedIndexOf(3) == 1); // linear scan, first occurrence
+        CHECK(values.sortedIndexOf(4) == -1);
+
+        values.sort();
+        CHECK(values.isSorted());
+        CHECK(values.sortedIndexOf(3) == 1); // 1 3 3 5 8, binary search
+        CHECK(values.sortedIndexOf(8) == 4);
+        CHECK(values.sortedIndexOf(0) == -1);
+        CHECK(values.sortedIndexOf(9) == -1);
+        CHECK(values.sortedIndexOf(4) == -1);
+        CHECK(JSArray<int>().markSorted().sortedIndexOf(1) == -1);
+    }
+
+    void writesDropThePromise()
+    {
+        JSArray<int> values{4, 2, 3};
+        values.sort();
+        values[0] = 100;
+        CHECK(!values.isSorted());
+        CHECK(values.sortedIndexOf(100) == 0);
+
+        values.sort();
+        *values.begin() = 50; // 50 3 4
+        CHECK(values.sortedIndexOf(50) == 0);
+
+        values.sort();
+        values.back() = -1; // 3 4 -1
+        CHECK(values.sortedIndexOf(-1) == 2);
+
+        values.sort();
+        values.push_back(0);
+        CHECK(!values.isSorted());
+
+        // reading through a const reference keeps it
+        values.sort();
+        const JSArray<int>& readOnly = values;
+        CHECK(readOnly[0] == -1 && readOnly.front() == -1 && *readOnly.begin() == -1);
+        CHECK(values.isSorted());
+
+        values.markSorted(false);
+        CHECK(!values.isSorted());
+        values.markSorted();
+        CHECK(values.isSorted());
+
+        // sort with a comparator isn't the ascending promise
+        values.sort([](int a, int b){return a > b;});
+        CHECK(!values.isSorted());
+        CHECK(values.toSorted().isSorted());
+    }
+
+    void rangeFilterBothWays()
+    {
+        JSArray<int> values{7, 1, 9, 4, 4, 2, 6};
+        CHECK(values.rangeFilter(2, 7) == (JSArray<int>{4, 4, 2, 6}));
+        CHECK(values.rangeFilter(7, 2).empty());
+
+        values.sort();
+        const JSArray<int> sorted = values.rangeFilter(2, 7);
+        CHECK(sorted == (JSArray<int>{2, 4, 4, 6}));
+        CHECK(sorted.isSorted());
+        CHECK(values.rangeFilter(7, 2).empty());
+        CHECK(values.rangeFilter(0, 100) == values);
+        CHECK(values.rangeFilter(10, 20).empty());
+    }
+
+    void medianBothWays()
+    {
+        JSArray<int> values{9, 2, 7, 4, 5};
+        CHECK(values.median() == 5);
+        values.sort();
+        CHECK(values.median() == 5);
+
+        // even length: the lower of the two middle elements
+        JSArray<int> even{8, 1, 6, 3};
+        CHECK(even.median() == 3);
+        even.sort();
+        CHECK(even.median() == 3);
+        CHECK(even == (JSArray<int>{1, 3, 6, 8}));
+    }
+
+    void setOperationsTrustOnlyAValidPromise()
+    {
+        JSArray<int> a{1, 3, 5, 7};
+        a.sort();
+        a[0] = 9; // 9 3 5 7 isn't sorted anymore: hashing, in the order of a
+        const JSArray<int> b{3, 9};
+        CHECK(a.intersect(b) == (JSArray<int>{9, 3}));
+    }
+}
+
+int main()
+{
+    boundsMatchTheStandardLibrary();
+    sortedIndexOfWithAndWithoutThePromise();
+    writesDropThePromise();
+    rangeFilterBothWays();
+    medianBothWays();
+    setOperationsTrustOnlyAValidPromise();
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "check.h"
+#include "jsStream.h"
+
+#include <system_error>
+#include <unistd.h>
+
+namespace
+{
+    // a pipe holding bytes, write end closed so the stream sees EOF after them
+    int pipeOf(const unsigned char* bytes, std::size_t size)
+    {
+        int fds[2];
+        CHECK(::pipe(fds) == 0);
+        CHECK(::write(fds[1], bytes, size) == static_cast<::ssize_t>(size));
+        ::close(fds[1]);
+        return fds[0];
+    }
+
+    void wholeElementsAreRead()
+    {
+        int values[10];
+        for (int i = 0; i < 10; i += 1)
+            values[i] = i * 3;
+
+        const JSArray<int> read = JSStream<int>::fromDescriptor(pipeOf(reinterpret_cast<const unsigned char*>(values), sizeof(values)), true, 4).toArray();
+        CHECK(read.size() == 10);
+        for (int i = 0; i < 10; i += 1)
+            CHECK(read[i] == i * 3);
+    }
+
+    // two bytes short of the last element, they used to be dropped without a word
+    void partialTrailingElementThrows()
+    {
+        int values[10] = {};
+        const int fd = pipeOf(reinterpret_cast<const unsigned char*>(values), sizeof(values) - 2);
+
+        std::size_t seen = 0;
+        bool thrown = false;
+        try
+        {
+            JSStream<int>::fromDescriptor(fd, true, 4).forEach([&](int){seen += 1;});
+        }
+        catch (const std::system_error& error)
+        {
+            thrown = error.code() == std::errc::bad_message;
+        }
+
+        CHECK(thrown);
+        CHECK(seen == 9);
+    }
+}
+
+int main()
+{
+    wholeElementsAreRead();
+    partialTrailingElementThrows();
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include "check.h"
+#include "jsThreadPool.h"
+
+#include <atomic>
+
+// many tiny parallelFor calls, so the workers keep going to sleep right as work is published. A lost
+// wakeup hangs a call, which the ctest timeout turns into a failure
+int main()
+{
+    // including jsThreadPool.h makes the shared pool the default executor
+    CHECK(&JSExecutor::current() == &jsDetail::defaultThreadPool());
+
+    JSThreadPool pool(4);
+    std::atomic<std::size_t> total{0};
+    auto body = [&](std::size_t begin, std::size_t end)
+    {
+        total.fetch_add(end - begin, std::memory_order_relaxed);
+    };
+
+    for (std::size_t round = 0; round < 20000; round += 1)
+        pool.parallelFor(8, 1, JSRangeFunction(body));
+
+    CHECK(total.load() == 20000 * 8);
+    return 0;
+}
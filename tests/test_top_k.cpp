@@ -0,0 +1,141 @@
+#include "check.h"
+#include "jsArrayParallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <string>
+
+namespace
+{
+    JSArray<int> randomInts(std::size_t n, std::mt19937& random)
+    {
+        std::uniform_int_distribution<int> value(-1000, 1000);
+        JSArray<int> result;
+        for (std::size_t i = 0; i < n; i += 1)
+        {
+            result.push_back(value(random));
+        }
+        return result;
+    }
+
+    // the first k elements of a full sort, what every method here must agree with
+    template<typename F>
+    JSArray<int> sortedPrefix(const JSArray<int>& values, std::size_t k, F compareFunc)
+    {
+        JSArray<int> sorted = values.toSorted(compareFunc);
+        sorted.resize(std::min(k, sorted.size()));
+        return sorted;
+    }
+
+    void topKMatchesAFullSort()
+    {
+        std::mt19937 random(11);
+        const JSArray<int> values = randomInts(5000, random);
+        // below and above the heap limit, and more than the array holds
+        for (const std::size_t k : {0, 1, 10, 1000, 2000, 5000, 7000})
+        {
+            const JSArray<int> smallest = values.topK(k);
+            CHECK(smallest == sortedPrefix(values, k, std::less<int>()));
+            CHECK(smallest.isSorted());
+            CHECK(values.topK(k, std::greater<int>()) == sortedPrefix(values, k, std::greater<int>()));
+        }
+
+        CHECK(JSArray<int>().topK(3).empty());
+        const JSArray<std::string> words{"pear", "fig", "apple", "kiwi"};
+        CHECK(words.topK(2) == (JSArray<std::string>{"apple", "fig"}));
+    }
+
+    void topKParallelMatchesTopK()
+    {
+        JSThreadPool pool(4);
+        JSExecutor::setCurrent(&pool);
+        std::mt19937 random(12);
+        const JSArray<int> values = randomInts(200000, random);
+        for (const std::size_t k : {0, 1, 100, 5000})
+        {
+            CHECK(values.topKParallel(k, std::less<int>()) == sortedPrefix(values, k, std::less<int>()));
+            CHECK(values.topKParallel(k, std::greater<int>()) == sortedPrefix(values, k, std::greater<int>()));
+        }
+        JSExecutor::setCurrent(nullptr);
+    }
+
+    void partialSortSortsThePrefix()
+    {
+        std::mt19937 random(13);
+        const JSArray<int> values = randomInts(500, random);
+        for (const std::size_t k : {0, 1, 37, 500, 900})
+        {
+            JSArray<int> copy = values;
+            copy.partialSort(k);
+            const std::size_t sortedCount = std::min<std::size_t>(k, values.size());
+            CHECK(JSArray<int>(copy.begin(), copy.begin() + sortedCount) == sortedPrefix(values, k, std::less<int>()));
+            CHECK(copy.toSorted() == values.toSorted()); // same elements, only reordered
+
+            copy = values;
+            copy.partialSort(k, std::greater<int>());
+            CHECK(JSArray<int>(copy.begin(), copy.begin() + sortedCount) == sortedPrefix(values, k, std::greater<int>()));
+        }
+    }
+
+    void nthElementPartitionsAroundK()
+    {
+        std::mt19937 random(14);
+        const JSArray<int> values = randomInts(300, random);
+        const JSArray<int> sorted = values.toSorted();
+        for (const std::size_t k : {0, 1, 150, 299})
+        {
+            JSArray<int> copy = values;
+            copy.nthElement(k);
+            CHECK(copy[k] == sorted[k]);
+            CHECK(std::all_of(copy.begin(), copy.begin() + k, [&](int x){return x <= copy[k];}));
+            CHECK(std::all_of(copy.begin() + k, copy.end(), [&](int x){return x >= copy[k];}));
+
+            copy = values;
+            copy.nthElement(k, std::greater<int>());
+            CHECK(copy[k] == sorted[sorted.size() - 1 - k]);
+        }
+
+        // past the end: nothing to select, the array is left as it is
+        JSArray<int> copy = values;
+        copy.nthElement(values.size());
+        copy.nthElement(values.size() + 10, std::greater<int>());
+        CHECK(copy == values);
+        JSArray<int>().nthElement(0);
+    }
+
+    void medianIsTheLowerMiddle()
+    {
+        CHECK((JSArray<int>{5}).median() == 5);
+        CHECK((JSArray<int>{3, 9, 1}).median() == 3);
+        CHECK((JSArray<int>{4, 1, 3, 2}).median() == 2);
+        CHECK((JSArray<int>{10, 40, 30, 20, 60, 50}).median() == 30);
+
+        std::mt19937 random(15);
+        const JSArray<int> values = randomInts(1000, random);
+        CHECK(values.median() == values.toSorted()[499]);
+    }
+
+    void mergeSortedMatchesAFullSort()
+    {
+        const std::vector<JSArray<int>> arrays{{1, 4, 9}, {}, {2, 3, 10, 11}, {0, 4}};
+        const JSArray<int> merged = JSArray<int>::mergeSorted(arrays);
+        CHECK(merged == (JSArray<int>{0, 1, 2, 3, 4, 4, 9, 10, 11}));
+        CHECK(merged.isSorted());
+        CHECK(JSArray<int>::mergeSorted(std::vector<JSArray<int>>()).empty());
+
+        const std::vector<JSArray<int>> descending{{9, 5, 1}, {8, 2}};
+        CHECK(JSArray<int>::mergeSorted(descending, std::greater<int>()) == (JSArray<int>{9, 8, 5, 2, 1}));
+    }
+}
+
+int main()
+{
+    topKMatchesAFullSort();
+    topKParallelMatchesTopK();
+    partialSortSortsThePrefix();
+    nthElementPartitionsAroundK();
+    medianIsTheLowerMiddle();
+    mergeSortedMatchesAFullSort();
+    return 0;
+}
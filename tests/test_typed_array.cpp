@@ -0,0 +1,85 @@
+#include "check.h"
+#include "jsTypedArray.h"
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace
+{
+    void storageIsAlignedAndPadded()
+    {
+        Float64Array values(13, 1.5);
+        CHECK(reinterpret_cast<std::uintptr_t>(values.data()) % 64 == 0);
+        CHECK(values.paddedByteLength() % 64 == 0 && values.paddedByteLength() >= 13 * sizeof(double));
+        CHECK(JSAlignedAllocator<double>::paddedBytes(8) == 64 && JSAlignedAllocator<double>::paddedBytes(9) == 128);
+    }
+
+    // sizes that leave a partial last block, so the scalar tail is exercised too
+    void kernelsCoverTheTail()
+    {
+        for (const std::size_t n : {0u, 1u, 15u, 16u, 17u, 1000u})
+        {
+            Int32Array values;
+            for (std::size_t i = 0; i < n; i += 1)
+                values.push_back(static_cast<std::int32_t>(i % 2 == 0 ? i : 0 - i));
+
+            std::int64_t sum = 0;
+            std::int32_t low = std::numeric_limits<std::int32_t>::max();
+            std::int32_t high = std::numeric_limits<std::int32_t>::lowest();
+            for (const std::int32_t value : values)
+            {
+                sum += value;
+                low = value < low ? value : low;
+                high = value > high ? value : high;
+            }
+
+            CHECK(values.sum() == sum && values.min() == low && values.max() == high);
+        }
+
+        // bytes are summed as 64 bit integers
+        const Uint8Array bytes(1000, 255);
+        static_assert(std::is_same_v<decltype(bytes.sum()), std::uint64_t>);
+        CHECK(bytes.sum() == 255000u);
+
+        const Float32Array floats{0.5f, -2.0f, 8.25f};
+        CHECK(floats.sum() == 6.75f && floats.min() == -2.0f && floats.max() == 8.25f);
+    }
+
+    void mapAndFilterStayTyped()
+    {
+        Float64Array values;
+        for (int i = 0; i < 200; i += 1)
+            values.push_back(i * 0.5);
+
+        const auto halves = values.map([](double value){return static_cast<std::int32_t>(value);});
+        static_assert(std::is_same_v<std::remove_cv_t<decltype(halves)>, Int32Array>);
+        CHECK(halves.size() == 200 && halves[3] == 1 && halves[199] == 99);
+
+        const Float64Array kept = values.filter([](double value, std::size_t i){return value > 40.0 || i % 7 == 0;});
+        std::size_t expected = 0;
+        for (std::size_t i = 0; i < values.size(); i += 1)
+        {
+            if (values[i] > 40.0 || i % 7 == 0)
+            {
+                CHECK(kept[expected] == values[i]);
+                expected += 1;
+            }
+        }
+
+        // allocated once, for exactly what is kept
+        CHECK(kept.size() == expected && kept.capacity() == expected);
+        CHECK(values.filter([](double){return false;}).empty());
+
+        const Float64Array sorted = kept.toSorted([](double a, double b){return a > b;});
+        CHECK(sorted.size() == kept.size() && sorted[0] == 99.5 && sorted.back() == 0.0);
+    }
+}
+
+int main()
+{
+    storageIsAlignedAndPadded();
+    kernelsCoverTheTail();
+    mapAndFilterStayTyped();
+    return 0;
+}
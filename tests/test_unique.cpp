@@ -0,0 +1,79 @@
+#include "check.h"
+#include "jsArray.h"
+#include "jsThreadPool.h"
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <unordered_set>
+
+namespace
+{
+    // no std::hash, only operator<: deduplicated by sorting indices
+    struct Version
+    {
+        int major;
+        int minor;
+        bool operator<(const Version& other) const noexcept { return major != other.major ? major < other.major : minor < other.minor; }
+        bool operator==(const Version& other) const noexcept { return major == other.major && minor == other.minor; }
+    };
+
+    void numbersKeepFirstOccurrences()
+    {
+        JSArray<int> values{3, 1, 3, 2, 1, 3, 4};
+        CHECK(values.toUnique() == (JSArray<int>{3, 1, 2, 4}));
+        CHECK(values.size() == 7);
+        values.unique();
+        CHECK(values == (JSArray<int>{3, 1, 2, 4}));
+        CHECK(JSArray<int>().toUnique().empty());
+
+        // SameValueZero, like a javascript Set: NaN equals NaN and -0 equals +0
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const JSArray<double> doubles{nan, 0.0, -0.0, 1.5, nan, 1.5};
+        const JSArray<double> distinct = doubles.toUnique();
+        CHECK(distinct.size() == 3 && std::isnan(distinct[0]) && distinct[1] == 0.0 && !std::signbit(distinct[1]) && distinct[2] == 1.5);
+    }
+
+    void hashableAndOrderedTypes()
+    {
+        const JSArray<std::string> words{"b", "a", "b", "c", "a"};
+        CHECK(words.toUnique() == (JSArray<std::string>{"b", "a", "c"}));
+
+        JSArray<Version> versions{{1, 2}, {1, 0}, {1, 2}, {0, 9}, {1, 0}};
+        versions.unique();
+        CHECK(versions.size() == 3 && versions[0] == (Version{1, 2}) && versions[1] == (Version{1, 0}) && versions[2] == (Version{0, 9}));
+    }
+
+    // big enough for the partitioned parallel strategy
+    void parallelMatchesSerial()
+    {
+        JSArray<int> values;
+        const std::size_t n = std::size_t(1) << 22;
+        values.reserve(n);
+        for (std::size_t i = 0; i < n; i += 1)
+            values.push_back(static_cast<int>((i * 2654435761u) % 1000003));
+
+        JSArray<int> expected;
+        std::unordered_set<int> seen;
+        for (const int value : values)
+        {
+            if (seen.insert(value).second)
+                expected.push_back(value);
+        }
+
+        CHECK(values.toUnique() == expected);
+    }
+}
+
+int main()
+{
+    JSThreadPool pool(4);
+    JSExecutor::setCurrent(&pool);
+
+    numbersKeepFirstOccurrences();
+    hashableAndOrderedTypes();
+    parallelMatchesSerial();
+
+    JSExecutor::setCurrent(nullptr);
+    return 0;
+}